@@ -0,0 +1,203 @@
+#ifndef AIRCRAFT_RENDERER_H
+#define AIRCRAFT_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+
+#include "fleet.h"
+#include "camera.h"
+#include "shaders.h"
+#include "shader_utils.h"
+
+// Draws the fleet with a single instanced draw call. Instances are
+// positioned relative to the eye, like the globe.
+//
+// update() culls the fleet once per frame into the instance buffer; the
+// camera pass and every shadow cascade then draw from that same list.
+class AircraftRenderer {
+public:
+    float aircraftScale = 0.012f;  // Dart length in globe units
+    int selectedAircraft = -1;     // Highlighted aircraft (fleet index), -1 for none
+
+    void init() {
+        shaderProgram = createShaderProgram(aircraftVertexShaderSource, aircraftFragmentShaderSource);
+        depthProgram = createShaderProgram(aircraftVertexShaderSource, shadowFragmentShaderSource);
+        depthViewLoc = glGetUniformLocation(depthProgram, "view");
+        depthProjLoc = glGetUniformLocation(depthProgram, "projection");
+        depthScaleLoc = glGetUniformLocation(depthProgram, "aircraftScale");
+        depthSelectedLoc = glGetUniformLocation(depthProgram, "selectedAircraft");
+        viewLoc = glGetUniformLocation(shaderProgram, "view");
+        projLoc = glGetUniformLocation(shaderProgram, "projection");
+        scaleLoc = glGetUniformLocation(shaderProgram, "aircraftScale");
+        selectedLoc = glGetUniformLocation(shaderProgram, "selectedAircraft");
+        sunPosLoc = glGetUniformLocation(shaderProgram, "sunPos");
+        sunColorLoc = glGetUniformLocation(shaderProgram, "sunColor");
+
+        // Dart mesh: local position (x forward, y up, z right) followed by normal
+        const float dart[] = {
+            // Left wing
+             1.0f, 0.0f,  0.0f,   0.0f, 1.0f, 0.0f,
+            -0.6f, 0.0f, -0.6f,   0.0f, 1.0f, 0.0f,
+            -0.3f, 0.0f,  0.0f,   0.0f, 1.0f, 0.0f,
+            // Right wing
+             1.0f, 0.0f,  0.0f,   0.0f, 1.0f, 0.0f,
+            -0.3f, 0.0f,  0.0f,   0.0f, 1.0f, 0.0f,
+            -0.6f, 0.0f,  0.6f,   0.0f, 1.0f, 0.0f,
+            // Tail fin
+             0.2f, 0.0f,  0.0f,   0.0f, 0.0f, 1.0f,
+            -0.6f, 0.0f,  0.0f,   0.0f, 0.0f, 1.0f,
+            -0.6f, 0.4f,  0.0f,   0.0f, 0.0f, 1.0f,
+        };
+        vertexCount = sizeof(dart) / (6 * sizeof(float));
+
+        glGenBuffers(1, &meshVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(dart), dart, GL_STATIC_DRAW);
+        createVertexArray();
+    }
+
+    // Init in a context that shares objects with source's. The programs and
+    // the dart mesh are reused; the vertex array, which contexts do not
+    // share, and the instance buffer, which holds this view's culled list,
+    // are made here.
+    void initShared(const AircraftRenderer& source) {
+        *this = source;
+        sharesObjects = true;
+        instanceData.clear();
+        instanceCount = culledInstances = 0;
+        createVertexArray();
+    }
+
+    // Stream this frame's visible fleet state into the instance buffer.
+    // Offsets from the eye are taken in double so nearby traffic does not
+    // jitter. An aircraft is kept if it is in the view frustum or its shadow,
+    // swept along shadowExtrusion (away from the sun, meters), could reach it.
+    void update(const Fleet& fleet, const RenderView& view, const glm::mat4& viewProjection,
+                const glm::vec3& shadowExtrusion) {
+        glm::vec4 planes[4];
+        frustumSidePlanes(viewProjection, planes);
+        const double metersPerUnit = fleet.metersPerUnit;
+        const float margin = aircraftScale * (float)metersPerUnit;
+
+        instanceData.resize(fleet.size() * 9);
+        instanceCount = 0;
+        selectedInstance = -1;
+        for (size_t i = 0; i < fleet.size(); ++i) {
+            glm::dvec3 position(fleet.posX[i], fleet.posY[i], fleet.posZ[i]);
+            glm::vec3 rel = view.relative(position * metersPerUnit);
+            glm::vec3 swept = rel + shadowExtrusion;
+
+            bool outside = false;
+            for (int p = 0; p < 4 && !outside; ++p) {
+                glm::vec3 n(planes[p]);
+                outside = glm::dot(n, rel) + planes[p].w < -margin &&
+                          glm::dot(n, swept) + planes[p].w < -margin;
+            }
+            if (outside) continue;
+
+            if ((int)i == selectedAircraft) selectedInstance = (int)instanceCount;
+            glm::vec3 forward = fleet.getForward(i);
+            glm::vec3 up = glm::normalize(fleet.getPosition(i));
+            float* dst = &instanceData[instanceCount++ * 9];
+            dst[0] = rel.x;
+            dst[1] = rel.y;
+            dst[2] = rel.z;
+            dst[3] = forward.x;
+            dst[4] = forward.y;
+            dst[5] = forward.z;
+            dst[6] = up.x;
+            dst[7] = up.y;
+            dst[8] = up.z;
+        }
+
+        culledInstances = fleet.size() - instanceCount;
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instanceCount * 9 * sizeof(float), instanceData.data(), GL_STREAM_DRAW);
+    }
+
+    size_t visibleCount() const { return instanceCount; }
+    size_t culledCount() const { return culledInstances; }
+    int trianglesPerInstance() const { return vertexCount / 3; }
+
+    // view is the rotation-only RenderView matrix; sunPos is relative to the eye.
+    // metersPerUnit converts the dart size to the meters the instances are in.
+    void draw(const glm::mat4& view, const glm::mat4& projection, float metersPerUnit,
+              const glm::vec3& sunPos, const glm::vec3& sunColor) {
+        if (instanceCount == 0) return;
+
+        glUseProgram(shaderProgram);
+        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+        glUniform1f(scaleLoc, aircraftScale * metersPerUnit);
+        glUniform1i(selectedLoc, selectedInstance);
+        glUniform3f(sunPosLoc, sunPos.x, sunPos.y, sunPos.z);
+        glUniform3f(sunColorLoc, sunColor.x, sunColor.y, sunColor.z);
+
+        glBindVertexArray(VAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, (GLsizei)instanceCount);
+    }
+
+    // Depth only, into a shadow cascade; lightMatrix is eye-relative
+    void drawDepth(const glm::mat4& lightMatrix, float metersPerUnit) {
+        if (instanceCount == 0) return;
+
+        glUseProgram(depthProgram);
+        glUniformMatrix4fv(depthViewLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1.0f)));
+        glUniformMatrix4fv(depthProjLoc, 1, GL_FALSE, glm::value_ptr(lightMatrix));
+        glUniform1f(depthScaleLoc, aircraftScale * metersPerUnit);
+        glUniform1i(depthSelectedLoc, -1);
+
+        glBindVertexArray(VAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount, (GLsizei)instanceCount);
+    }
+
+    void cleanup() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &instanceVBO);
+        if (sharesObjects) return;
+        glDeleteBuffers(1, &meshVBO);
+        glDeleteProgram(shaderProgram);
+        glDeleteProgram(depthProgram);
+    }
+
+private:
+    bool sharesObjects = false;  // Programs and mesh belong to another renderer
+    unsigned int shaderProgram = 0, depthProgram = 0;
+    unsigned int VAO = 0, meshVBO = 0, instanceVBO = 0;
+    int viewLoc = -1, projLoc = -1, scaleLoc = -1, selectedLoc = -1;
+    int sunPosLoc = -1, sunColorLoc = -1;
+    int depthViewLoc = -1, depthProjLoc = -1, depthScaleLoc = -1, depthSelectedLoc = -1;
+    int selectedInstance = -1;  // selectedAircraft's slot in this frame's culled list
+    int vertexCount = 0;
+    size_t instanceCount = 0;
+    size_t culledInstances = 0;
+    std::vector<float> instanceData;
+
+    // Vertex array over the mesh and a new instance buffer
+    void createVertexArray() {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+
+        glBindBuffer(GL_ARRAY_BUFFER, meshVBO);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // Per-instance eye-relative position, forward and up directions
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        for (int a = 0; a < 3; ++a) {
+            glVertexAttribPointer(2 + a, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(a * 3 * sizeof(float)));
+            glEnableVertexAttribArray(2 + a);
+            glVertexAttribDivisor(2 + a, 1);
+        }
+
+        glBindVertexArray(0);
+    }
+};
+
+#endif // AIRCRAFT_RENDERER_H
@@ -0,0 +1,952 @@
+// Micro-benchmarks for the simulation subsystems and the renderer
+//
+// Usage: plane_bench [--json FILE] [--filter TEXT] [--repetitions N]
+//                    [--warmup N] [--min-sample-us N]
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <map>
+#include <utility>
+
+#include "fleet.h"
+#include "ray.h"
+#include "bvh.h"
+#include "flight_model.h"
+#include "wind_field.h"
+#include "route_planner.h"
+#include "land_mask.h"
+#include "geodesy.h"
+#include "camera.h"
+#include "sphere.h"
+#include "continent_noise.h"
+#include "scene_renderer.h"
+#include "secondary_view.h"
+#include "telemetry.h"
+#include "ingest.h"
+#include "bench_harness.h"
+
+// "1k" style size suffix for benchmark names
+std::string countName(size_t n) {
+    if (n >= 1000000 && n % 1000000 == 0) return std::to_string(n / 1000000) + "M";
+    if (n >= 1000 && n % 1000 == 0) return std::to_string(n / 1000) + "k";
+    return std::to_string(n);
+}
+
+// Rays from an orbiting viewpoint towards random points near the globe
+std::vector<Ray> makeRays(size_t count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<Ray> rays(count);
+    glm::vec3 eye(0.0f, 0.0f, 3.0f);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 target(unit(rng), unit(rng), unit(rng) * 0.2f + 0.9f);
+        rays[i].origin = eye;
+        rays[i].direction = glm::normalize(target - eye);
+    }
+    return rays;
+}
+
+// Aircraft BVH build, refit after half a second of flight, and closest-hit
+// queries; build and refit throughput in aircraft, queries in rays
+void benchBvh(BenchHarness& harness) {
+    const size_t counts[] = {1000, 10000, 100000};
+    for (size_t n : counts) {
+        std::string size = countName(n);
+        Fleet fleet;
+        fleet.spawnRandom(n);
+
+        // Filtered-out steps still run once, untimed, for the ones after them
+        Bvh4 bvh;
+        if (!harness.run("bvh/build " + size, [&] { bvh.build(fleet); }, (double)n)) bvh.build(fleet);
+
+        fleet.propagate(0.5f);
+        if (!harness.run("bvh/refit " + size, [&] { bvh.refit(fleet); }, (double)n)) bvh.refit(fleet);
+
+        std::vector<Ray> rays = makeRays(10000, 42);
+        size_t hits = 0, queries = 0;
+        size_t next = 0;
+        if (harness.run("bvh/query " + size, [&] {
+            int index;
+            float t;
+            if (bvh.intersectClosest(rays[next], 10.0f, index, t)) ++hits;
+            ++queries;
+            next = (next + 1) % rays.size();
+        })) {
+            std::cout << "    " << size << " aircraft: hit rate " << std::fixed << std::setprecision(1)
+                      << 100.0 * hits / queries << "%" << std::defaultfloat << std::endl;
+        }
+    }
+}
+
+// One fixed step of the 6DOF model per call; throughput in aircraft-steps
+void benchFlightModel(BenchHarness& harness) {
+    const size_t counts[] = {1, 1000, 100000};
+    const FlightModel::Integrator integrators[] = {FlightModel::RK4, FlightModel::SEMI_IMPLICIT_EULER};
+    for (size_t n : counts) {
+        for (FlightModel::Integrator integrator : integrators) {
+            FlightModel model;
+            model.integrator = integrator;
+            model.resize(n);
+            Fleet layout;
+            layout.spawnRandom(n);
+            for (size_t i = 0; i < n; ++i) {
+                model.spawn(i, glm::dvec3(layout.getPosition(i)), glm::dvec3(layout.getForward(i)), 10000.0, 230.0);
+            }
+
+            std::string name = std::string("flight/") + (integrator == FlightModel::RK4 ? "rk4 " : "euler ") + countName(n);
+            harness.run(name, [&] { model.step(model.fixedStep); }, (double)n);
+        }
+    }
+}
+
+// Wind grid generation and file load, a million samples batched and scalar,
+// and what wind adds to fleet propagation
+void benchWindField(BenchHarness& harness) {
+    WindField wind;
+    if (harness.run("wind/generate", [&] { wind.generateProcedural(); })) {
+        std::cout << "    grid " << wind.latCount << " x " << wind.lonCount << " x " << wind.levelCount << std::endl;
+    } else {
+        wind.generateProcedural();  // For the samples below
+    }
+
+    const char* path = "bench_winds.bin";
+    if (wind.saveToFile(path)) {
+        WindField loaded;
+        if (harness.run("wind/load", [&] { loaded.loadFromFile(path); })) {
+            WindField::Sample a = wind.sample(47.5f, -122.3f, 10500.0f);
+            WindField::Sample b = loaded.sample(47.5f, -122.3f, 10500.0f);
+            std::cout << "    binary round trip " << (a.u == b.u && a.v == b.v ? "ok" : "MISMATCH") << std::endl;
+        }
+        std::remove(path);
+    }
+
+    const size_t n = 1000000;
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> lat(-90.0f, 90.0f), lon(-180.0f, 180.0f), alt(0.0f, 14000.0f);
+    std::vector<float> lats(n), lons(n), alts(n), u(n), v(n);
+    for (size_t i = 0; i < n; ++i) {
+        lats[i] = lat(rng);
+        lons[i] = lon(rng);
+        alts[i] = alt(rng);
+    }
+
+    harness.run("wind/sample batch 1M", [&] {
+        wind.sampleBatch(lats.data(), lons.data(), alts.data(), u.data(), v.data(), n);
+    }, (double)n);
+    harness.run("wind/sample scalar 1M", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            WindField::Sample s = wind.sample(lats[i], lons[i], alts[i]);
+            u[i] = s.u;
+        }
+        benchKeep(u[0]);
+    }, (double)n);
+
+    // Cost of wind on fleet propagation
+    const size_t counts[] = {1000, 100000};
+    for (size_t count : counts) {
+        Fleet fleet;
+        fleet.spawnRandom(count);
+        harness.run("wind/propagate calm " + countName(count), [&] { fleet.propagate(1.0f); }, (double)count);
+        harness.run("wind/propagate windy " + countName(count), [&] { fleet.propagate(1.0f, &wind); }, (double)count);
+    }
+}
+
+// Route graph build, then minimum-time routes for random city pairs on one
+// thread and on every hardware thread; throughput in routes
+void benchRoutePlanner(BenchHarness& harness) {
+    WindField wind;
+    wind.generateProcedural();
+    RouteGraph graph;
+    if (harness.run("route/graph build", [&] { graph.build(5); graph.setWind(&wind); })) {
+        std::cout << "    graph " << graph.nodes.size() << " nodes, " << graph.edgeTarget.size() << " edges" << std::endl;
+    } else {
+        graph.build(5);  // For the routes below
+        graph.setWind(&wind);
+    }
+
+    // Random city pairs at least a tenth of the way around the globe apart
+    const size_t pairCount = 100;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> lat(-60.0f, 60.0f), lon(-180.0f, 180.0f);
+    std::vector<std::pair<glm::vec3, glm::vec3> > pairs;
+    while (pairs.size() < pairCount) {
+        glm::vec3 a = latLonToDirection(lat(rng), lon(rng));
+        glm::vec3 b = latLonToDirection(lat(rng), lon(rng));
+        if (arcAngle(a, b) > 0.63f) pairs.push_back(std::make_pair(a, b));
+    }
+
+    unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int threadCounts[] = {1, hardware};
+    for (unsigned int t = 0; t < 2; ++t) {
+        unsigned int threads = threadCounts[t];
+        if (t == 1 && hardware == 1) break;
+        std::string name = "route/plan 100 pairs " + std::string(t == 0 ? "1 thread" : "all threads");
+        std::vector<Route> routes;
+        if (!harness.run(name, [&] { planRoutes(graph, pairs, routes, threads); }, (double)pairCount)) continue;
+
+        double expanded = 0.0, ratio = 0.0;
+        size_t found = 0, faster = 0;
+        for (size_t i = 0; i < routes.size(); ++i) {
+            if (!routes[i].found) continue;
+            ++found;
+            expanded += routes[i].expanded;
+            double greatCircle = graph.greatCircleTime(routes[i].waypoints.front(), routes[i].waypoints.back());
+            ratio += routes[i].flightTime / greatCircle;
+            if (routes[i].flightTime < greatCircle * 0.999) ++faster;
+        }
+        found = std::max<size_t>(found, 1);
+        std::cout << "    " << threads << " thread(s): " << std::fixed << std::setprecision(0)
+                  << expanded / found << " nodes expanded, " << std::setprecision(2) << 100.0 * ratio / found
+                  << "% of the great-circle time, " << std::setprecision(1) << 100.0 * faster / found
+                  << "% faster than it" << std::defaultfloat << std::endl;
+    }
+}
+
+// Land mask generation (timed at a quarter of the default resolution, the
+// full one takes seconds) and mapping, then single and batched queries at
+// every level against the noise they were baked from
+void benchLandMask(BenchHarness& harness) {
+    LandMask small;
+    harness.run("landmask/generate 1024", [&] { small.generate(1024); });
+
+    LandMask mask;
+    mask.generate();
+
+    const char* path = "bench_landmask.bin";
+    if (mask.saveToFile(path)) {
+        LandMask mapped;
+        if (harness.run("landmask/map", [&] { mapped.mapFile(path); })) {
+            bool same = mapped.levelCount() == mask.levelCount();
+            for (int l = 0; same && l < mask.levelCount(); ++l) {
+                const LandMask::Level& a = mask.level(l);
+                const LandMask::Level& b = mapped.level(l);
+                same = memcmp(a.bits, b.bits, (size_t)a.wordsPerRow * a.height * 8) == 0;
+            }
+            std::cout << "    mapped contents " << (same ? "match" : "MISMATCH") << std::endl;
+        }
+        std::remove(path);
+    }
+
+    const size_t n = 1000000;
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> lat(-90.0f, 90.0f), lon(-180.0f, 180.0f);
+    std::vector<float> lats(n), lons(n);
+    std::vector<uint8_t> land(n);
+    for (size_t i = 0; i < n; ++i) {
+        lats[i] = lat(rng);
+        lons[i] = lon(rng);
+    }
+
+    // Ground truth straight from the noise, on a subset
+    const size_t checked = 100000;
+    std::vector<uint8_t> truth(checked);
+    for (size_t i = 0; i < checked; ++i) truth[i] = continentIsLand(glm::radians(lats[i]), glm::radians(lons[i]));
+    harness.run("landmask/direct noise", [&] {
+        int count = 0;
+        for (size_t i = 0; i < checked; ++i) count += continentIsLand(glm::radians(lats[i]), glm::radians(lons[i]));
+        benchKeep(count);
+    }, (double)checked);
+
+    for (int l = 0; l < mask.levelCount(); ++l) {
+        const LandMask::Level& lv = mask.level(l);
+        std::string level = " level " + std::to_string(l);
+        size_t next = 0, count = 0;
+        harness.run("landmask/query" + level, [&] {
+            count += mask.isLand(lats[next], lons[next], l);
+            next = (next + 1) % n;
+        });
+        benchKeep(count);
+        if (!harness.run("landmask/classify 1M" + level, [&] {
+            mask.classify(lats.data(), lons.data(), land.data(), n, l);
+        }, (double)n)) continue;
+
+        size_t agree = 0;
+        for (size_t i = 0; i < checked; ++i) agree += land[i] == truth[i];
+        std::cout << "    level " << l << ": " << lv.width << "x" << lv.height << ", " << std::fixed
+                  << std::setprecision(0) << (double)lv.wordsPerRow * lv.height * 8 / 1024.0 << " KB, "
+                  << std::setprecision(2) << 100.0 * agree / checked << "% agree, " << std::setprecision(1)
+                  << 100.0 * mask.landFraction(l) << "% land" << std::defaultfloat << std::endl;
+    }
+}
+
+// Precision of the geodetic conversions and camera-relative floats, then
+// throughput of each conversion over a million points
+void benchGeodesy(BenchHarness& harness) {
+    const size_t n = 1000000;
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<double> lat(-M_PI / 2, M_PI / 2), lon(-M_PI, M_PI), alt(-500.0, 100000.0);
+    std::vector<double> lats(n), lons(n), heights(n);
+    for (size_t i = 0; i < n; ++i) {
+        lats[i] = lat(rng);
+        lons[i] = lon(rng);
+        heights[i] = alt(rng);
+    }
+    std::vector<double> x(n), y(n), z(n), lat2(n), lon2(n), h2(n);
+    geodeticToEcefBatch(lats.data(), lons.data(), heights.data(), x.data(), y.data(), z.data(), n);
+
+    // Throughput; the precision report below only comes with it
+    size_t resultsBefore = harness.results().size();
+    double az1 = 0.0, az2 = 0.0;
+    glm::dvec3 eye = geodeticToEcef(0.6, 0.2, 10000.0);
+    harness.run("geodesy/to ecef scalar 1M", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            glm::dvec3 p = geodeticToEcef(lats[i], lons[i], heights[i]);
+            x[i] = p.x; y[i] = p.y; z[i] = p.z;
+        }
+    }, (double)n);
+    harness.run("geodesy/to ecef batch 1M", [&] {
+        geodeticToEcefBatch(lats.data(), lons.data(), heights.data(), x.data(), y.data(), z.data(), n);
+    }, (double)n);
+    harness.run("geodesy/to geodetic scalar 1M", [&] {
+        for (size_t i = 0; i < n; ++i) {
+            Geodetic g = ecefToGeodetic(glm::dvec3(x[i], y[i], z[i]));
+            lat2[i] = g.latitude; lon2[i] = g.longitude; h2[i] = g.height;
+        }
+    }, (double)n);
+    harness.run("geodesy/to geodetic batch 1M", [&] {
+        ecefToGeodeticBatch(x.data(), y.data(), z.data(), lat2.data(), lon2.data(), h2.data(), n);
+    }, (double)n);
+    harness.run("geodesy/haversine 1M", [&] {
+        for (size_t i = 1; i < n; ++i) h2[i] = haversineDistance(lats[i - 1], lons[i - 1], lats[i], lons[i]);
+    }, (double)(n - 1));
+    const size_t vincentyCount = n / 10;
+    harness.run("geodesy/vincenty 100k", [&] {
+        for (size_t i = 1; i < vincentyCount; ++i) {
+            vincentyInverse(lats[i - 1], lons[i - 1], lats[i], lons[i], h2[i], az1, az2);
+        }
+    }, (double)(vincentyCount - 1));
+    std::vector<float> relative(3 * n);
+    harness.run("geodesy/relative to eye 1M", [&] {
+        relativeToEyeBatch(x.data(), y.data(), z.data(), n, eye, relative.data());
+    }, (double)n);
+    if (harness.results().size() == resultsBefore) return;
+
+    // Precision: batch vs scalar ECEF, round trips, fast sincos vs libm
+    geodeticToEcefBatch(lats.data(), lons.data(), heights.data(), x.data(), y.data(), z.data(), n);
+    ecefToGeodeticBatch(x.data(), y.data(), z.data(), lat2.data(), lon2.data(), h2.data(), n);
+    double batchVsScalar = 0.0, batchRoundTrip = 0.0, scalarRoundTrip = 0.0, sinCosError = 0.0;
+    for (size_t i = 0; i < n; i += 10) {
+        glm::dvec3 p = geodeticToEcef(lats[i], lons[i], heights[i]);
+        batchVsScalar = std::max(batchVsScalar, glm::length(p - glm::dvec3(x[i], y[i], z[i])));
+        batchRoundTrip = std::max(batchRoundTrip,
+            glm::length(geodeticToEcef(lat2[i], lon2[i], h2[i]) - p));
+        Geodetic g = ecefToGeodetic(p);
+        scalarRoundTrip = std::max(scalarRoundTrip,
+            glm::length(geodeticToEcef(g.latitude, g.longitude, g.height) - p));
+        double s, c;
+        sinCosFast(lons[i] * 50.0, s, c);
+        sinCosError = std::max(sinCosError, std::max(fabs(s - sin(lons[i] * 50.0)), fabs(c - cos(lons[i] * 50.0))));
+    }
+    std::cout << std::scientific << std::setprecision(2)
+              << "    batch vs scalar ECEF         " << batchVsScalar << " m" << std::endl
+              << "    scalar ECEF round trip       " << scalarRoundTrip << " m" << std::endl
+              << "    batch ECEF round trip        " << batchRoundTrip << " m" << std::endl
+              << "    sinCosFast vs libm           " << sinCosError << std::endl;
+
+    // Vincenty's published example: Flinders Peak to Buninyong, 54972.271 m
+    double distance = 0.0;
+    bool converged = vincentyInverse(glm::radians(-(37.0 + 57.0 / 60.0 + 3.72030 / 3600.0)),
+                                     glm::radians(144.0 + 25.0 / 60.0 + 29.52440 / 3600.0),
+                                     glm::radians(-(37.0 + 39.0 / 60.0 + 10.15610 / 3600.0)),
+                                     glm::radians(143.0 + 55.0 / 60.0 + 35.38390 / 3600.0),
+                                     distance, az1, az2);
+    if (converged) {
+        std::cout << std::fixed << std::setprecision(4)
+                  << "    Vincenty reference           " << distance - 54972.271 << " m off, azimuth "
+                  << fmod(glm::degrees(az1) + 360.0, 360.0) << " deg (306.8682)" << std::endl;
+    } else {
+        std::cout << "    Vincenty reference           did not converge" << std::endl;
+    }
+
+    // What float buys at Earth radius: one meter apart, absolute vs relative to eye
+    glm::dvec3 nearby = eye + glm::dvec3(0.6, -0.3, 0.7);
+    glm::dvec3 absoluteError = glm::dvec3(glm::vec3(nearby)) - glm::dvec3(glm::vec3(eye)) - (nearby - eye);
+    glm::dvec3 relativeError = glm::dvec3(relativeToEye(nearby, eye)) - (nearby - eye);
+    float hx, lx, ex, elx;
+    splitDouble(nearby.x, hx, lx);
+    splitDouble(eye.x, ex, elx);
+    double splitError = ((double)(hx - ex) + (double)(lx - elx)) - (nearby.x - eye.x);
+    std::cout << std::scientific << std::setprecision(2)
+              << "    float absolute, 1 m offset   " << glm::length(absoluteError) << " m" << std::endl
+              << "    float relative to eye        " << glm::length(relativeError) << " m" << std::endl
+              << "    high/low split (x)           " << fabs(splitError) << " m" << std::defaultfloat << std::endl;
+}
+
+// Socket ingestion end to end: a sender thread streams 1024-record batches
+// while this thread applies them at 60 Hz ticks, unpaced and then paced at
+// 1M updates/s. "ingest/apply" samples are ns per applied update over
+// eighth-second windows, so items/s is the update rate; "ingest/latency"
+// samples are each tick's mean latency from the sender's stamp to apply.
+void benchIngest(BenchHarness& harness) {
+    const char* socketPath = "/tmp/plane_bench_ingest.sock";
+    const size_t aircraft = 10000;
+    const uint32_t batch = 1024;
+    const double seconds = 2.0;
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<IngestRecord> records(batch * 64);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].aircraft = (uint32_t)(i % aircraft);
+        records[i].latitude = unit(rng) * 180.0f - 90.0f;
+        records[i].longitude = unit(rng) * 360.0f - 180.0f;
+        records[i].altitude = 10000.0f;
+        records[i].heading = unit(rng) * 360.0f;
+        records[i].groundSpeed = 230.0f;
+    }
+
+    const double rates[] = {0.0, 1e6};
+    for (double rate : rates) {
+        std::string pace = rate > 0.0 ? "1M/s" : "unpaced";
+        std::string applyName = "ingest/apply " + pace, latencyName = "ingest/latency " + pace;
+        if (!harness.selected(applyName) && !harness.selected(latencyName)) continue;
+
+        Fleet fleet;
+        fleet.spawnRandom(aircraft);
+        IngestService service;
+        if (!service.start(socketPath, fleet.metersPerUnit)) {
+            std::cout << "ingest/*: skipped, cannot listen on " << socketPath << std::endl;
+            return;
+        }
+
+        std::atomic<bool> done(false);
+        std::atomic<uint64_t> sent(0);
+        std::thread sender([&] {
+            IngestClient client;
+            if (!client.connect(socketPath)) return;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t b = 0; !done.load(); b = (b + 1) % 64) {
+                if (!client.send(&records[b * batch], batch)) return;
+                uint64_t total = sent.fetch_add(batch) + batch;
+                if (rate > 0.0) {
+                    std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(total / rate)));
+                }
+            }
+        });
+
+        // Ticks; the first half second is warmup
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now(), measureStart = start;
+        std::chrono::steady_clock::time_point tick = start, windowStart = start;
+        uint64_t applied = 0, windowApplied = 0, sentAtStart = 0;
+        double maxLatencyMs = 0.0;
+        std::vector<double> applySamples, latencySamples;
+        bool measuring = false;
+        while (true) {
+            tick += std::chrono::microseconds(16667);
+            std::this_thread::sleep_until(tick);
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double>(now - start).count();
+            if (!measuring && elapsed >= 0.5) {
+                measuring = true;
+                measureStart = windowStart = now;
+                sentAtStart = sent.load();
+                service.apply(fleet);
+                service.resetStatistics();
+                continue;
+            }
+            size_t n = service.apply(fleet);
+            if (measuring) {
+                applied += n;
+                windowApplied += n;
+                const IngestService::Stats& stats = service.statistics();
+                if (stats.batches > 0) latencySamples.push_back(stats.latencyMsSum / stats.batches * 1e6);
+                maxLatencyMs = std::max(maxLatencyMs, stats.maxLatencyMs);
+                service.resetStatistics();
+                double window = std::chrono::duration<double, std::nano>(now - windowStart).count();
+                if (window >= 0.125e9) {
+                    if (windowApplied > 0) applySamples.push_back(window / windowApplied);
+                    windowStart = now;
+                    windowApplied = 0;
+                }
+            }
+            if (elapsed >= 0.5 + seconds) break;
+        }
+        double measured = std::chrono::duration<double>(std::chrono::steady_clock::now() - measureStart).count();
+        uint64_t sentCount = sent.load() - sentAtStart;
+        done.store(true);
+        service.stop();
+        sender.join();
+
+        if (harness.selected(applyName)) harness.addSamples(applyName, applySamples);
+        if (harness.selected(latencyName)) harness.addSamples(latencyName, latencySamples);
+        std::cout << "    " << pace << ": sent " << std::fixed << std::setprecision(0) << sentCount / measured
+                  << "/s, applied " << applied / measured << "/s, latency max " << std::setprecision(2)
+                  << maxLatencyMs << " ms" << std::defaultfloat << std::endl;
+    }
+}
+
+// Smallest depth separation each depth mode can resolve at a given distance,
+// seen from the plane view at cruise altitude
+void benchDepthPrecision() {
+    std::cout << "\n=== Depth precision ===" << std::endl;
+
+    RenderView view;
+    view.planetRadius = EARTH_MEAN_RADIUS;
+    view.eye = glm::dvec3(0.0, EARTH_MEAN_RADIUS + 10000.0, 0.0);
+    double nearPlane, farPlane;
+    view.clipPlanes(nearPlane, farPlane);
+    const float reversedNear = 0.1f;
+
+    std::cout << "standard: 24-bit, near " << nearPlane << " m, far " << farPlane / 1000.0 << " km" << std::endl
+              << "reversed: float, near " << reversedNear << " m, far infinite" << std::endl;
+    const double distances[] = {1.0, 10.0, 100.0, 1000.0, 10000.0, 100000.0, 1000000.0, 3000000.0};
+    std::cout << std::setw(12) << "distance" << std::setw(16) << "standard" << std::setw(16) << "reversed" << std::endl;
+    for (double z : distances) {
+        // Window depth n f / ((f - n) z) - n / (f - n) quantized to 2^-24
+        std::string standard = "clipped";
+        if (z >= nearPlane && z <= farPlane) {
+            double slope = nearPlane * farPlane / ((farPlane - nearPlane) * z * z);
+            char text[32];
+            snprintf(text, sizeof(text), "%.3g m", 1.0 / 16777216.0 / slope);
+            standard = text;
+        }
+
+        // Reversed depth n / z, resolution one float ulp of it
+        float depth = (float)(reversedNear / z);
+        double ulp = (double)nextafterf(depth, 1.0f) - depth;
+        double reversed = ulp * z * z / reversedNear;
+        char text[32];
+        snprintf(text, sizeof(text), "%.3g m", reversed);
+
+        std::cout << std::setw(10) << z << " m" << std::setw(16) << standard << std::setw(16) << text << std::endl;
+    }
+}
+
+// Mesh generation at several resolutions; throughput in vertices
+void benchSphere(BenchHarness& harness) {
+    const int resolutions[][2] = {{18, 9}, {72, 36}, {288, 144}, {1152, 576}};
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    for (const int* r : resolutions) {
+        double vertexCount = (double)(r[0] + 1) * (r[1] + 1);
+        char name[64];
+        snprintf(name, sizeof(name), "sphere/generate %dx%d", r[0], r[1]);
+        harness.run(name, [&] {
+            vertices.clear();
+            indices.clear();
+            generateSphere(1.0f, r[0], r[1], vertices, indices);
+        }, vertexCount);
+        snprintf(name, sizeof(name), "sphere/split %dx%d", r[0], r[1]);
+        harness.run(name, [&] {
+            generateSphereSplit(EARTH_MEAN_RADIUS, r[0], r[1], vertices, indices);
+        }, vertexCount);
+    }
+}
+
+// CPU port of the shader noise; throughput in samples
+void benchNoise(BenchHarness& harness) {
+    const size_t n = 4096;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<glm::vec3> directions(n);
+    std::vector<float> lats(n), lons(n);
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 d;
+        do {
+            d = glm::vec3(unit(rng), unit(rng), unit(rng));
+        } while (glm::dot(d, d) < 1e-3f || glm::dot(d, d) > 1.0f);
+        directions[i] = glm::normalize(d);
+        lats[i] = asinf(directions[i].y);
+        lons[i] = atan2f(directions[i].z, directions[i].x);
+    }
+
+    harness.run("noise/continentNoise", [&] {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += continentNoise(directions[i]);
+        benchKeep(sum);
+    }, (double)n);
+    harness.run("noise/continentNoiseRaw", [&] {
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) sum += continentNoiseRaw(lats[i], lons[i]);
+        benchKeep(sum);
+    }, (double)n);
+    harness.run("noise/continentIsLand", [&] {
+        int land = 0;
+        for (size_t i = 0; i < n; ++i) land += continentIsLand(lats[i], lons[i]);
+        benchKeep(land);
+    }, (double)n);
+}
+
+// Per-frame camera work from camera.h
+void benchCameraMath(BenchHarness& harness) {
+    Camera camera(800.0f, 600.0f);
+    harness.run("camera/kinematic path", [&] {
+        RenderView view = camera.getRenderView(1.0f / 60.0f);
+        benchKeep(view);
+    });
+
+    Camera orbit(800.0f, 600.0f);
+    orbit.manualControl = true;
+    orbit.globeRotationX = 0.3f;
+    orbit.globeRotationY = 1.1f;
+    harness.run("camera/manual orbit", [&] {
+        orbit.cameraAngleX += 0.001f;
+        RenderView view = orbit.getRenderView(1.0f / 60.0f);
+        benchKeep(view);
+    });
+
+    FlightModel model;
+    model.resize(1);
+    model.spawn(0, glm::dvec3(1.0, 0.0, 0.0), glm::dvec3(0.0, 0.0, 1.0), 10000.0, 230.0);
+    Camera cockpit(800.0f, 600.0f);
+    cockpit.flightModel = &model;
+    harness.run("camera/cockpit", [&] {
+        RenderView view = cockpit.getRenderView(1.0f / 60.0f);
+        benchKeep(view);
+    });
+
+    RenderView view = cockpit.getRenderView(0.0f);
+    float fov = glm::radians(45.0f);
+    float aspect = 4.0f / 3.0f;
+    harness.run("camera/projection", [&] {
+        benchKeep(view);
+        glm::mat4 projection = view.projection(fov, aspect);
+        benchKeep(projection);
+    });
+    harness.run("camera/reversed projection", [&] {
+        benchKeep(aspect);
+        glm::mat4 projection = view.reversedProjection(fov, aspect);
+        benchKeep(projection);
+    });
+    ProjectionCache projectionCache;
+    harness.run("camera/cached reversed projection", [&] {
+        benchKeep(aspect);
+        glm::mat4 projection = projectionCache.get(view, fov, aspect, true);
+        benchKeep(projection);
+    });
+    harness.run("camera/globe view + projection", [&] {
+        benchKeep(view);
+        glm::mat4 viewProjection = view.globeProjection(fov, aspect) * view.globeViewMatrix();
+        benchKeep(viewProjection);
+    });
+    glm::mat4 viewProjection = view.reversedProjection(fov, aspect) * view.rotation;
+    harness.run("camera/frustum planes", [&] {
+        benchKeep(viewProjection);
+        glm::vec4 planes[4];
+        frustumSidePlanes(viewProjection, planes);
+        benchKeep(planes);
+    });
+}
+
+// Callsign label layout for a 10k fleet seen from orbit: the moving case
+// alternates between two fleet states a minute of flight apart, so most
+// labels pass the move threshold; the static case hits the early out
+void benchLabels(BenchHarness& harness) {
+    const size_t count = 10000;
+    const int width = 1920, height = 1080;
+    Fleet a;
+    a.spawnRandom(count);
+    Fleet b = a;
+    b.propagate(60.0f);
+
+    Camera camera((float)width, (float)height);
+    camera.manualControl = true;
+    RenderView view = camera.getRenderView(0.0f);
+    glm::mat4 viewProjection = view.reversedProjection(glm::radians(45.0f), (float)width / height) * view.rotation;
+
+    LabelLayout layout;
+    layout.update(a, view, viewProjection, width, height);
+    size_t placed = layout.visibleCount();
+
+    bool flip = false;
+    if (harness.run("labels/layout 10k moving", [&] {
+        flip = !flip;
+        layout.update(flip ? b : a, view, viewProjection, width, height);
+        size_t shown = layout.visibleCount();
+        benchKeep(shown);
+    }, (double)count)) {
+        std::cout << "    " << placed << " of " << count << " placed" << std::endl;
+    }
+    harness.run("labels/layout 10k static", [&] {
+        layout.update(a, view, viewProjection, width, height);
+        size_t shown = layout.visibleCount();
+        benchKeep(shown);
+    }, (double)count);
+}
+
+// Per-tick cost of publishing to shared-memory telemetry, and of a reader
+// visiting the newest snapshot in place
+void benchTelemetry(BenchHarness& harness) {
+    FlightModel plane;
+    plane.resize(1);
+    plane.spawn(0, glm::dvec3(1.0, 0.0, 0.0), glm::dvec3(0.0, 0.0, 1.0), 10000.0, 230.0);
+
+    const size_t counts[] = {2000, 10000};
+    for (size_t count : counts) {
+        Fleet fleet;
+        fleet.spawnRandom(count);
+        TelemetryPublisher publisher;
+        if (!publisher.open("/plane_bench_telemetry", count)) {
+            std::cout << "telemetry/*: skipped, no shared memory" << std::endl;
+            return;
+        }
+        std::string size = count >= 10000 ? "10k" : "2k";
+        double simTime = 0.0;
+        harness.run("telemetry/publish " + size, [&] {
+            publisher.publish(fleet, &plane, 0, simTime += 1.0);
+        }, (double)count);
+
+        TelemetryReader reader;
+        if (reader.open("/plane_bench_telemetry")) {
+            harness.run("telemetry/read " + size, [&] {
+                double sum = 0.0;
+                reader.read([&](const TelemetrySnapshot& s, uint32_t capacity) {
+                    const float* speed = s.array(TelemetrySnapshot::GROUND_SPEED, capacity);
+                    for (uint32_t i = 0; i < s.aircraftCount; ++i) sum += speed[i];
+                });
+                benchKeep(sum);
+            }, (double)count);
+        }
+    }
+}
+
+// Whole frames through SceneRenderer in a hidden window, each ended with
+// glFinish so the samples are end-to-end. The second view configurations
+// add the orbit view to the cockpit, and their cost over the plain
+// reversed-Z cockpit frame is the price of the extra view; the HDR ones
+// likewise price the post chain, with either metering path. The far orbit
+// pair compares the mesh with the globe impostor. The ray-cast
+// configurations compare against the mesh configuration of the same name at
+// three zooms: the cockpit, the default orbit and the far orbit, and once
+// with standard Z in the cockpit, where the proxy lies past the far plane.
+// Skipped without a display.
+void benchFrameRendering(BenchHarness& harness) {
+    struct FrameConfig {
+        const char* name;
+        bool reversedZ, orbit;
+        SecondaryView::Layout layout;
+        float resolutionScale;
+        int updateInterval;
+        bool hdr, computeMetering;
+        bool spin;            // Orbit turning a little every frame
+        float distance;       // Orbit distance, planet radii (0 for the camera's default)
+        bool impostor;        // Distant globe drawn as a cached sprite
+        bool rayCast;         // Globe intersected per pixel instead of the mesh
+    };
+    const FrameConfig configs[] = {
+        {"frame/cockpit", false, false, SecondaryView::OFF, 1.0f, 1, false, false, false, 0.0f, false, false},
+        {"frame/cockpit reversed-z", true, false, SecondaryView::OFF, 1.0f, 1, false, false, false, 0.0f, false, false},
+        {"frame/orbit reversed-z", true, true, SecondaryView::OFF, 1.0f, 1, false, false, false, 0.0f, false, false},
+        {"frame/cockpit + inset", true, false, SecondaryView::PICTURE_IN_PICTURE, 1.0f, 1, false, false, false, 0.0f, false, false},
+        {"frame/cockpit + inset half-res every 2nd", true, false, SecondaryView::PICTURE_IN_PICTURE, 0.5f, 2, false, false, false, 0.0f, false, false},
+        {"frame/split screen", true, false, SecondaryView::SPLIT_SCREEN, 1.0f, 1, false, false, false, 0.0f, false, false},
+        {"frame/cockpit reversed-z hdr", true, false, SecondaryView::OFF, 1.0f, 1, true, true, false, 0.0f, false, false},
+        {"frame/cockpit reversed-z hdr mip metering", true, false, SecondaryView::OFF, 1.0f, 1, true, false, false, 0.0f, false, false},
+        {"frame/far orbit spinning reversed-z", true, true, SecondaryView::OFF, 1.0f, 1, false, false, true, 8.0f, false, false},
+        {"frame/far orbit spinning reversed-z impostor", true, true, SecondaryView::OFF, 1.0f, 1, false, false, true, 8.0f, true, false},
+        {"frame/cockpit reversed-z ray cast", true, false, SecondaryView::OFF, 1.0f, 1, false, false, false, 0.0f, false, true},
+        {"frame/orbit reversed-z ray cast", true, true, SecondaryView::OFF, 1.0f, 1, false, false, false, 0.0f, false, true},
+        {"frame/far orbit spinning reversed-z ray cast", true, true, SecondaryView::OFF, 1.0f, 1, false, false, true, 8.0f, false, true},
+        {"frame/cockpit ray cast", false, false, SecondaryView::OFF, 1.0f, 1, false, false, false, 0.0f, false, true},
+    };
+    const int configCount = (int)(sizeof(configs) / sizeof(configs[0]));
+    bool any = false;
+    for (const FrameConfig& config : configs) any = any || harness.selected(config.name);
+    if (!any) return;
+
+    if (!glfwInit()) {
+        std::cout << "frame/*: skipped, GLFW failed to initialize" << std::endl;
+        return;
+    }
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    #ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+    #endif
+    const int width = 800, height = 600;
+    GLFWwindow* window = glfwCreateWindow(width, height, "plane_bench", NULL, NULL);
+    if (!window) {
+        std::cout << "frame/*: skipped, no OpenGL 3.3 context" << std::endl;
+        glfwTerminate();
+        return;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cout << "frame/*: skipped, GLAD failed to load" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return;
+    }
+    std::cout << "renderer: " << glGetString(GL_RENDERER) << std::endl;
+    glEnable(GL_DEPTH_TEST);
+
+    Fleet fleet;
+    fleet.spawnRandom(2000);
+    const glm::dvec3 sunDirection(1.0, 0.0, 0.0);
+    const int framesPerSample = 10;
+
+    const std::string singleViewName = "frame/cockpit reversed-z";  // Baseline for second view and HDR costs
+    std::map<std::string, std::pair<double, double>> meshResults;  // Frame median ns and globe pass ms by name
+    for (int c = 0; c < configCount; ++c) {
+        const FrameConfig& config = configs[c];
+        if (!harness.selected(config.name)) continue;
+
+        SceneRenderer scene;
+        scene.hdr.enabled = config.hdr;
+        scene.hdr.allowCompute = config.computeMetering;
+        scene.init(EARTH_MEAN_RADIUS, config.reversedZ);
+        scene.impostor.enabled = config.impostor;
+        scene.rayCastGlobe = config.rayCast;
+        Camera camera(width, height);
+        camera.manualControl = config.orbit;
+        if (config.distance > 0.0f) camera.cameraDistance = config.distance;
+        SecondaryView secondView;
+        secondView.layout = config.layout;
+        secondView.resolutionScale = config.resolutionScale;
+        secondView.updateInterval = config.updateInterval;
+
+        std::vector<double> samples;
+        for (int s = -harness.warmupSamples; s < harness.repetitions; ++s) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int f = 0; f < framesPerSample; ++f) {
+                if (config.spin) camera.cameraAngleX += 0.002f;
+                RenderView view = camera.getRenderView(1.0f / 60.0f);
+                Viewport mainViewport, secondViewport;
+                secondView.layoutViewports(width, height, mainViewport, secondViewport);
+                scene.renderFrame(view, sunDirection, fleet, mainViewport);
+                if (secondView.enabled()) {
+                    secondView.render(scene, companionView(camera), sunDirection, fleet, secondViewport);
+                    secondView.present(scene, secondViewport);
+                }
+                glFinish();
+            }
+            double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            if (s >= 0) samples.push_back(ns / framesPerSample);
+        }
+        const BenchResult& result = harness.addSamples(config.name, samples, (double)width * height);
+
+        // Mesh frames by name, for the comparisons below
+        double globePassMs = 0.0;
+        for (const Profiler::Stat& stat : scene.profiler.stats()) {
+            if (stat.name == "globe" && stat.runs > 0) globePassMs = stat.gpuMs / stat.runs;
+        }
+        std::string name = config.name;
+        if (!config.rayCast) meshResults[name] = std::make_pair(result.median, globePassMs);
+
+        std::map<std::string, std::pair<double, double>>::const_iterator single = meshResults.find(singleViewName);
+        double singleViewNs = single != meshResults.end() ? single->second.first : 0.0;
+        if (secondView.enabled() && singleViewNs > 0.0) {
+            std::cout << "    second view costs " << std::fixed << std::setprecision(3)
+                      << (result.median - singleViewNs) / 1e6 << " ms over the single view ("
+                      << secondView.renderedFrames << " rendered, " << secondView.reusedFrames << " reused)"
+                      << std::defaultfloat << std::endl;
+        }
+        if (scene.hdr.enabled && singleViewNs > 0.0) {
+            std::cout << "    post chain costs " << std::fixed << std::setprecision(3)
+                      << (result.median - singleViewNs) / 1e6 << " ms over the LDR frame ("
+                      << scene.hdr.lastCostMs() << " ms gpu, " << (scene.hdr.usesCompute() ? "histogram" : "mips")
+                      << ", every " << scene.hdr.sampleStride() << " pixel(s))" << std::defaultfloat << std::endl;
+        }
+
+        // The impostor's sprite plus picture bands spread over the sprite
+        // frames, against the globe pass of the mesh at the same zoom
+        if (config.impostor) {
+            double spriteMs = 0.0, refreshMs = 0.0;
+            long long spriteFrames = 0;
+            for (const Profiler::Stat& stat : scene.profiler.stats()) {
+                if (stat.name == "globe impostor") {
+                    spriteMs = stat.gpuMs;
+                    spriteFrames = stat.runs;
+                }
+                if (stat.name == "impostor refresh") refreshMs = stat.gpuMs;
+            }
+            const GlobeImpostor::Stats& impostorStats = scene.impostor.statistics();
+            double perFrameMs = spriteFrames > 0 ? (spriteMs + refreshMs) / spriteFrames : 0.0;
+            std::map<std::string, std::pair<double, double>>::const_iterator mesh =
+                meshResults.find(name.substr(0, name.size() - std::string(" impostor").size()));
+            std::cout << "    impostor " << std::fixed << std::setprecision(3) << perFrameMs << " ms gpu a frame";
+            if (perFrameMs > 0.0 && mesh != meshResults.end() && mesh->second.second > 0.0) {
+                std::cout << ", mesh " << mesh->second.second << " (" << std::setprecision(1)
+                          << mesh->second.second / perFrameMs << "x)";
+            }
+            std::cout << std::defaultfloat << "; " << impostorStats.hits << "/" << impostorStats.frames
+                      << " frames reused the picture, " << impostorStats.redraws << " redraw(s)" << std::endl;
+        }
+
+        // The ray-cast globe against the mesh at the same zoom
+        if (config.rayCast) {
+            std::map<std::string, std::pair<double, double>>::const_iterator mesh =
+                meshResults.find(name.substr(0, name.size() - std::string(" ray cast").size()));
+            if (mesh != meshResults.end()) {
+                std::cout << "    ray cast frame " << std::fixed << std::setprecision(3) << result.median / 1e6
+                          << " ms, mesh " << mesh->second.first / 1e6 << " ms; globe pass " << globePassMs
+                          << " ms gpu, mesh " << mesh->second.second << " ms" << std::defaultfloat << std::endl;
+            }
+        }
+
+        // GPU split of the last resolved frames
+        for (const Profiler::Stat& stat : scene.profiler.stats()) {
+            std::cout << "    " << std::left << std::setw(32) << stat.name << std::right
+                      << std::fixed << std::setprecision(3) << stat.lastGpuMs << " ms gpu"
+                      << std::defaultfloat << std::endl;
+        }
+        secondView.cleanup();
+        scene.cleanup();
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
+
+int main(int argc, char** argv) {
+    BenchHarness harness;
+    std::string jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--json" && hasValue) jsonPath = argv[++i];
+        else if (arg == "--filter" && hasValue) harness.filter = argv[++i];
+        else if (arg == "--repetitions" && hasValue) harness.repetitions = std::max(1, atoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue) harness.warmupSamples = std::max(0, atoi(argv[++i]));
+        else if (arg == "--min-sample-us" && hasValue) harness.minSampleMicros = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--json FILE] [--filter TEXT] [--repetitions N]"
+                      << " [--warmup N] [--min-sample-us N]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Analytic, nothing to time
+    if (harness.selected("depth")) benchDepthPrecision();
+
+    // Tracked benchmarks
+    std::cout << "\n=== Benchmarks (" << harness.repetitions << " samples, "
+              << harness.warmupSamples << " warmup) ===" << std::endl;
+    harness.printHeader();
+    benchBvh(harness);
+    benchFlightModel(harness);
+    benchWindField(harness);
+    benchRoutePlanner(harness);
+    benchLandMask(harness);
+    benchGeodesy(harness);
+    benchSphere(harness);
+    benchNoise(harness);
+    benchCameraMath(harness);
+    benchLabels(harness);
+    benchTelemetry(harness);
+    benchIngest(harness);
+    benchFrameRendering(harness);
+
+    if (!jsonPath.empty()) {
+        if (!harness.writeJson(jsonPath)) return 1;
+        std::cout << "Wrote " << harness.results().size() << " results to " << jsonPath << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,300 @@
+// Compares two benchmark runs and flags statistically significant regressions
+//
+// Usage: bench_compare BASELINE CANDIDATE [--threshold PERCENT] [--confidence LEVEL]
+//                      [--resamples N] [--report FILE]
+//
+// Inputs are plane_bench --json files, or frame-time logs with one frame
+// time per line (compared as a single metric, "frames"). For every metric
+// in both runs the ratio of candidate to baseline median gets a percentile
+// bootstrap confidence interval. A metric regresses when the whole interval
+// lies above 1 and the median is more than the threshold slower.
+//
+// Exit status: 0 no regressions, 1 at least one regression, 2 bad input.
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cctype>
+
+struct Metric {
+    std::string name;
+    std::vector<double> samples;
+};
+
+// Just enough JSON for plane_bench output: finds each benchmark's name and
+// samples array, skipping everything else
+class BenchJsonReader {
+public:
+    explicit BenchJsonReader(const std::string& text) : text(text) {}
+
+    bool read(std::vector<Metric>& metrics) {
+        skipSpace();
+        if (!parseValue(nullptr)) return false;
+        metrics = found;
+        return true;
+    }
+
+private:
+    const std::string& text;
+    size_t pos = 0;
+    std::vector<Metric> found;
+
+    void skipSpace() {
+        while (pos < text.size() && isspace((unsigned char)text[pos])) ++pos;
+    }
+
+    bool expect(char c) {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != c) return false;
+        ++pos;
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (!expect('"')) return false;
+        out.clear();
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) ++pos;
+            out += text[pos++];
+        }
+        return expect('"');
+    }
+
+    bool parseNumber(double& out) {
+        skipSpace();
+        const char* start = text.c_str() + pos;
+        char* end = nullptr;
+        out = strtod(start, &end);
+        if (end == start) return false;
+        pos += end - start;
+        return true;
+    }
+
+    // metric is non-null while inside a benchmark object
+    bool parseValue(Metric* metric, const std::string& key = "") {
+        skipSpace();
+        if (pos >= text.size()) return false;
+        char c = text[pos];
+        if (c == '{') {
+            ++pos;
+            Metric object;
+            bool isBenchmark = false;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}') { ++pos; return true; }
+            do {
+                std::string member;
+                if (!parseString(member) || !expect(':')) return false;
+                if (member == "name" || member == "samples") isBenchmark = true;
+                if (!parseValue(&object, member)) return false;
+            } while (expect(','));
+            if (!expect('}')) return false;
+            if (isBenchmark && !object.name.empty()) found.push_back(object);
+            return true;
+        }
+        if (c == '[') {
+            ++pos;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ']') { ++pos; return true; }
+            do {
+                skipSpace();
+                if (key == "samples" && metric && pos < text.size() && text[pos] != '{') {
+                    double value;
+                    if (!parseNumber(value)) return false;
+                    metric->samples.push_back(value);
+                } else if (!parseValue(nullptr)) {
+                    return false;
+                }
+            } while (expect(','));
+            return expect(']');
+        }
+        if (c == '"') {
+            std::string value;
+            if (!parseString(value)) return false;
+            if (key == "name" && metric) metric->name = value;
+            return true;
+        }
+        if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 4, "null") == 0) { pos += 4; return true; }
+        if (text.compare(pos, 5, "false") == 0) { pos += 5; return true; }
+        double ignored;
+        return parseNumber(ignored);
+    }
+};
+
+bool loadMetrics(const char* path, std::vector<Metric>& metrics) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first != std::string::npos && text[first] == '{') {
+        BenchJsonReader reader(text);
+        if (!reader.read(metrics)) {
+            std::cerr << "Malformed benchmark JSON: " << path << std::endl;
+            return false;
+        }
+    } else {
+        // Frame-time log
+        Metric frames;
+        frames.name = "frames";
+        std::istringstream lines(text);
+        double value;
+        while (lines >> value) frames.samples.push_back(value);
+        if (!frames.samples.empty()) metrics.push_back(frames);
+    }
+    if (metrics.empty()) {
+        std::cerr << "No samples in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+double median(std::vector<double>& values) {
+    size_t n = values.size();
+    std::nth_element(values.begin(), values.begin() + n / 2, values.end());
+    double upper = values[n / 2];
+    if (n % 2) return upper;
+    return 0.5 * (upper + *std::max_element(values.begin(), values.begin() + n / 2));
+}
+
+struct Comparison {
+    std::string name;
+    double baseline = 0.0, candidate = 0.0;  // Medians
+    double ratio = 1.0, low = 1.0, high = 1.0;
+    const char* verdict = "";
+    bool regression = false;
+};
+
+// Percentile bootstrap of the ratio of medians
+void bootstrap(const Metric& base, const Metric& cand, int resamples, double confidence,
+               std::mt19937& rng, Comparison& out) {
+    std::vector<double> a = base.samples, b = cand.samples;
+    out.baseline = median(a);
+    out.candidate = median(b);
+    out.ratio = out.candidate / out.baseline;
+
+    std::uniform_int_distribution<size_t> pickA(0, a.size() - 1), pickB(0, b.size() - 1);
+    std::vector<double> ratios(resamples), ra(a.size()), rb(b.size());
+    for (int r = 0; r < resamples; ++r) {
+        for (size_t i = 0; i < ra.size(); ++i) ra[i] = base.samples[pickA(rng)];
+        for (size_t i = 0; i < rb.size(); ++i) rb[i] = cand.samples[pickB(rng)];
+        ratios[r] = median(rb) / median(ra);
+    }
+    std::sort(ratios.begin(), ratios.end());
+    double tail = 0.5 * (1.0 - confidence);
+    out.low = ratios[(size_t)(tail * (resamples - 1))];
+    out.high = ratios[(size_t)((1.0 - tail) * (resamples - 1))];
+}
+
+int main(int argc, char** argv) {
+    const char* baselinePath = nullptr;
+    const char* candidatePath = nullptr;
+    const char* reportPath = nullptr;
+    double threshold = 5.0;
+    double confidence = 0.95;
+    int resamples = 10000;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threshold" && hasValue) threshold = atof(argv[++i]);
+        else if (arg == "--confidence" && hasValue) confidence = atof(argv[++i]);
+        else if (arg == "--resamples" && hasValue) resamples = std::max(100, atoi(argv[++i]));
+        else if (arg == "--report" && hasValue) reportPath = argv[++i];
+        else if (arg[0] != '-' && !baselinePath) baselinePath = argv[i];
+        else if (arg[0] != '-' && !candidatePath) candidatePath = argv[i];
+        else {
+            candidatePath = nullptr;
+            break;
+        }
+    }
+    if (!baselinePath || !candidatePath || confidence <= 0.0 || confidence >= 1.0) {
+        std::cerr << "Usage: " << argv[0] << " BASELINE CANDIDATE [--threshold PERCENT]"
+                  << " [--confidence LEVEL] [--resamples N] [--report FILE]" << std::endl;
+        return 2;
+    }
+
+    std::vector<Metric> baseline, candidate;
+    if (!loadMetrics(baselinePath, baseline) || !loadMetrics(candidatePath, candidate)) return 2;
+
+    std::map<std::string, const Metric*> candidateByName;
+    for (const Metric& m : candidate) candidateByName[m.name] = &m;
+
+    // Fixed seed, so the same inputs always give the same verdicts
+    std::mt19937 rng(2024);
+    std::vector<Comparison> comparisons;
+    std::vector<std::string> missing;
+    int regressions = 0, improvements = 0;
+    const double limit = 1.0 + threshold / 100.0;
+    for (const Metric& base : baseline) {
+        std::map<std::string, const Metric*>::const_iterator it = candidateByName.find(base.name);
+        if (it == candidateByName.end() || it->second->samples.empty() || base.samples.empty()) {
+            missing.push_back(base.name);
+            continue;
+        }
+
+        Comparison c;
+        c.name = base.name;
+        bootstrap(base, *it->second, resamples, confidence, rng, c);
+        if (c.low > 1.0 && c.ratio > limit) {
+            c.verdict = "REGRESSION";
+            c.regression = true;
+            ++regressions;
+        } else if (c.high < 1.0 && c.ratio < 1.0 / limit) {
+            c.verdict = "improved";
+            ++improvements;
+        } else if (c.low > 1.0 || c.high < 1.0) {
+            c.verdict = "within threshold";
+        } else {
+            c.verdict = "no change";
+        }
+        comparisons.push_back(c);
+        candidateByName.erase(it);
+    }
+
+    // Compact report: one line per metric, regressions first
+    std::stable_sort(comparisons.begin(), comparisons.end(), [](const Comparison& a, const Comparison& b) {
+        return a.regression && !b.regression;
+    });
+    std::ostringstream report;
+    report << "Baseline:  " << baselinePath << "\nCandidate: " << candidatePath << "\n"
+           << "Median ratio with " << (int)(confidence * 100 + 0.5) << "% bootstrap CI ("
+           << resamples << " resamples), threshold " << threshold << "%\n\n";
+    report << std::left << std::setw(36) << "metric" << std::right
+           << std::setw(12) << "baseline" << std::setw(12) << "candidate"
+           << std::setw(9) << "change" << std::setw(22) << "CI" << "  verdict\n";
+    char line[256];
+    for (const Comparison& c : comparisons) {
+        snprintf(line, sizeof(line), "%-36s%12.4g%12.4g%+8.1f%%   [%+7.1f%%, %+7.1f%%]  %s\n",
+                 c.name.c_str(), c.baseline, c.candidate, (c.ratio - 1.0) * 100.0,
+                 (c.low - 1.0) * 100.0, (c.high - 1.0) * 100.0, c.verdict);
+        report << line;
+    }
+    for (const std::string& name : missing) report << "missing in candidate: " << name << "\n";
+    for (const auto& extra : candidateByName) report << "new in candidate: " << extra.first << "\n";
+    report << "\n" << comparisons.size() << " compared, " << regressions << " regressed, "
+           << improvements << " improved\n";
+    report << (regressions ? "RESULT: FAIL\n" : "RESULT: PASS\n");
+
+    std::cout << report.str();
+    if (reportPath) {
+        std::ofstream file(reportPath);
+        if (!file) {
+            std::cerr << "Failed to write report: " << reportPath << std::endl;
+            return 2;
+        }
+        file << report.str();
+    }
+    return regressions ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <ctime>
+#include <cstdio>
+
+// Make the optimizer treat value as read and rewritten, so benchmark work
+// on it is neither dropped nor hoisted out of the timing loop
+template <typename T>
+inline void benchKeep(T& value) {
+    asm volatile("" : "+m"(value) : : "memory");
+}
+
+// Statistics for one benchmark: per-call times in nanoseconds, one per sample
+struct BenchResult {
+    std::string name;
+    double itemsPerCall = 1.0;       // For throughput, e.g. vertices or pixels per call
+    long long callsPerSample = 1;
+    std::vector<double> samples;     // ns per call
+    double mean = 0.0, median = 0.0, stddev = 0.0;
+    double min = 0.0, max = 0.0, p95 = 0.0;
+
+    double itemsPerSecond() const { return median > 0.0 ? itemsPerCall * 1e9 / median : 0.0; }
+};
+
+// Micro-benchmark runner. Each benchmark is warmed up, calibrated so one
+// sample takes at least minSampleMicros, then timed for `repetitions`
+// samples. Results accumulate for printing and for a JSON file that later
+// runs can be compared against.
+class BenchHarness {
+public:
+    int warmupSamples = 2;
+    int repetitions = 15;
+    double minSampleMicros = 2000.0;
+    std::string filter;              // Only run benchmarks whose name contains this
+
+    bool selected(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    // Time f(); returns nullptr if filtered out
+    template <typename F>
+    const BenchResult* run(const std::string& name, F f, double itemsPerCall = 1.0) {
+        if (!selected(name)) return nullptr;
+
+        BenchResult result;
+        result.name = name;
+        result.itemsPerCall = itemsPerCall;
+
+        // Calibrate: grow the batch until one sample is long enough to time
+        long long calls = 1;
+        while (true) {
+            double micros = timeBatch(f, calls) * 1e-3;
+            if (micros >= minSampleMicros || calls >= (1LL << 30)) break;
+            long long grow = micros > 0.0 ? (long long)(minSampleMicros / micros * 1.2) + 1 : 10;
+            calls *= std::min(std::max(grow, 2LL), 100LL);
+        }
+        result.callsPerSample = calls;
+
+        for (int w = 0; w < warmupSamples; ++w) timeBatch(f, calls);
+        for (int r = 0; r < repetitions; ++r) result.samples.push_back(timeBatch(f, calls) / calls);
+
+        return &record(result);
+    }
+
+    // For benchmarks that time themselves (e.g. GPU frames); samples in ns
+    const BenchResult& addSamples(const std::string& name, const std::vector<double>& samples,
+                                  double itemsPerCall = 1.0) {
+        BenchResult result;
+        result.name = name;
+        result.itemsPerCall = itemsPerCall;
+        result.samples = samples;
+        return record(result);
+    }
+
+    const std::vector<BenchResult>& results() const { return resultList; }
+
+    void printHeader() const {
+        std::cout << std::left << std::setw(36) << "benchmark" << std::right
+                  << std::setw(12) << "median" << std::setw(12) << "mean"
+                  << std::setw(10) << "stddev" << std::setw(12) << "p95"
+                  << std::setw(14) << "items/s" << std::endl;
+    }
+
+    static void print(const BenchResult& r) {
+        std::cout << std::left << std::setw(36) << r.name << std::right
+                  << std::setw(12) << formatTime(r.median) << std::setw(12) << formatTime(r.mean)
+                  << std::setw(9) << std::fixed << std::setprecision(1)
+                  << (r.mean > 0.0 ? 100.0 * r.stddev / r.mean : 0.0) << "%"
+                  << std::setw(12) << formatTime(r.p95)
+                  << std::setw(14) << std::scientific << std::setprecision(3) << r.itemsPerSecond()
+                  << std::defaultfloat << std::endl;
+    }
+
+    bool writeJson(const std::string& path) const {
+        std::ofstream file(path.c_str());
+        if (!file) {
+            std::cerr << "Failed to write benchmark results: " << path << std::endl;
+            return false;
+        }
+
+        char date[32];
+        time_t now = time(nullptr);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+        file << std::setprecision(10);
+        file << "{\n  \"suite\": \"plane_bench\",\n"
+             << "  \"date\": \"" << date << "\",\n"
+             << "  \"compiler\": \"" << escape(__VERSION__) << "\",\n"
+             << "  \"repetitions\": " << repetitions << ",\n"
+             << "  \"benchmarks\": [";
+        for (size_t i = 0; i < resultList.size(); ++i) {
+            const BenchResult& r = resultList[i];
+            file << (i ? "," : "") << "\n    {\"name\": \"" << escape(r.name) << "\""
+                 << ", \"unit\": \"ns\""
+                 << ", \"calls_per_sample\": " << r.callsPerSample
+                 << ", \"items_per_call\": " << r.itemsPerCall
+                 << ", \"mean\": " << r.mean << ", \"median\": " << r.median
+                 << ", \"stddev\": " << r.stddev << ", \"min\": " << r.min
+                 << ", \"max\": " << r.max << ", \"p95\": " << r.p95
+                 << ",\n     \"samples\": [";
+            for (size_t s = 0; s < r.samples.size(); ++s) file << (s ? ", " : "") << r.samples[s];
+            file << "]}";
+        }
+        file << "\n  ]\n}\n";
+        return (bool)file;
+    }
+
+private:
+    std::vector<BenchResult> resultList;
+
+    template <typename F>
+    static double timeBatch(F& f, long long calls) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < calls; ++i) f();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const BenchResult& record(BenchResult& result) {
+        std::vector<double> sorted = result.samples;
+        std::sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+        if (n > 0) {
+            double sum = 0.0;
+            for (double s : sorted) sum += s;
+            result.mean = sum / n;
+            double squares = 0.0;
+            for (double s : sorted) squares += (s - result.mean) * (s - result.mean);
+            result.stddev = n > 1 ? sqrt(squares / (n - 1)) : 0.0;
+            result.median = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+            result.min = sorted.front();
+            result.max = sorted.back();
+            result.p95 = sorted[std::min(n - 1, (size_t)ceil(0.95 * n) - 1)];
+        }
+        resultList.push_back(result);
+        print(resultList.back());
+        return resultList.back();
+    }
+
+    static std::string formatTime(double ns) {
+        char text[32];
+        if (ns < 1e3) snprintf(text, sizeof(text), "%.1f ns", ns);
+        else if (ns < 1e6) snprintf(text, sizeof(text), "%.2f us", ns * 1e-3);
+        else snprintf(text, sizeof(text), "%.2f ms", ns * 1e-6);
+        return text;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+};
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,500 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <memory>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "fleet.h"
+#include "ray.h"
+
+// 4-wide bounding volume hierarchy over aircraft, each treated as a sphere of
+// fixed radius. Nodes are flattened in depth-first order (children always
+// after their parent) and store the bounds of their four children as
+// structure of arrays, so one node visit tests four boxes in a single loop.
+class Bvh4 {
+public:
+    struct Node {
+        float minX[4], minY[4], minZ[4];
+        float maxX[4], maxY[4], maxZ[4];
+        int child[4];  // Inner: node index. Leaf: first primitive. Empty: -1
+        int count[4];  // Leaf primitive count, 0 for inner and empty slots
+    };
+
+    float radius = 0.015f;  // Sphere radius around each aircraft
+    int maxLeafSize = 4;
+
+    std::vector<Node> nodes;
+    std::vector<int> primIndex;              // Leaf order -> fleet index
+    std::vector<float> primX, primY, primZ;  // Aircraft centers in leaf order
+
+    size_t primitiveCount() const { return primIndex.size(); }
+
+    // Binned SAH build from scratch
+    void build(const float* posX, const float* posY, const float* posZ, size_t count) {
+        nodes.clear();
+        primIndex.resize(count);
+        for (size_t i = 0; i < count; ++i) primIndex[i] = (int)i;
+        gather(posX, posY, posZ);
+        if (count == 0) return;
+
+        // Binary SAH tree first, then collapse pairs of levels into 4-wide nodes
+        std::vector<BuildNode> buildNodes;
+        buildNodes.reserve(2 * count / maxLeafSize + 1);
+        buildRecursive(buildNodes, 0, (int)count);
+
+        nodes.reserve(buildNodes.size() / 2 + 1);
+        treeDepth = 0;
+        collapse(buildNodes, 0, 1);
+        refitBounds();
+        buildCost = refitCost;
+    }
+
+    void build(const Fleet& fleet) {
+        build(fleet.posX.data(), fleet.posY.data(), fleet.posZ.data(), fleet.size());
+    }
+
+    // Keep the topology, pull in new positions and recompute all bounds
+    void refit(const float* posX, const float* posY, const float* posZ) {
+        gather(posX, posY, posZ);
+        refitBounds();
+    }
+
+    void refit(const Fleet& fleet) {
+        refit(fleet.posX.data(), fleet.posY.data(), fleet.posZ.data());
+    }
+
+    // Surface area heuristic cost of the current bounds, relative to the root
+    float sahCost() const {
+        if (nodes.empty()) return 0.0f;
+        float rootArea = 0.0f;
+        for (int k = 0; k < 4; ++k) rootArea = std::max(rootArea, slotArea(nodes[0], k));
+        if (rootArea <= 0.0f) return 0.0f;
+
+        float cost = 0.0f;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            const Node& node = nodes[i];
+            for (int k = 0; k < 4; ++k) {
+                if (node.child[k] < 0) continue;
+                float weight = node.count[k] > 0 ? (float)node.count[k] : 1.0f;
+                cost += slotArea(node, k) * weight;
+            }
+        }
+        return cost / rootArea;
+    }
+
+    // Cost right after the last build, to tell how much refits have degraded the tree
+    float builtCost() const { return buildCost; }
+
+    // sahCost() as of the last build or refit, summed while the bounds were recomputed
+    float currentCost() const { return refitCost; }
+
+    // Node levels, root included
+    int depth() const { return treeDepth; }
+
+    // Closest aircraft hit closer than maxT
+    bool intersectClosest(const Ray& ray, float maxT, int& hitIndex, float& hitT) const {
+        hitIndex = -1;
+        hitT = maxT;
+        traverse(ray, hitIndex, hitT, false);
+        return hitIndex >= 0;
+    }
+
+    // Line-of-sight test: does any aircraft block the ray before maxT?
+    bool intersectAny(const Ray& ray, float maxT) const {
+        int hitIndex = -1;
+        float hitT = maxT;
+        traverse(ray, hitIndex, hitT, true);
+        return hitIndex >= 0;
+    }
+
+private:
+    struct BuildNode {
+        glm::vec3 boundsMin, boundsMax;  // Centroid bounds
+        int left, right;                 // Build node indices, -1 for leaves
+        int first, count;                // Primitive range for leaves
+    };
+
+    static const int BIN_COUNT = 16;
+    static const int STACK_SIZE = 256;  // Traversal stack kept on the stack; deeper trees use the heap
+    float buildCost = 0.0f;
+    float refitCost = 0.0f;
+    int treeDepth = 0;
+
+    void gather(const float* posX, const float* posY, const float* posZ) {
+        const size_t n = primIndex.size();
+        primX.resize(n);
+        primY.resize(n);
+        primZ.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            int src = primIndex[i];
+            primX[i] = posX[src];
+            primY[i] = posY[src];
+            primZ[i] = posZ[src];
+        }
+    }
+
+    static float boxArea(const glm::vec3& extent) {
+        return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    static float slotArea(const Node& node, int k) {
+        if (node.child[k] < 0) return 0.0f;
+        return boxArea(glm::vec3(node.maxX[k] - node.minX[k],
+                                 node.maxY[k] - node.minY[k],
+                                 node.maxZ[k] - node.minZ[k]));
+    }
+
+    int buildRecursive(std::vector<BuildNode>& buildNodes, int first, int count) {
+        int nodeIndex = (int)buildNodes.size();
+        buildNodes.push_back(BuildNode());
+
+        glm::vec3 cmin(FLT_MAX), cmax(-FLT_MAX);
+        for (int i = first; i < first + count; ++i) {
+            glm::vec3 c(primX[i], primY[i], primZ[i]);
+            cmin = glm::min(cmin, c);
+            cmax = glm::max(cmax, c);
+        }
+        buildNodes[nodeIndex].boundsMin = cmin;
+        buildNodes[nodeIndex].boundsMax = cmax;
+        buildNodes[nodeIndex].left = -1;
+        buildNodes[nodeIndex].right = -1;
+        buildNodes[nodeIndex].first = first;
+        buildNodes[nodeIndex].count = count;
+
+        if (count <= maxLeafSize) return nodeIndex;
+
+        // Evaluate binned SAH splits on every axis
+        const glm::vec3 pad(radius);
+        int bestAxis = -1, bestSplit = -1;
+        float bestCost = boxArea(cmax - cmin + pad * 2.0f) * count;
+        for (int axis = 0; axis < 3; ++axis) {
+            float extent = cmax[axis] - cmin[axis];
+            if (extent <= 0.0f) continue;
+
+            int binCount[BIN_COUNT] = {0};
+            glm::vec3 binMin[BIN_COUNT], binMax[BIN_COUNT];
+            for (int b = 0; b < BIN_COUNT; ++b) {
+                binMin[b] = glm::vec3(FLT_MAX);
+                binMax[b] = glm::vec3(-FLT_MAX);
+            }
+            float scale = BIN_COUNT / extent;
+            for (int i = first; i < first + count; ++i) {
+                glm::vec3 c(primX[i], primY[i], primZ[i]);
+                int b = std::min(BIN_COUNT - 1, (int)((c[axis] - cmin[axis]) * scale));
+                binCount[b]++;
+                binMin[b] = glm::min(binMin[b], c);
+                binMax[b] = glm::max(binMax[b], c);
+            }
+
+            // Sweep from the right to get suffix areas, then from the left
+            float rightArea[BIN_COUNT];
+            int rightCount[BIN_COUNT];
+            glm::vec3 accMin(FLT_MAX), accMax(-FLT_MAX);
+            int acc = 0;
+            for (int b = BIN_COUNT - 1; b > 0; --b) {
+                accMin = glm::min(accMin, binMin[b]);
+                accMax = glm::max(accMax, binMax[b]);
+                acc += binCount[b];
+                rightCount[b] = acc;
+                rightArea[b] = acc > 0 ? boxArea(accMax - accMin + pad * 2.0f) : 0.0f;
+            }
+            accMin = glm::vec3(FLT_MAX);
+            accMax = glm::vec3(-FLT_MAX);
+            acc = 0;
+            for (int b = 0; b < BIN_COUNT - 1; ++b) {
+                accMin = glm::min(accMin, binMin[b]);
+                accMax = glm::max(accMax, binMax[b]);
+                acc += binCount[b];
+                if (acc == 0 || rightCount[b + 1] == 0) continue;
+                float cost = boxArea(accMax - accMin + pad * 2.0f) * acc + rightArea[b + 1] * rightCount[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = b;
+                }
+            }
+        }
+
+        int mid = first + count / 2;
+        if (bestAxis >= 0) {
+            float extent = cmax[bestAxis] - cmin[bestAxis];
+            float scale = BIN_COUNT / extent;
+            int i = first, j = first + count - 1;
+            while (i <= j) {
+                float c = bestAxis == 0 ? primX[i] : (bestAxis == 1 ? primY[i] : primZ[i]);
+                int b = std::min(BIN_COUNT - 1, (int)((c - cmin[bestAxis]) * scale));
+                if (b <= bestSplit) {
+                    ++i;
+                } else {
+                    std::swap(primIndex[i], primIndex[j]);
+                    std::swap(primX[i], primX[j]);
+                    std::swap(primY[i], primY[j]);
+                    std::swap(primZ[i], primZ[j]);
+                    --j;
+                }
+            }
+            mid = i;
+        }
+        // Degenerate input (all centers equal) or no useful split: cut in half
+        if (mid == first || mid == first + count) mid = first + count / 2;
+
+        int left = buildRecursive(buildNodes, first, mid - first);
+        int right = buildRecursive(buildNodes, mid, first + count - mid);
+        buildNodes[nodeIndex].left = left;
+        buildNodes[nodeIndex].right = right;
+        return nodeIndex;
+    }
+
+    // Emit a 4-wide node for a binary node by pulling grandchildren up one level
+    int collapse(const std::vector<BuildNode>& buildNodes, int buildIndex, int depth) {
+        treeDepth = std::max(treeDepth, depth);
+        int slots[4];
+        int slotCount = 0;
+        const BuildNode& root = buildNodes[buildIndex];
+        if (root.left < 0) {
+            slots[slotCount++] = buildIndex;
+        } else {
+            slots[slotCount++] = root.left;
+            slots[slotCount++] = root.right;
+        }
+
+        // Open the largest inner child until all four slots are used
+        while (slotCount < 4) {
+            int best = -1;
+            float bestArea = -1.0f;
+            for (int k = 0; k < slotCount; ++k) {
+                const BuildNode& b = buildNodes[slots[k]];
+                if (b.left < 0) continue;
+                float area = boxArea(b.boundsMax - b.boundsMin);
+                if (area > bestArea) {
+                    bestArea = area;
+                    best = k;
+                }
+            }
+            if (best < 0) break;
+            const BuildNode& opened = buildNodes[slots[best]];
+            slots[best] = opened.left;
+            slots[slotCount++] = opened.right;
+        }
+
+        int nodeIndex = (int)nodes.size();
+        nodes.push_back(Node());
+        for (int k = 0; k < 4; ++k) {
+            nodes[nodeIndex].child[k] = -1;
+            nodes[nodeIndex].count[k] = 0;
+        }
+        for (int k = 0; k < slotCount; ++k) {
+            const BuildNode& b = buildNodes[slots[k]];
+            if (b.left < 0) {
+                nodes[nodeIndex].child[k] = b.first;
+                nodes[nodeIndex].count[k] = b.count;
+            } else {
+                int childIndex = collapse(buildNodes, slots[k], depth + 1);
+                nodes[nodeIndex].child[k] = childIndex;
+            }
+        }
+        return nodeIndex;
+    }
+
+    // Children are stored after their parents, so one reverse sweep is
+    // bottom-up. The SAH cost is summed on the way, as sahCost() would.
+    void refitBounds() {
+        float cost = 0.0f;
+        for (size_t n = nodes.size(); n-- > 0;) {
+            Node& node = nodes[n];
+            for (int k = 0; k < 4; ++k) {
+                float x0 = FLT_MAX, y0 = FLT_MAX, z0 = FLT_MAX;
+                float x1 = -FLT_MAX, y1 = -FLT_MAX, z1 = -FLT_MAX;
+                if (node.count[k] > 0) {
+                    int first = node.child[k];
+                    int last = first + node.count[k];
+                    for (int i = first; i < last; ++i) {
+                        x0 = std::min(x0, primX[i]); x1 = std::max(x1, primX[i]);
+                        y0 = std::min(y0, primY[i]); y1 = std::max(y1, primY[i]);
+                        z0 = std::min(z0, primZ[i]); z1 = std::max(z1, primZ[i]);
+                    }
+                    x0 -= radius; y0 -= radius; z0 -= radius;
+                    x1 += radius; y1 += radius; z1 += radius;
+                } else if (node.child[k] >= 0) {
+                    // Empty grandchild slots hold inverted bounds, so no branches needed
+                    const Node& c = nodes[node.child[k]];
+                    x0 = std::min(std::min(c.minX[0], c.minX[1]), std::min(c.minX[2], c.minX[3]));
+                    y0 = std::min(std::min(c.minY[0], c.minY[1]), std::min(c.minY[2], c.minY[3]));
+                    z0 = std::min(std::min(c.minZ[0], c.minZ[1]), std::min(c.minZ[2], c.minZ[3]));
+                    x1 = std::max(std::max(c.maxX[0], c.maxX[1]), std::max(c.maxX[2], c.maxX[3]));
+                    y1 = std::max(std::max(c.maxY[0], c.maxY[1]), std::max(c.maxY[2], c.maxY[3]));
+                    z1 = std::max(std::max(c.maxZ[0], c.maxZ[1]), std::max(c.maxZ[2], c.maxZ[3]));
+                }
+                // Empty slots keep inverted bounds so the slab test always misses
+                node.minX[k] = x0; node.minY[k] = y0; node.minZ[k] = z0;
+                node.maxX[k] = x1; node.maxY[k] = y1; node.maxZ[k] = z1;
+                if (node.child[k] >= 0) cost += slotArea(node, k) * (node.count[k] > 0 ? (float)node.count[k] : 1.0f);
+            }
+        }
+
+        float rootArea = 0.0f;
+        if (!nodes.empty()) {
+            for (int k = 0; k < 4; ++k) rootArea = std::max(rootArea, slotArea(nodes[0], k));
+        }
+        refitCost = rootArea > 0.0f ? cost / rootArea : 0.0f;
+    }
+
+    void traverse(const Ray& ray, int& hitIndex, float& hitT, bool anyHit) const {
+        if (nodes.empty()) return;
+
+        const float ox = ray.origin.x, oy = ray.origin.y, oz = ray.origin.z;
+        const float dx = ray.direction.x, dy = ray.direction.y, dz = ray.direction.z;
+        const float invX = 1.0f / dx, invY = 1.0f / dy, invZ = 1.0f / dz;
+        const float r2 = radius * radius;
+
+        // A visit pops one node and pushes at most four, so the stack grows
+        // by at most three per level of the tree
+        int stackStorage[STACK_SIZE];
+        std::vector<int> heapStack;
+        int* stack = stackStorage;
+        if (3 * treeDepth + 1 > STACK_SIZE) {
+            heapStack.resize(3 * treeDepth + 1);
+            stack = heapStack.data();
+        }
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = nodes[stack[--stackSize]];
+
+            // Four slab tests at once
+            float tNear[4];
+            for (int k = 0; k < 4; ++k) {
+                float tx0 = (node.minX[k] - ox) * invX, tx1 = (node.maxX[k] - ox) * invX;
+                float ty0 = (node.minY[k] - oy) * invY, ty1 = (node.maxY[k] - oy) * invY;
+                float tz0 = (node.minZ[k] - oz) * invZ, tz1 = (node.maxZ[k] - oz) * invZ;
+                float t0 = std::max(std::max(std::min(tx0, tx1), std::min(ty0, ty1)), std::max(std::min(tz0, tz1), 0.0f));
+                float t1 = std::min(std::min(std::max(tx0, tx1), std::max(ty0, ty1)), std::min(std::max(tz0, tz1), hitT));
+                tNear[k] = t0 <= t1 ? t0 : FLT_MAX;
+            }
+
+            // Leaves are tested now; inner children are pushed far-to-near
+            int order[4];
+            int innerCount = 0;
+            for (int k = 0; k < 4; ++k) {
+                if (tNear[k] == FLT_MAX || node.child[k] < 0) continue;
+                if (node.count[k] > 0) {
+                    int first = node.child[k];
+                    int last = first + node.count[k];
+                    for (int i = first; i < last; ++i) {
+                        float px = primX[i] - ox, py = primY[i] - oy, pz = primZ[i] - oz;
+                        float tca = px * dx + py * dy + pz * dz;
+                        float d2 = px * px + py * py + pz * pz - tca * tca;
+                        if (tca > 0.0f && d2 < r2 && tca < hitT) {
+                            hitT = tca;
+                            hitIndex = primIndex[i];
+                            if (anyHit) return;
+                        }
+                    }
+                } else {
+                    int pos = innerCount++;
+                    while (pos > 0 && tNear[order[pos - 1]] < tNear[k]) {
+                        order[pos] = order[pos - 1];
+                        --pos;
+                    }
+                    order[pos] = k;
+                }
+            }
+            for (int i = 0; i < innerCount; ++i) {
+                if (tNear[order[i]] < hitT) stack[stackSize++] = node.child[order[i]];
+            }
+        }
+    }
+};
+
+// Keeps a Bvh4 in sync with a moving fleet: cheap refits every tick, with a
+// full SAH rebuild running on a background thread every few seconds (or sooner
+// when refits have inflated the tree) and swapped in when it completes.
+//
+// Each tick publishes a new tree through snapshot(), and a published tree
+// is never modified while another thread (picking) holds it. The refit goes
+// into the tree published the tick before, which has the same topology;
+// only if a reader still holds that one (or a rebuild was just swapped in)
+// is the current tree copied instead.
+class AircraftIndex {
+public:
+    float rebuildInterval = 2.0f;   // Seconds between background rebuilds
+    float maxCostGrowth = 1.5f;     // Rebuild early once SAH cost grows past this factor
+
+    AircraftIndex() : current(std::make_shared<Bvh4>()) {}
+
+    const Bvh4& bvh() const { return *current; }
+
+    // The tree as of the last update; stays valid and unchanged while held
+    std::shared_ptr<const Bvh4> snapshot() const { return current; }
+
+    // Takes effect with the next rebuild
+    void setRadius(float radius) {
+        this->radius = radius;
+    }
+
+    void update(const Fleet& fleet, float deltaTime) {
+        if (current->primitiveCount() != fleet.size()) {
+            // Aircraft added or removed: the topology is useless, rebuild now
+            std::shared_ptr<Bvh4> rebuilt = std::make_shared<Bvh4>();
+            rebuilt->radius = radius;
+            rebuilt->build(fleet);
+            current = rebuilt;
+            spare = nullptr;
+            timeSinceRebuild = 0.0f;
+            return;
+        }
+
+        // Swap in a finished background build; it was made from older
+        // positions. Otherwise refit the spare, unless a pick still holds it
+        // (use_count above 1; a reader dropping it concurrently only makes
+        // this copy needlessly).
+        std::shared_ptr<Bvh4> next;
+        bool rebuilt = false;
+        if (pending.valid() &&
+            pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            Bvh4 tree = pending.get();
+            if (tree.primitiveCount() == fleet.size()) {
+                next = std::make_shared<Bvh4>(std::move(tree));
+                rebuilt = true;
+            }
+        }
+        if (!next) next = spare && spare.use_count() == 1 ? spare : std::make_shared<Bvh4>(*current);
+        next->refit(fleet);
+
+        // A rebuilt tree's topology differs, so the old one cannot be refitted into
+        spare = rebuilt ? nullptr : current;
+        current = next;
+
+        timeSinceRebuild += deltaTime;
+        bool degraded = current->currentCost() > current->builtCost() * maxCostGrowth;
+        if (!pending.valid() && (timeSinceRebuild >= rebuildInterval || degraded)) {
+            timeSinceRebuild = 0.0f;
+            std::vector<float> x = fleet.posX, y = fleet.posY, z = fleet.posZ;
+            float radius = this->radius;
+            int maxLeafSize = current->maxLeafSize;
+            pending = std::async(std::launch::async, [x, y, z, radius, maxLeafSize]() {
+                Bvh4 rebuilt;
+                rebuilt.radius = radius;
+                rebuilt.maxLeafSize = maxLeafSize;
+                rebuilt.build(x.data(), y.data(), z.data(), x.size());
+                return rebuilt;
+            });
+        }
+    }
+
+private:
+    std::shared_ptr<Bvh4> current;  // Published; not modified again while current
+    std::shared_ptr<Bvh4> spare;    // Published the tick before, with current's topology
+    std::future<Bvh4> pending;
+    float timeSinceRebuild = 0.0f;
+    float radius = Bvh4().radius;
+};
+
+#endif // BVH_H
@@ -5,6 +5,131 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+
+#include "flight_model.h"
+#include "geodesy.h"
+
+// Where the camera is and which way it looks, for camera-relative rendering.
+// The eye stays in double; everything sent to the GPU is an offset from it,
+// so float precision is spent on what is near the camera instead of on the
+// distance to the planet center.
+struct RenderView {
+    glm::dvec3 eye = glm::dvec3(0.0);     // Globe frame, meters
+    glm::mat4 rotation = glm::mat4(1.0f); // View matrix without the translation
+    double planetRadius = 1.0;            // Meters per globe unit
+
+    double altitude() const { return glm::length(eye) - planetRadius; }
+
+    // Unit view direction in the globe frame
+    glm::vec3 forward() const {
+        return -glm::vec3(rotation[0][2], rotation[1][2], rotation[2][2]);
+    }
+
+    // Near plane close enough for the cockpit, far plane just past the horizon
+    // (plus room for traffic above it)
+    void clipPlanes(double& nearPlane, double& farPlane) const {
+        double distance = glm::length(eye);
+        double horizon = sqrt(std::max(distance * distance - planetRadius * planetRadius, 0.0));
+        nearPlane = std::max(1.0, altitude() * 0.01);
+        farPlane = horizon + planetRadius * 0.5;
+    }
+
+    glm::mat4 projection(float fovRadians, float aspect) const {
+        double nearPlane, farPlane;
+        clipPlanes(nearPlane, farPlane);
+        return glm::perspective(fovRadians, aspect, (float)nearPlane, (float)farPlane);
+    }
+
+    // For reversed-Z with [0, 1] clip depth (see DepthBuffer): no far plane,
+    // depth = nearPlane / distance, so the near plane can sit right at the eye
+    glm::mat4 reversedProjection(float fovRadians, float aspect, float nearPlane = 0.1f) const {
+        float f = 1.0f / tanf(fovRadians * 0.5f);
+        glm::mat4 m(0.0f);
+        m[0][0] = f / aspect;
+        m[1][1] = f;
+        m[2][3] = -1.0f;
+        m[3][2] = nearPlane;
+        return m;
+    }
+
+    // The same camera in globe units, for CPU-side work like picking
+    glm::mat4 globeViewMatrix() const {
+        return rotation * glm::translate(glm::mat4(1.0f), -glm::vec3(eye / planetRadius));
+    }
+
+    glm::mat4 globeProjection(float fovRadians, float aspect) const {
+        double nearPlane, farPlane;
+        clipPlanes(nearPlane, farPlane);
+        return glm::perspective(fovRadians, aspect, (float)(nearPlane / planetRadius),
+                                (float)(farPlane / planetRadius));
+    }
+
+    // Offset of a globe-frame point (meters) from the eye, for the GPU
+    glm::vec3 relative(const glm::dvec3& position) const {
+        return relativeToEye(position, eye);
+    }
+
+    // Same camera exactly, so the same picture
+    bool sameAs(const RenderView& other) const {
+        return eye == other.eye && rotation == other.rotation && planetRadius == other.planetRadius;
+    }
+};
+
+// Keeps the last projection and rebuilds it only when the field of view,
+// aspect, depth mode or clip planes change. The reversed-Z projection does
+// not depend on the camera, so it is only rebuilt on a resize or FOV change;
+// the standard one follows the near and far planes as the altitude changes.
+class ProjectionCache {
+public:
+    long long hits = 0, rebuilds = 0;
+
+    const glm::mat4& get(const RenderView& view, float fovRadians, float aspect, bool reversedZ) {
+        float nearPlane = 0.0f, farPlane = 0.0f;
+        if (!reversedZ) {
+            double n, f;
+            view.clipPlanes(n, f);
+            nearPlane = (float)n;
+            farPlane = (float)f;
+        }
+        if (valid && fovRadians == fov && aspect == cachedAspect && reversedZ == reversed &&
+            nearPlane == cachedNear && farPlane == cachedFar) {
+            ++hits;
+            return matrix;
+        }
+
+        matrix = reversedZ ? view.reversedProjection(fovRadians, aspect)
+                           : glm::perspective(fovRadians, aspect, nearPlane, farPlane);
+        valid = true;
+        fov = fovRadians;
+        cachedAspect = aspect;
+        reversed = reversedZ;
+        cachedNear = nearPlane;
+        cachedFar = farPlane;
+        ++rebuilds;
+        return matrix;
+    }
+
+private:
+    glm::mat4 matrix = glm::mat4(1.0f);
+    bool valid = false, reversed = false;
+    float fov = 0.0f, cachedAspect = 0.0f, cachedNear = 0.0f, cachedFar = 0.0f;
+};
+
+// Left, right, bottom and top planes of a view-projection (xyz normal
+// pointing inward, w offset, normalized). The near and far planes are left
+// out so this also works for the infinite reversed-Z projection.
+inline void frustumSidePlanes(const glm::mat4& viewProjection, glm::vec4 planes[4]) {
+    glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+    glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+    glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+    planes[0] = row3 + row0;
+    planes[1] = row3 - row0;
+    planes[2] = row3 + row1;
+    planes[3] = row3 - row1;
+    for (int i = 0; i < 4; ++i) planes[i] /= glm::length(glm::vec3(planes[i]));
+}
 
 class Camera {
 public:
@@ -28,55 +153,69 @@ public:
     float globeRotationX = 0.0f;
     float globeRotationY = 0.0f;
 
+    // Control rates and limits
+    double speedStep = 1.0;           // Autopilot target change per frame held, m/s
+    double altitudeStep = 50.0;       // Meters
+    double minSpeed = 150.0, maxSpeed = 300.0;            // m/s
+    double minAltitude = 1000.0, maxAltitude = 40000.0;   // Meters
+    float rotateSpeed = 0.02f;        // Globe rotation per frame held, radians
+    float mouseSensitivity = 0.01f;   // Radians per pixel dragged
+    float zoomStep = 0.1f;            // Globe radii per scroll step
+    float minDistance = 1.5f, maxDistance = 10.0f;        // Globe radii
+
+    // Optional 6DOF aircraft that drives plane view instead of the kinematic path
+    FlightModel* flightModel = nullptr;
+    size_t followAircraft = 0;
+
+    double planetRadius = EARTH_MEAN_RADIUS;  // Meters per globe unit when rendering
+
     Camera(float windowWidth, float windowHeight) 
         : lastX(windowWidth / 2.0f), lastY(windowHeight / 2.0f) {}
 
-    glm::mat4 getViewMatrix(float deltaTime) {
-        if (!manualControl) {
+    // Camera pose for this frame. Advances the kinematic plane path.
+    RenderView getRenderView(float deltaTime) {
+        RenderView view;
+        glm::vec3 forward, up;
+        glm::dvec3 eye;
+
+        if (!manualControl && flightModel) {
+            // Ride along in the simulated aircraft, banking with it. Its
+            // position is already in double-precision meters.
+            eye = flightModel->position(followAircraft) * (planetRadius / flightModel->planetRadius);
+            forward = flightModel->getForward(followAircraft);
+            up = flightModel->getUp(followAircraft);
+        } else if (!manualControl) {
             // Update plane position
             planeAngle += planeSpeed * deltaTime;
-            
-            // Create a figure-8 or sinusoidal path that varies in latitude
-            float pathVariation = sin(planeAngle * 2.0f) * 0.4f;
-            
-            // Calculate plane position with varying latitude
-            float planeX = planeAltitude * cos(planeAngle);
-            float planeY = pathVariation;
-            float planeZ = planeAltitude * sin(planeAngle);
-            
-            // Normalize and scale to maintain altitude
-            glm::vec3 planePos = glm::vec3(planeX, planeY, planeZ);
-            planePos = glm::normalize(planePos) * planeAltitude;
-            
-            // Calculate forward direction
-            float nextAngle = planeAngle + 0.01f;
-            float nextPathVariation = sin(nextAngle * 2.0f) * 0.4f;
-            glm::vec3 nextPos = glm::normalize(glm::vec3(
-                planeAltitude * cos(nextAngle),
-                nextPathVariation,
-                planeAltitude * sin(nextAngle)
-            )) * planeAltitude;
-            
-            glm::vec3 forward = glm::normalize(nextPos - planePos);
-            glm::vec3 up = glm::normalize(planePos);
+
+            glm::vec3 planePos = kinematicPlanePosition(planeAngle);
+            glm::vec3 nextPos = kinematicPlanePosition(planeAngle + 0.01f);
+
+            forward = glm::normalize(nextPos - planePos);
+            up = glm::normalize(planePos);
             glm::vec3 right = glm::cross(forward, up);
             up = glm::cross(right, forward);
-            
-            glm::vec3 lookTarget = planePos + forward + up * (-planeTilt);
-            
-            return glm::lookAt(planePos, lookTarget, up);
+            eye = glm::dvec3(planePos) * planetRadius;
         } else {
             // Manual camera control
-            float camX = sin(cameraAngleX) * cos(cameraAngleY) * cameraDistance;
-            float camY = sin(cameraAngleY) * cameraDistance;
-            float camZ = cos(cameraAngleX) * cos(cameraAngleY) * cameraDistance;
-            
-            return glm::lookAt(
-                glm::vec3(camX, camY, camZ),
-                glm::vec3(0.0f, 0.0f, 0.0f),
-                glm::vec3(0.0f, 1.0f, 0.0f)
-            );
+            glm::dvec3 direction(sin(cameraAngleX) * cos(cameraAngleY),
+                                 sin(cameraAngleY),
+                                 cos(cameraAngleX) * cos(cameraAngleY));
+            eye = direction * (double)cameraDistance * planetRadius;
+            forward = -glm::vec3(direction);
+            up = glm::vec3(0.0f, 1.0f, 0.0f);
         }
+
+        glm::vec3 lookDirection = manualControl ? forward : forward + up * (-planeTilt);
+        view.rotation = glm::lookAt(glm::vec3(0.0f), lookDirection, up);
+
+        // Fold the globe rotation into the view so everything else can be
+        // drawn straight from globe-frame positions
+        glm::mat4 model = getModelMatrix();
+        view.rotation = view.rotation * model;
+        view.eye = glm::dmat3(glm::transpose(glm::mat3(model))) * eye;
+        view.planetRadius = planetRadius;
+        return view;
     }
 
     glm::mat4 getModelMatrix() {
@@ -88,23 +227,6 @@ public:
         return model;
     }
 
-    glm::vec3 getViewPosition() {
-        if (!manualControl) {
-            float pathVariation = sin(planeAngle * 2.0f) * 0.4f;
-            return glm::normalize(glm::vec3(
-                planeAltitude * cos(planeAngle),
-                pathVariation,
-                planeAltitude * sin(planeAngle)
-            )) * planeAltitude;
-        } else {
-            return glm::vec3(
-                sin(cameraAngleX) * cos(cameraAngleY) * cameraDistance,
-                sin(cameraAngleY) * cameraDistance,
-                cos(cameraAngleX) * cos(cameraAngleY) * cameraDistance
-            );
-        }
-    }
-
     void processKeyboard(GLFWwindow* window) {
         // Toggle manual camera control with SPACE
         static bool spacePressed = false;
@@ -123,7 +245,25 @@ public:
         }
         
         // Controls based on mode
-        if (!manualControl) {
+        if (!manualControl && flightModel) {
+            // Simulated aircraft: steer the autopilot targets
+            double& targetSpeed = flightModel->targetSpeed[followAircraft];
+            double& targetAltitude = flightModel->targetAltitude[followAircraft];
+            if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+                targetSpeed += speedStep;
+            if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+                targetSpeed -= speedStep;
+            if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+                targetAltitude -= altitudeStep;
+            if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+                targetAltitude += altitudeStep;
+
+            // Clamp values
+            if (targetSpeed < minSpeed) targetSpeed = minSpeed;
+            if (targetSpeed > maxSpeed) targetSpeed = maxSpeed;
+            if (targetAltitude < minAltitude) targetAltitude = minAltitude;
+            if (targetAltitude > maxAltitude) targetAltitude = maxAltitude;
+        } else if (!manualControl) {
             // Plane view controls
             if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
                 planeSpeed += 0.01f;
@@ -141,15 +281,14 @@ public:
             if (planeAltitude > 2.0f) planeAltitude = 2.0f;
         } else {
             // Manual view - rotate globe with arrow keys
-            float rotSpeed = 0.02f;
             if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
-                globeRotationY -= rotSpeed;
+                globeRotationY -= rotateSpeed;
             if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
-                globeRotationY += rotSpeed;
+                globeRotationY += rotateSpeed;
             if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
-                globeRotationX -= rotSpeed;
+                globeRotationX -= rotateSpeed;
             if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
-                globeRotationX += rotSpeed;
+                globeRotationX += rotateSpeed;
         }
     }
 
@@ -167,9 +306,8 @@ public:
         lastX = xpos;
         lastY = ypos;
 
-        float sensitivity = 0.01f;
-        cameraAngleX += xoffset * sensitivity;
-        cameraAngleY += yoffset * sensitivity;
+        cameraAngleX += xoffset * mouseSensitivity;
+        cameraAngleY += yoffset * mouseSensitivity;
 
         if (cameraAngleY > 1.5f) cameraAngleY = 1.5f;
         if (cameraAngleY < -1.5f) cameraAngleY = -1.5f;
@@ -187,9 +325,20 @@ public:
     }
 
     void processScroll(double yoffset) {
-        cameraDistance -= (float)yoffset * 0.1f;
-        if (cameraDistance < 1.5f) cameraDistance = 1.5f;
-        if (cameraDistance > 10.0f) cameraDistance = 10.0f;
+        cameraDistance -= (float)yoffset * zoomStep;
+        if (cameraDistance < minDistance) cameraDistance = minDistance;
+        if (cameraDistance > maxDistance) cameraDistance = maxDistance;
+    }
+
+private:
+    // Figure-8 style path that varies in latitude, in globe units
+    glm::vec3 kinematicPlanePosition(float angle) const {
+        float pathVariation = sin(angle * 2.0f) * 0.4f;
+        return glm::normalize(glm::vec3(
+            planeAltitude * cos(angle),
+            pathVariation,
+            planeAltitude * sin(angle)
+        )) * planeAltitude;
     }
 };
 
@@ -0,0 +1,164 @@
+#ifndef CONFIG_FILE_H
+#define CONFIG_FILE_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <cerrno>
+#include <cmath>
+#include <climits>
+
+#include <sys/stat.h>
+
+// A key = value text file, watched for changes.
+//
+//     # Comment
+//     [render]
+//     globe_sectors = 96
+//
+// A [section] header prefixes the keys below it, so that line is read as
+// "render.globe_sectors". Lookups take a fallback, which is what a missing
+// or malformed value gives, so a config file only needs the lines it
+// changes.
+class ConfigFile {
+public:
+    double pollSeconds = 1.0;  // How often reloadIfChanged looks at the file
+
+    // Read path; false if it cannot be opened, which leaves no values set
+    bool load(const std::string& path) {
+        filePath = path;
+        values.clear();
+        used.clear();
+        lastPoll = Clock::now();
+        if (!modificationTime(path, modified)) return false;
+
+        std::ifstream file(path);
+        if (!file) return false;
+        std::string line, section;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            line = trim(line.substr(0, line.find('#')));
+            if (line.empty()) continue;
+
+            if (line[0] == '[') {
+                size_t close = line.find(']');
+                if (close == std::string::npos) {
+                    std::cerr << path << ":" << lineNumber << ": unterminated section" << std::endl;
+                    continue;
+                }
+                section = trim(line.substr(1, close - 1));
+                continue;
+            }
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                std::cerr << path << ":" << lineNumber << ": expected key = value" << std::endl;
+                continue;
+            }
+            std::string key = trim(line.substr(0, equals));
+            if (!section.empty()) key = section + "." + key;
+            values[key] = trim(line.substr(equals + 1));
+        }
+        return true;
+    }
+
+    // Reread the file if it was modified since it was loaded. Checks at most
+    // every pollSeconds, so this can be called every frame.
+    bool reloadIfChanged() {
+        if (filePath.empty()) return false;
+        if (std::chrono::duration<double>(Clock::now() - lastPoll).count() < pollSeconds) return false;
+        lastPoll = Clock::now();
+
+        Timestamp now;
+        if (!modificationTime(filePath, now) || now == modified) return false;
+        return load(filePath);
+    }
+
+    const std::string& path() const { return filePath; }
+    bool has(const std::string& key) const { return values.count(key) != 0; }
+
+    double number(const std::string& key, double fallback) const {
+        const std::string* value = lookup(key);
+        if (!value) return fallback;
+        char* end = nullptr;
+        errno = 0;
+        double result = strtod(value->c_str(), &end);
+        // strtod also reads "nan" and "inf", which no setting can use
+        if (end == value->c_str() || *end != '\0' || errno != 0 || !std::isfinite(result)) {
+            std::cerr << filePath << ": " << key << " is not a number: " << *value << std::endl;
+            return fallback;
+        }
+        return result;
+    }
+
+    int integer(const std::string& key, int fallback) const {
+        double result = number(key, fallback);
+        return (int)std::min(std::max(result, (double)INT_MIN), (double)INT_MAX);
+    }
+
+    bool flag(const std::string& key, bool fallback) const {
+        const std::string* value = lookup(key);
+        if (!value) return fallback;
+        if (*value == "true" || *value == "on" || *value == "1") return true;
+        if (*value == "false" || *value == "off" || *value == "0") return false;
+        std::cerr << filePath << ": " << key << " is not true or false: " << *value << std::endl;
+        return fallback;
+    }
+
+    std::string text(const std::string& key, const std::string& fallback) const {
+        const std::string* value = lookup(key);
+        return value ? *value : fallback;
+    }
+
+    // Report keys nothing has looked up since the last load; usually typos
+    void warnUnused() const {
+        for (const auto& entry : values) {
+            if (!used.count(entry.first)) {
+                std::cerr << filePath << ": unknown setting " << entry.first << std::endl;
+            }
+        }
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Timestamp {
+        long long seconds = 0, nanoseconds = 0;
+        bool operator==(const Timestamp& other) const {
+            return seconds == other.seconds && nanoseconds == other.nanoseconds;
+        }
+    };
+
+    std::string filePath;
+    std::map<std::string, std::string> values;
+    mutable std::set<std::string> used;
+    Timestamp modified;
+    Clock::time_point lastPoll;
+
+    const std::string* lookup(const std::string& key) const {
+        used.insert(key);
+        std::map<std::string, std::string>::const_iterator it = values.find(key);
+        return it == values.end() ? nullptr : &it->second;
+    }
+
+    static bool modificationTime(const std::string& path, Timestamp& time) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) return false;
+        time.seconds = (long long)info.st_mtim.tv_sec;
+        time.nanoseconds = (long long)info.st_mtim.tv_nsec;
+        return true;
+    }
+
+    static std::string trim(const std::string& s) {
+        size_t first = s.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return std::string();
+        size_t last = s.find_last_not_of(" \t\r");
+        return s.substr(first, last - first + 1);
+    }
+};
+
+#endif // CONFIG_FILE_H
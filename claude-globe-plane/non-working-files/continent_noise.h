@@ -0,0 +1,56 @@
+#ifndef CONTINENT_NOISE_H
+#define CONTINENT_NOISE_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+// CPU port of the continent noise in the globe fragment shader. Everything is
+// evaluated in single precision in the same order as the GLSL so the answers
+// match the rendered coastlines, up to how precisely the GPU evaluates sin()
+// for the large arguments in the hash. Keep the two in sync.
+
+inline float noiseFract(float x) {
+    return x - floorf(x);
+}
+
+inline float noiseHash(float px, float py) {
+    return noiseFract(sinf(px * 127.1f + py * 311.7f) * 43758.5453f);
+}
+
+inline float valueNoise(float px, float py) {
+    float ix = floorf(px), iy = floorf(py);
+    float fx = px - ix, fy = py - iy;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+
+    float a = noiseHash(ix, iy);
+    float b = noiseHash(ix + 1.0f, iy);
+    float c = noiseHash(ix, iy + 1.0f);
+    float d = noiseHash(ix + 1.0f, iy + 1.0f);
+
+    return a + (b - a) * fx + (c - a) * fy * (1.0f - fx) + (d - b) * fx * fy;
+}
+
+// Octave sum before the smoothstep; land is where this exceeds 0.4
+inline float continentNoiseRaw(float latRadians, float lonRadians) {
+    float u = lonRadians * 2.0f, v = latRadians * 3.0f;
+    float n = 0.0f;
+    n += valueNoise(u * 3.0f, v * 3.0f) * 0.5f;
+    n += valueNoise(u * 6.0f, v * 6.0f) * 0.25f;
+    n += valueNoise(u * 12.0f, v * 12.0f) * 0.125f;
+    return n;
+}
+
+// Same value as continentNoise(pos) in the shader, for a unit vector
+inline float continentNoise(const glm::vec3& pos) {
+    float n = continentNoiseRaw(asinf(pos.y), atan2f(pos.z, pos.x));
+    float t = glm::clamp((n - 0.35f) / (0.45f - 0.35f), 0.0f, 1.0f);
+    return t * t * (3.0f - 2.0f * t);
+}
+
+// The shader's landMask > 0.5; smoothstep is symmetric, so that is raw > 0.4
+inline bool continentIsLand(float latRadians, float lonRadians) {
+    return continentNoiseRaw(latRadians, lonRadians) > 0.4f;
+}
+
+#endif // CONTINENT_NOISE_H
@@ -0,0 +1,127 @@
+#ifndef DEPTH_BUFFER_H
+#define DEPTH_BUFFER_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <iostream>
+#include <cstring>
+
+#include "render_targets.h"
+
+// glClipControl is GL 4.5 / ARB_clip_control, newer than the 3.3 glad loader
+#ifndef GL_ZERO_TO_ONE
+#define GL_ZERO_TO_ONE 0x935F
+#endif
+#ifndef GL_NEGATIVE_ONE_TO_ONE
+#define GL_NEGATIVE_ONE_TO_ONE 0x935E
+#endif
+typedef void (APIENTRYP PFNGLCLIPCONTROLPROC_)(GLenum origin, GLenum depth);
+
+// Owns the depth setup every pass renders with.
+//
+// Standard mode draws straight into the window's 24-bit depth buffer.
+// Reversed-Z mode draws into an offscreen framebuffer with a 32-bit float
+// depth attachment, maps clip space depth to [0, 1] with glClipControl and
+// uses a projection with an infinite far plane (RenderView::reversedProjection)
+// that sends the near plane to 1 and infinity to 0. Float precision is
+// densest near 0, which cancels the 1/z falloff, so depth resolution stays
+// roughly proportional to distance all the way out and near and far
+// geometry can share one pass. The offscreen target comes from the view's
+// RenderTargetManager, so it follows resizes with the rest of its targets;
+// the color is blitted to the window in endFrame.
+//
+// A color format other than RGBA8 (HDR) also draws offscreen, in either
+// depth mode; then the color is left in target() for the post passes.
+class DepthBuffer {
+public:
+    bool reversedZ = false;  // Active mode; false if reversed-Z was not available
+
+    // Call once after the GL context is current
+    void init(bool wantReversedZ, RenderTargetManager& targets, GLenum colorFormat = GL_RGBA8) {
+        reversedZ = wantReversedZ && enableClipControl();
+        sceneTarget = nullptr;
+        if (reversedZ || colorFormat != GL_RGBA8) {
+            sceneTarget = targets.add(colorFormat, reversedZ ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24);
+        }
+        if (reversedZ) std::cout << "Reversed-Z depth enabled (float depth, infinite far plane)" << std::endl;
+    }
+
+    // Bind the target for this frame's passes and set the depth test to match.
+    // viewport places the view in the window, so several views can share it.
+    void beginFrame(const Viewport& viewport) {
+        presentTo = viewport;
+        if (!sceneTarget) {
+            // Drawing straight into the window: keep the clear inside the view
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+            glScissor(viewport.x, viewport.y, viewport.width, viewport.height);
+            glEnable(GL_SCISSOR_TEST);
+            glDepthFunc(GL_LESS);
+            glClearDepth(1.0);
+            return;
+        }
+
+        sceneTarget->bind();
+        glDepthFunc(reversedZ ? GL_GREATER : GL_LESS);
+        glClearDepth(reversedZ ? 0.0 : 1.0);
+    }
+
+    // Pixel size the passes draw at: the offscreen target's, which lags the
+    // view while a resize settles, or the view's own
+    int drawWidth(const Viewport& viewport) const { return sceneTarget ? sceneTarget->width() : viewport.width; }
+    int drawHeight(const Viewport& viewport) const { return sceneTarget ? sceneTarget->height() : viewport.height; }
+
+    // The offscreen target the passes draw into, null when drawing to the window
+    const RenderTarget* target() const { return sceneTarget; }
+
+    // Present what the passes drew
+    void endFrame() {
+        if (!sceneTarget) {
+            glDisable(GL_SCISSOR_TEST);
+            return;
+        }
+        sceneTarget->blitTo(presentTo);
+    }
+
+    // The target itself belongs to the RenderTargetManager
+    void cleanup() {
+        sceneTarget = nullptr;
+        if (reversedZ && clipControl) clipControl(GL_LOWER_LEFT, GL_NEGATIVE_ONE_TO_ONE);
+    }
+
+private:
+    PFNGLCLIPCONTROLPROC_ clipControl = nullptr;
+    RenderTarget* sceneTarget = nullptr;  // Offscreen color and depth, if not the window's
+    Viewport presentTo;                   // Where endFrame puts the view in the window
+
+    bool enableClipControl() {
+        if (!hasClipControl()) {
+            std::cerr << "glClipControl not available, using standard depth" << std::endl;
+            return false;
+        }
+        clipControl = (PFNGLCLIPCONTROLPROC_)glfwGetProcAddress("glClipControl");
+        if (!clipControl) {
+            std::cerr << "glClipControl not available, using standard depth" << std::endl;
+            return false;
+        }
+        clipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+        return true;
+    }
+
+    static bool hasClipControl() {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        if (major > 4 || (major == 4 && minor >= 5)) return true;
+
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (name && strcmp(name, "GL_ARB_clip_control") == 0) return true;
+        }
+        return false;
+    }
+};
+
+#endif // DEPTH_BUFFER_H
@@ -0,0 +1,166 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+
+#include "wind_field.h"
+#include "geodesy.h"
+
+// Simulated air traffic around the globe. Aircraft are stored as a
+// structure of arrays so per-aircraft loops stay tight and vectorizable.
+// Positions are in globe space, where the planet surface is the unit sphere.
+class Fleet {
+public:
+    std::vector<float> posX, posY, posZ;     // Position in globe space
+    std::vector<float> axisX, axisY, axisZ;  // Great-circle rotation axis (unit, perpendicular to position)
+    std::vector<float> altitude;             // Distance from globe center
+    std::vector<float> angularSpeed;         // Radians per second along the great circle (airspeed)
+    std::vector<float> groundSpeed;          // m/s over the ground, wind included
+
+    float metersPerUnit = (float)EARTH_MEAN_RADIUS;  // Same planet scale as FlightModel::planetRadius
+
+    size_t size() const { return posX.size(); }
+
+    void resize(size_t count) {
+        posX.resize(count); posY.resize(count); posZ.resize(count);
+        axisX.resize(count); axisY.resize(count); axisZ.resize(count);
+        altitude.resize(count);
+        angularSpeed.resize(count);
+        groundSpeed.resize(count);
+    }
+
+    // Scatter aircraft uniformly over the globe, each flying its own great circle
+    void spawnRandom(size_t count, unsigned int seed = 1234) {
+        resize(count);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> angle(0.0f, 2.0f * (float)M_PI);
+        std::uniform_real_distribution<float> alt(1.01f, 1.04f);
+        std::uniform_real_distribution<float> speed(200.0f, 260.0f);  // True airspeed, m/s
+
+        for (size_t i = 0; i < count; ++i) {
+            // Uniform point on the sphere
+            float y = unit(rng);
+            float a = angle(rng);
+            float r = sqrtf(1.0f - y * y);
+            glm::vec3 dir(r * cosf(a), y, r * sinf(a));
+
+            // Random heading: any unit vector perpendicular to the position
+            glm::vec3 axis;
+            do {
+                axis = glm::cross(dir, glm::vec3(unit(rng), unit(rng), unit(rng)));
+            } while (glm::dot(axis, axis) < 1e-4f);
+            axis = glm::normalize(axis);
+
+            altitude[i] = alt(rng);
+            posX[i] = dir.x * altitude[i];
+            posY[i] = dir.y * altitude[i];
+            posZ[i] = dir.z * altitude[i];
+            axisX[i] = axis.x;
+            axisY[i] = axis.y;
+            axisZ[i] = axis.z;
+            groundSpeed[i] = speed(rng);
+            angularSpeed[i] = groundSpeed[i] / (altitude[i] * metersPerUnit);
+        }
+    }
+
+    // Advance every aircraft along its great circle. With a wind field the
+    // aircraft also drift with the air mass, so groundspeed and track follow
+    // the winds aloft while the nose stays on the great circle.
+    void propagate(float deltaTime, const WindField* wind = nullptr) {
+        const size_t n = size();
+        for (size_t i = 0; i < n; ++i) {
+            float a = angularSpeed[i] * deltaTime;
+            float c = cosf(a);
+            float s = sinf(a);
+
+            // Rodrigues rotation about the axis (axis is perpendicular to position)
+            float cx = axisY[i] * posZ[i] - axisZ[i] * posY[i];
+            float cy = axisZ[i] * posX[i] - axisX[i] * posZ[i];
+            float cz = axisX[i] * posY[i] - axisY[i] * posX[i];
+            float x = posX[i] * c + cx * s;
+            float y = posY[i] * c + cy * s;
+            float z = posZ[i] * c + cz * s;
+
+            // Re-project onto the altitude shell to stop float drift
+            float scale = altitude[i] / sqrtf(x * x + y * y + z * z);
+            posX[i] = x * scale;
+            posY[i] = y * scale;
+            posZ[i] = z * scale;
+        }
+
+        if (wind && !wind->empty()) applyWind(*wind, deltaTime);
+    }
+
+    glm::vec3 getPosition(size_t i) const {
+        return glm::vec3(posX[i], posY[i], posZ[i]);
+    }
+
+    // Direction of travel (tangent to the great circle)
+    glm::vec3 getForward(size_t i) const {
+        glm::vec3 axis(axisX[i], axisY[i], axisZ[i]);
+        return glm::normalize(glm::cross(axis, getPosition(i)));
+    }
+
+    // Airline-style callsign such as "DLH417", fixed per aircraft index.
+    // out needs room for 8 characters including the terminator.
+    static void callsign(size_t i, char* out) {
+        static const char* const airlines[16] = {
+            "AAL", "BAW", "DLH", "AFR", "UAL", "KLM", "QFA", "SIA",
+            "JAL", "ANA", "UAE", "THY", "ACA", "CPA", "SWR", "IBE"
+        };
+        unsigned int hash = (unsigned int)i * 2654435761u;
+        snprintf(out, 8, "%s%u", airlines[hash >> 28], 1 + (hash >> 4) % 9999);
+    }
+
+private:
+    std::vector<float> sampleLat, sampleLon, sampleAlt, windU, windV;
+
+    void applyWind(const WindField& wind, float deltaTime) {
+        const size_t n = size();
+        sampleLat.resize(n); sampleLon.resize(n); sampleAlt.resize(n);
+        windU.resize(n); windV.resize(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            float r = altitude[i];
+            sampleLat[i] = glm::degrees(asinf(glm::clamp(posY[i] / r, -1.0f, 1.0f)));
+            sampleLon[i] = glm::degrees(atan2f(posZ[i], posX[i]));
+            sampleAlt[i] = (r - 1.0f) * metersPerUnit;
+        }
+        wind.sampleBatch(sampleLat.data(), sampleLon.data(), sampleAlt.data(),
+                         windU.data(), windV.data(), n);
+
+        const float unitsPerMeter = 1.0f / metersPerUnit;
+        for (size_t i = 0; i < n; ++i) {
+            glm::vec3 p = getPosition(i);
+            glm::vec3 east, north;
+            WindField::localBasis(p, east, north);
+            glm::vec3 windVelocity = east * windU[i] + north * windV[i];
+
+            // Groundspeed is the vector sum of airspeed along the heading and the wind
+            glm::vec3 air = getForward(i) * (angularSpeed[i] * altitude[i] * metersPerUnit);
+            groundSpeed[i] = glm::length(air + windVelocity);
+
+            // Drift, back onto the altitude shell
+            p = glm::normalize(p + windVelocity * (deltaTime * unitsPerMeter));
+            posX[i] = p.x * altitude[i];
+            posY[i] = p.y * altitude[i];
+            posZ[i] = p.z * altitude[i];
+
+            // Keep the great-circle axis perpendicular to the new position
+            glm::vec3 axis(axisX[i], axisY[i], axisZ[i]);
+            axis = glm::normalize(axis - p * glm::dot(axis, p));
+            axisX[i] = axis.x;
+            axisY[i] = axis.y;
+            axisZ[i] = axis.z;
+        }
+    }
+};
+
+#endif // FLEET_H
@@ -0,0 +1,409 @@
+#ifndef FLIGHT_MODEL_H
+#define FLIGHT_MODEL_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include "wind_field.h"
+#include "geodesy.h"
+
+// Mass, geometry and stability derivatives of a generic twin-jet airliner.
+// Body axes follow the aero convention: x forward, y right wing, z down.
+struct AircraftParams {
+    double mass = 60000.0;        // kg
+    double wingArea = 125.0;      // m^2
+    double wingSpan = 34.0;       // m
+    double chord = 4.0;           // Mean aerodynamic chord, m
+    double Ixx = 1.3e6, Iyy = 3.0e6, Izz = 4.2e6;  // kg m^2
+    double maxThrust = 240000.0;  // N
+
+    // Lift, drag and side force
+    double CL0 = 0.2, CLalpha = 5.5, CLde = 0.3;
+    double CD0 = 0.02, CDk = 0.045;
+    double CYbeta = -0.8;
+
+    // Roll, pitch and yaw moments
+    double Clbeta = -0.1, Clp = -0.45, Clr = 0.1, Clda = 0.15;
+    double Cm0 = 0.02, Cmalpha = -1.0, Cmq = -15.0, Cmde = -1.2;
+    double Cnbeta = 0.12, Cnr = -0.2, Cndr = -0.1;
+};
+
+// Rigid-body six-degree-of-freedom flight dynamics for a batch of aircraft.
+// The state is one contiguous array in component-major order (all x positions,
+// then all y positions, ...), so every per-aircraft loop runs over plain
+// arrays and the RK4 stage combinations are single loops over the whole batch.
+// Positions are relative to the planet center, in meters, in a non-rotating frame.
+class FlightModel {
+public:
+    enum Integrator { RK4, SEMI_IMPLICIT_EULER };
+
+    // State components
+    enum { PX, PY, PZ, VX, VY, VZ, QW, QX, QY, QZ, WX, WY, WZ, STATE_SIZE };
+
+    Integrator integrator = RK4;
+    AircraftParams params;
+    double planetRadius = EARTH_MEAN_RADIUS;  // Meters per globe unit
+    double gravity = 9.81;           // At the surface, m/s^2
+    double fixedStep = 0.02;         // Seconds per integration step
+    int maxStepsPerAdvance = 200;    // Drop time rather than spiral when falling behind
+    const WindField* windField = nullptr;  // Optional winds aloft, sampled once per step
+
+    // Autopilot targets per aircraft
+    std::vector<double> targetAltitude;  // m above the surface
+    std::vector<double> targetSpeed;     // True airspeed, m/s
+    std::vector<double> targetBank;      // Radians, positive right wing down
+
+    size_t size() const { return count; }
+
+    void resize(size_t n) {
+        count = n;
+        state.assign(STATE_SIZE * n, 0.0);
+        for (size_t i = 0; i < n; ++i) component(QW)[i] = 1.0;
+        targetAltitude.assign(n, 10000.0);
+        targetSpeed.assign(n, 230.0);
+        targetBank.assign(n, 0.0);
+        density.assign(n, 0.0);
+        windX.assign(n, 0.0); windY.assign(n, 0.0); windZ.assign(n, 0.0);
+    }
+
+    // Place aircraft i in trimmed level flight
+    void spawn(size_t i, const glm::dvec3& direction, const glm::dvec3& heading,
+               double altitude, double speed) {
+        glm::dvec3 up = glm::normalize(direction);
+        glm::dvec3 forward = glm::normalize(heading - up * glm::dot(heading, up));
+        double radius = planetRadius + altitude;
+
+        // Angle of attack that carries the weight at this speed
+        double qbar = 0.5 * airDensity(altitude) * speed * speed;
+        double CL = params.mass * gravity / (qbar * params.wingArea);
+        double alpha = (CL - params.CL0) / params.CLalpha;
+
+        glm::dvec3 bx = forward * cos(alpha) + up * sin(alpha);
+        glm::dvec3 bz = forward * sin(alpha) - up * cos(alpha);
+        glm::dvec3 by = glm::cross(bz, bx);
+
+        double qw, qx, qy, qz;
+        quatFromAxes(bx, by, bz, qw, qx, qy, qz);
+
+        // Trimmed relative to the air mass, so carry the local wind along
+        glm::dvec3 p = up * radius;
+        glm::dvec3 v = forward * speed;
+        if (windField && !windField->empty()) {
+            glm::vec3 east, north;
+            WindField::localBasis(glm::vec3(p), east, north);
+            WindField::Sample w = windField->sample((float)glm::degrees(asin(up.y)),
+                                                   (float)glm::degrees(atan2(up.z, up.x)),
+                                                   (float)altitude);
+            v += glm::dvec3(east * w.u + north * w.v);
+        }
+        component(PX)[i] = p.x; component(PY)[i] = p.y; component(PZ)[i] = p.z;
+        component(VX)[i] = v.x; component(VY)[i] = v.y; component(VZ)[i] = v.z;
+        component(QW)[i] = qw; component(QX)[i] = qx; component(QY)[i] = qy; component(QZ)[i] = qz;
+
+        // Level flight over a sphere means pitching down at V / r
+        component(WX)[i] = 0.0;
+        component(WY)[i] = -speed / radius;
+        component(WZ)[i] = 0.0;
+
+        targetAltitude[i] = altitude;
+        targetSpeed[i] = speed;
+        targetBank[i] = 0.0;
+    }
+
+    // Run as many fixed steps as fit in deltaTime; returns the number taken
+    int advance(double deltaTime) {
+        accumulator += deltaTime;
+        int steps = 0;
+        while (accumulator >= fixedStep && steps < maxStepsPerAdvance) {
+            step(fixedStep);
+            accumulator -= fixedStep;
+            ++steps;
+        }
+        if (steps == maxStepsPerAdvance) accumulator = 0.0;
+        return steps;
+    }
+
+    // One integration step for the whole batch
+    void step(double h) {
+        if (count == 0) return;
+        const size_t n = STATE_SIZE * count;
+        updateAtmosphere();
+
+        if (integrator == SEMI_IMPLICIT_EULER) {
+            k1.resize(n);
+            derivatives(state.data(), k1.data());
+            double* s = state.data();
+            const double* d = k1.data();
+            // Velocities and rates first, then positions and attitude with the new values
+            for (size_t c = VX; c <= VZ; ++c)
+                for (size_t i = c * count; i < (c + 1) * count; ++i) s[i] += h * d[i];
+            for (size_t c = WX; c <= WZ; ++c)
+                for (size_t i = c * count; i < (c + 1) * count; ++i) s[i] += h * d[i];
+            for (size_t c = PX; c <= PZ; ++c)
+                for (size_t i = c * count; i < (c + 1) * count; ++i) s[i] += h * s[i + VX * count];
+            derivatives(state.data(), k1.data());
+            for (size_t i = QW * count; i < (QZ + 1) * count; ++i) s[i] += h * d[i];
+        } else {
+            k1.resize(n); k2.resize(n); k3.resize(n); k4.resize(n); scratch.resize(n);
+            double* s = state.data();
+            double* t = scratch.data();
+
+            derivatives(s, k1.data());
+            for (size_t i = 0; i < n; ++i) t[i] = s[i] + 0.5 * h * k1[i];
+            derivatives(t, k2.data());
+            for (size_t i = 0; i < n; ++i) t[i] = s[i] + 0.5 * h * k2[i];
+            derivatives(t, k3.data());
+            for (size_t i = 0; i < n; ++i) t[i] = s[i] + h * k3[i];
+            derivatives(t, k4.data());
+            for (size_t i = 0; i < n; ++i)
+                s[i] += h / 6.0 * (k1[i] + 2.0 * k2[i] + 2.0 * k3[i] + k4[i]);
+        }
+
+        normalizeAttitudes();
+    }
+
+    // Position in globe space (planet surface is the unit sphere)
+    glm::vec3 getGlobePosition(size_t i) const {
+        return glm::vec3(position(i) / planetRadius);
+    }
+
+    glm::dvec3 position(size_t i) const {
+        return glm::dvec3(component(PX)[i], component(PY)[i], component(PZ)[i]);
+    }
+
+    glm::dvec3 velocity(size_t i) const {
+        return glm::dvec3(component(VX)[i], component(VY)[i], component(VZ)[i]);
+    }
+
+    // Body axes in the planet frame
+    glm::vec3 getForward(size_t i) const { return glm::vec3(bodyAxis(i, 0)); }
+    glm::vec3 getRight(size_t i) const { return glm::vec3(bodyAxis(i, 1)); }
+    glm::vec3 getUp(size_t i) const { return -glm::vec3(bodyAxis(i, 2)); }
+
+    double getAltitude(size_t i) const { return glm::length(position(i)) - planetRadius; }
+    double getAirspeed(size_t i) const { return glm::length(velocity(i) - wind(i)); }
+    double getGroundspeed(size_t i) const { return glm::length(velocity(i)); }
+
+    // Wind at aircraft i as of the last step, m/s in the planet frame
+    glm::dvec3 wind(size_t i) const { return glm::dvec3(windX[i], windY[i], windZ[i]); }
+
+    static double airDensity(double altitude) {
+        return 1.225 * exp(-std::max(altitude, 0.0) / 8500.0);
+    }
+
+private:
+    size_t count = 0;
+    std::vector<double> state;
+    std::vector<double> k1, k2, k3, k4, scratch;
+    std::vector<double> density;  // Per aircraft, refreshed once per step
+    std::vector<double> windX, windY, windZ;  // Likewise
+    std::vector<float> sampleLat, sampleLon, sampleAlt, windU, windV;
+    double accumulator = 0.0;
+
+    double* component(int c) { return state.data() + c * count; }
+    const double* component(int c) const { return state.data() + c * count; }
+
+    glm::dvec3 bodyAxis(size_t i, int axis) const {
+        double w = component(QW)[i], x = component(QX)[i], y = component(QY)[i], z = component(QZ)[i];
+        if (axis == 0) return glm::dvec3(1 - 2 * (y * y + z * z), 2 * (x * y + w * z), 2 * (x * z - w * y));
+        if (axis == 1) return glm::dvec3(2 * (x * y - w * z), 1 - 2 * (x * x + z * z), 2 * (y * z + w * x));
+        return glm::dvec3(2 * (x * z + w * y), 2 * (y * z - w * x), 1 - 2 * (x * x + y * y));
+    }
+
+    static void quatFromAxes(const glm::dvec3& bx, const glm::dvec3& by, const glm::dvec3& bz,
+                             double& w, double& x, double& y, double& z) {
+        // Rotation matrix with the body axes as columns
+        double m00 = bx.x, m11 = by.y, m22 = bz.z;
+        double trace = m00 + m11 + m22;
+        if (trace > 0.0) {
+            double s = sqrt(trace + 1.0) * 2.0;
+            w = 0.25 * s;
+            x = (by.z - bz.y) / s;
+            y = (bz.x - bx.z) / s;
+            z = (bx.y - by.x) / s;
+        } else if (m00 > m11 && m00 > m22) {
+            double s = sqrt(1.0 + m00 - m11 - m22) * 2.0;
+            w = (by.z - bz.y) / s;
+            x = 0.25 * s;
+            y = (by.x + bx.y) / s;
+            z = (bz.x + bx.z) / s;
+        } else if (m11 > m22) {
+            double s = sqrt(1.0 + m11 - m00 - m22) * 2.0;
+            w = (bz.x - bx.z) / s;
+            x = (by.x + bx.y) / s;
+            y = 0.25 * s;
+            z = (bz.y + by.z) / s;
+        } else {
+            double s = sqrt(1.0 + m22 - m00 - m11) * 2.0;
+            w = (bx.y - by.x) / s;
+            x = (bz.x + bx.z) / s;
+            y = (bz.y + by.z) / s;
+            z = 0.25 * s;
+        }
+    }
+
+    // Density and wind barely change within a step, so keep exp() and the
+    // wind lookups out of the stage loops
+    void updateAtmosphere() {
+        const double* px = component(PX);
+        const double* py = component(PY);
+        const double* pz = component(PZ);
+        for (size_t i = 0; i < count; ++i) {
+            double r = sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+            density[i] = airDensity(r - planetRadius);
+        }
+
+        if (!windField || windField->empty()) return;
+        sampleLat.resize(count); sampleLon.resize(count); sampleAlt.resize(count);
+        windU.resize(count); windV.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            double r = sqrt(px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i]);
+            sampleLat[i] = (float)glm::degrees(asin(py[i] / r));
+            sampleLon[i] = (float)glm::degrees(atan2(pz[i], px[i]));
+            sampleAlt[i] = (float)(r - planetRadius);
+        }
+        windField->sampleBatch(sampleLat.data(), sampleLon.data(), sampleAlt.data(),
+                               windU.data(), windV.data(), count);
+        for (size_t i = 0; i < count; ++i) {
+            glm::vec3 east, north;
+            WindField::localBasis(glm::vec3(px[i], py[i], pz[i]), east, north);
+            windX[i] = east.x * windU[i] + north.x * windV[i];
+            windY[i] = east.y * windU[i] + north.y * windV[i];
+            windZ[i] = east.z * windU[i] + north.z * windV[i];
+        }
+    }
+
+    void normalizeAttitudes() {
+        double* qw = component(QW);
+        double* qx = component(QX);
+        double* qy = component(QY);
+        double* qz = component(QZ);
+        for (size_t i = 0; i < count; ++i) {
+            double inv = 1.0 / sqrt(qw[i] * qw[i] + qx[i] * qx[i] + qy[i] * qy[i] + qz[i] * qz[i]);
+            qw[i] *= inv; qx[i] *= inv; qy[i] *= inv; qz[i] *= inv;
+        }
+    }
+
+    // By-value helpers; std::min/max return references, which blocks if-conversion
+    static double maxd(double a, double b) {
+        return a > b ? a : b;
+    }
+
+    static double clampd(double v, double lo, double hi) {
+        return v < lo ? lo : (v > hi ? hi : v);
+    }
+
+    // Time derivative of every state component, autopilot included.
+    // Only arithmetic and sqrt inside the loop so it can vectorize.
+    void derivatives(const double* s, double* d) const {
+        const size_t n = count;
+        const double* px = s + PX * n; const double* py = s + PY * n; const double* pz = s + PZ * n;
+        const double* vx = s + VX * n; const double* vy = s + VY * n; const double* vz = s + VZ * n;
+        const double* qw = s + QW * n; const double* qx = s + QX * n;
+        const double* qy = s + QY * n; const double* qz = s + QZ * n;
+        const double* wx = s + WX * n; const double* wy = s + WY * n; const double* wz = s + WZ * n;
+
+        const double* rho = density.data();
+        const double* windVx = windX.data();
+        const double* windVy = windY.data();
+        const double* windVz = windZ.data();
+        const double* altitudeCmd = targetAltitude.data();
+        const double* speedCmd = targetSpeed.data();
+        const double* bankCmd = targetBank.data();
+
+        // Local copies so the compiler knows stores to d cannot change them
+        const AircraftParams a = params;
+        const double radius = planetRadius;
+        const double g0R2 = gravity * radius * radius;
+
+        // The component ranges of d never overlap each other or s
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+        for (size_t i = 0; i < n; ++i) {
+            // Local up and gravity
+            double r2 = px[i] * px[i] + py[i] * py[i] + pz[i] * pz[i];
+            double r = sqrt(r2);
+            double ux = px[i] / r, uy = py[i] / r, uz = pz[i] / r;
+            double g = g0R2 / r2;
+            double altitude = r - radius;
+
+            // Body axes from the attitude quaternion
+            double w = qw[i], x = qx[i], y = qy[i], z = qz[i];
+            double bxx = 1 - 2 * (y * y + z * z), bxy = 2 * (x * y + w * z), bxz = 2 * (x * z - w * y);
+            double byx = 2 * (x * y - w * z), byy = 1 - 2 * (x * x + z * z), byz = 2 * (y * z + w * x);
+            double bzx = 2 * (x * z + w * y), bzy = 2 * (y * z - w * x), bzz = 1 - 2 * (x * x + y * y);
+
+            // Air-relative velocity in body axes
+            double ax = vx[i] - windVx[i], ay = vy[i] - windVy[i], az = vz[i] - windVz[i];
+            double ub = ax * bxx + ay * bxy + az * bxz;
+            double vb = ax * byx + ay * byy + az * byz;
+            double wb = ax * bzx + ay * bzy + az * bzz;
+            double V = maxd(sqrt(ub * ub + vb * vb + wb * wb), 1.0);
+            double Vxz = maxd(sqrt(ub * ub + wb * wb), 1.0);
+            double cosA = ub / Vxz, sinA = wb / Vxz;
+            double alpha = clampd(sinA, -0.3, 0.3);
+            double beta = vb / V;
+            double qbar = 0.5 * rho[i] * V * V;
+            double qS = qbar * a.wingArea;
+
+            double p = wx[i], q = wy[i], rr = wz[i];
+
+            // Autopilot: pitch attitude from altitude error, wings to target bank,
+            // yaw damper and speed hold. Trim angle of attack and elevator come
+            // from the lift needed to carry the weight, not the measured alpha,
+            // so the natural pitch stiffness is left alone.
+            double sinTheta = bxx * ux + bxy * uy + bxz * uz;
+            double sinPhi = -(byx * ux + byy * uy + byz * uz);
+            double alphaTrim = clampd((a.mass * g / qS - a.CL0) / a.CLalpha, -0.1, 0.25);
+            double gammaCmd = clampd(0.002 * (altitudeCmd[i] - altitude), -0.1, 0.1);
+            double deTrim = -(a.Cm0 + a.Cmalpha * alphaTrim) / a.Cmde;
+            double de = clampd(deTrim + 2.0 * (sinTheta - gammaCmd - alphaTrim) + 1.5 * q, -0.35, 0.35);
+            double da = clampd(-(1.5 * (sinPhi - bankCmd[i]) + 1.0 * p), -0.3, 0.3);
+            double dr = clampd(2.0 * rr, -0.3, 0.3);
+
+            double CL = a.CL0 + a.CLalpha * alpha + a.CLde * de;
+            double CD = a.CD0 + a.CDk * CL * CL;
+            double CY = a.CYbeta * beta;
+            double dragTrim = qS * CD / a.maxThrust;
+            double throttle = clampd(dragTrim + 0.05 * (speedCmd[i] - V), 0.0, 1.0);
+
+            // Forces in body axes
+            double Fx = qS * (-CD * cosA + CL * sinA) + throttle * a.maxThrust;
+            double Fy = qS * CY;
+            double Fz = qS * (-CD * sinA - CL * cosA);
+
+            // Translational dynamics in the planet frame
+            double invM = 1.0 / a.mass;
+            d[PX * n + i] = vx[i];
+            d[PY * n + i] = vy[i];
+            d[PZ * n + i] = vz[i];
+            d[VX * n + i] = (bxx * Fx + byx * Fy + bzx * Fz) * invM - ux * g;
+            d[VY * n + i] = (bxy * Fx + byy * Fy + bzy * Fz) * invM - uy * g;
+            d[VZ * n + i] = (bxz * Fx + byz * Fy + bzz * Fz) * invM - uz * g;
+
+            // Moments
+            double b2V = a.wingSpan / (2.0 * V);
+            double c2V = a.chord / (2.0 * V);
+            double L = qS * a.wingSpan * (a.Clbeta * beta + a.Clp * p * b2V + a.Clr * rr * b2V + a.Clda * da);
+            double M = qS * a.chord * (a.Cm0 + a.Cmalpha * alpha + a.Cmq * q * c2V + a.Cmde * de);
+            double N = qS * a.wingSpan * (a.Cnbeta * beta + a.Cnr * rr * b2V + a.Cndr * dr);
+
+            // Euler's rotation equations, diagonal inertia
+            d[WX * n + i] = (L + (a.Iyy - a.Izz) * q * rr) / a.Ixx;
+            d[WY * n + i] = (M + (a.Izz - a.Ixx) * p * rr) / a.Iyy;
+            d[WZ * n + i] = (N + (a.Ixx - a.Iyy) * p * q) / a.Izz;
+
+            // Attitude kinematics: qdot = 0.5 * q * (0, w)
+            d[QW * n + i] = 0.5 * (-x * p - y * q - z * rr);
+            d[QX * n + i] = 0.5 * (w * p + y * rr - z * q);
+            d[QY * n + i] = 0.5 * (w * q - x * rr + z * p);
+            d[QZ * n + i] = 0.5 * (w * rr + x * q - y * p);
+        }
+    }
+};
+
+#endif // FLIGHT_MODEL_H
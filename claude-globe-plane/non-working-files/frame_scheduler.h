@@ -0,0 +1,131 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <ctime>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+// Decides whether a frame loop iteration draws. Whatever changes what is on
+// screen calls damage() with its source; with onDemand set, an iteration
+// without damage skips drawing and blocks in glfwWaitEventsTimeout until an
+// event arrives (input, a resize, glfwPostEmptyEvent from a worker thread)
+// or the simulation is due to have moved traffic by a pixel. Without
+// onDemand every iteration draws.
+//
+// Each iteration's wall time, process CPU time and, for drawn frames, GPU
+// time are added to the active or the idle state, and report() prints the
+// utilization of each along with what caused the redraws.
+class FrameScheduler {
+public:
+    enum Source { CAMERA, SIMULATION, UI, DATA, SOURCE_COUNT };
+
+    bool onDemand = true;
+    double maxWaitSeconds = 0.5;   // Longest block, so the config file and the simulation stay polled
+    double aircraftSpeed = 300.0;  // Fastest traffic, m/s; sets how often moving traffic needs a redraw
+
+    FrameScheduler() {
+        pending = 1 << UI;  // The first frame
+        lastAccounted = Clock::now();
+        lastCpuSeconds = processCpuSeconds();
+        lastReport = lastAccounted;
+    }
+
+    void damage(Source source) { pending |= 1 << source; }
+
+    // The simulation advanced simSeconds. metersPerPixel is the size of a
+    // pixel at the nearest visible surface, where traffic moves fastest on
+    // screen; once it may have moved a whole pixel, that is damage.
+    void simulationAdvanced(double simSeconds, double metersPerPixel) {
+        simSecondsSinceDraw += simSeconds;
+        pixelSimSeconds = metersPerPixel / aircraftSpeed;
+        if (simSecondsSinceDraw >= pixelSimSeconds) damage(SIMULATION);
+    }
+
+    bool shouldDraw() const { return !onDemand || pending != 0; }
+
+    // End of an iteration: take in events, blocking first if nothing was
+    // drawn, and book the iteration to its state. gpuMs is the drawn
+    // frame's GPU time; timeScale the simulated seconds per real second.
+    void finishIteration(bool drew, double gpuMs, double timeScale) {
+        if (drew) {
+            for (int s = 0; s < SOURCE_COUNT; ++s) {
+                if (pending & (1 << s)) ++redraws[s];
+            }
+            pending = 0;
+            simSecondsSinceDraw = 0.0;
+            glfwPollEvents();
+        } else {
+            double wait = maxWaitSeconds;
+            if (timeScale > 0.0) wait = std::min(wait, (pixelSimSeconds - simSecondsSinceDraw) / timeScale);
+            glfwWaitEventsTimeout(std::max(wait, 0.001));
+        }
+
+        Clock::time_point now = Clock::now();
+        double cpuSeconds = processCpuSeconds();
+        State& state = drew ? active : idle;
+        state.wallSeconds += std::chrono::duration<double>(now - lastAccounted).count();
+        state.cpuSeconds += cpuSeconds - lastCpuSeconds;
+        state.gpuMs += gpuMs;
+        ++state.iterations;
+        lastAccounted = now;
+        lastCpuSeconds = cpuSeconds;
+    }
+
+    // Print utilization every interval seconds, then start over. CPU is the
+    // whole process (worker threads included), as a share of one core.
+    void report(double intervalSeconds) {
+        double elapsed = std::chrono::duration<double>(Clock::now() - lastReport).count();
+        if (elapsed < intervalSeconds) return;
+
+        std::cout << "--- Frames (" << (onDemand ? "on demand" : "continuous") << ") ---" << std::endl;
+        std::cout << std::fixed << std::setprecision(1);
+        printState("active", active, "frames");
+        printState("idle", idle, "wakeups");
+        std::cout << "redraws: camera " << redraws[CAMERA] << ", simulation " << redraws[SIMULATION]
+                  << ", ui " << redraws[UI] << ", data " << redraws[DATA] << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+
+        active = idle = State();
+        for (int s = 0; s < SOURCE_COUNT; ++s) redraws[s] = 0;
+        lastReport = Clock::now();
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct State {
+        double wallSeconds = 0.0;
+        double cpuSeconds = 0.0;
+        double gpuMs = 0.0;
+        long long iterations = 0;
+    };
+
+    unsigned int pending = 0;  // Bit per Source since the last drawn frame
+    double simSecondsSinceDraw = 0.0;
+    double pixelSimSeconds = 0.0;
+    State active, idle;
+    long long redraws[SOURCE_COUNT] = {0, 0, 0, 0};
+    Clock::time_point lastAccounted, lastReport;
+    double lastCpuSeconds = 0.0;
+
+    static void printState(const char* name, const State& state, const char* unit) {
+        double wall = std::max(state.wallSeconds, 1e-9);
+        std::cout << std::left << std::setw(7) << name << std::right
+                  << std::setw(7) << state.iterations << " " << std::left << std::setw(8) << unit << std::right
+                  << std::setw(6) << state.wallSeconds << " s"
+                  << "  cpu " << std::setw(5) << 100.0 * state.cpuSeconds / wall << "%"
+                  << "  gpu " << std::setw(5) << 0.1 * state.gpuMs / wall << "%" << std::endl;
+    }
+
+    static double processCpuSeconds() {
+        timespec t;
+        if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &t) != 0) return 0.0;
+        return (double)t.tv_sec + t.tv_nsec * 1e-9;
+    }
+};
+
+#endif // FRAME_SCHEDULER_H
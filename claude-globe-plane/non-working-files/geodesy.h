@@ -0,0 +1,281 @@
+#ifndef GEODESY_H
+#define GEODESY_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <cstddef>
+
+// WGS84 ellipsoid
+const double WGS84_A = 6378137.0;                    // Semi-major axis, m
+const double WGS84_F = 1.0 / 298.257223563;          // Flattening
+const double WGS84_B = WGS84_A * (1.0 - WGS84_F);    // Semi-minor axis, m
+const double WGS84_E2 = WGS84_F * (2.0 - WGS84_F);   // First eccentricity squared
+const double WGS84_EP2 = WGS84_E2 / (1.0 - WGS84_E2);  // Second eccentricity squared
+const double EARTH_MEAN_RADIUS = 6371008.8;          // m, for spherical formulas
+
+// Latitude and longitude in radians, height above the ellipsoid in meters
+struct Geodetic {
+    double latitude = 0.0;
+    double longitude = 0.0;
+    double height = 0.0;
+};
+
+inline glm::dvec3 geodeticToEcef(double latitude, double longitude, double height) {
+    double sinLat = sin(latitude), cosLat = cos(latitude);
+    double N = WGS84_A / sqrt(1.0 - WGS84_E2 * sinLat * sinLat);  // Prime vertical radius
+    return glm::dvec3((N + height) * cosLat * cos(longitude),
+                      (N + height) * cosLat * sin(longitude),
+                      (N * (1.0 - WGS84_E2) + height) * sinLat);
+}
+
+// Closed form (Heikkinen); sub-millimeter from the center of the Earth outwards
+inline Geodetic ecefToGeodetic(const glm::dvec3& p) {
+    const double a = WGS84_A, b = WGS84_B, e2 = WGS84_E2;
+    Geodetic g;
+    g.longitude = atan2(p.y, p.x);
+
+    double rho2 = p.x * p.x + p.y * p.y;
+    double rho = sqrt(rho2);
+    double z2 = p.z * p.z;
+    if (rho < 1e-9) {
+        g.latitude = p.z >= 0.0 ? M_PI / 2 : -M_PI / 2;
+        g.height = fabs(p.z) - b;
+        return g;
+    }
+
+    double F = 54.0 * b * b * z2;
+    double G = rho2 + (1.0 - e2) * z2 - e2 * (a * a - b * b);
+    double c = e2 * e2 * F * rho2 / (G * G * G);
+    double s = cbrt(1.0 + c + sqrt(c * c + 2.0 * c));
+    double k = s + 1.0 + 1.0 / s;
+    double P = F / (3.0 * k * k * G * G);
+    double Q = sqrt(1.0 + 2.0 * e2 * e2 * P);
+    double r0 = -(P * e2 * rho) / (1.0 + Q) +
+                sqrt(0.5 * a * a * (1.0 + 1.0 / Q) - P * (1.0 - e2) * z2 / (Q * (1.0 + Q)) - 0.5 * P * rho2);
+    double t = rho - e2 * r0;
+    double U = sqrt(t * t + z2);
+    double V = sqrt(t * t + (1.0 - e2) * z2);
+    double z0 = b * b * p.z / (a * V);
+
+    g.height = U * (1.0 - b * b / (a * V));
+    g.latitude = atan((p.z + WGS84_EP2 * z0) / rho);
+    return g;
+}
+
+// ECEF has z through the north pole; the globe frame has y up and
+// lon = atan2(z, x), so the two differ by swapping y and z
+inline glm::dvec3 ecefToGlobeFrame(const glm::dvec3& ecef) {
+    return glm::dvec3(ecef.x, ecef.z, ecef.y);
+}
+
+inline glm::dvec3 globeFrameToEcef(const glm::dvec3& globe) {
+    return glm::dvec3(globe.x, globe.z, globe.y);
+}
+
+// Great-circle distance on a sphere, m
+inline double haversineDistance(double lat1, double lon1, double lat2, double lon2,
+                                double radius = EARTH_MEAN_RADIUS) {
+    double sinDLat = sin(0.5 * (lat2 - lat1));
+    double sinDLon = sin(0.5 * (lon2 - lon1));
+    double h = sinDLat * sinDLat + cos(lat1) * cos(lat2) * sinDLon * sinDLon;
+    return 2.0 * radius * asin(sqrt(h < 1.0 ? h : 1.0));
+}
+
+// Initial great-circle bearing from point 1 to point 2, radians clockwise from north
+inline double initialBearing(double lat1, double lon1, double lat2, double lon2) {
+    double dLon = lon2 - lon1;
+    double y = sin(dLon) * cos(lat2);
+    double x = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dLon);
+    return atan2(y, x);
+}
+
+// Vincenty's inverse problem on the ellipsoid: geodesic distance (m) and the
+// forward azimuths at both ends (radians from north). Returns false when the
+// iteration does not converge, which happens for nearly antipodal points.
+inline bool vincentyInverse(double lat1, double lon1, double lat2, double lon2,
+                            double& distance, double& azimuth1, double& azimuth2) {
+    const double a = WGS84_A, b = WGS84_B, f = WGS84_F;
+    double L = lon2 - lon1;
+    double U1 = atan((1.0 - f) * tan(lat1));
+    double U2 = atan((1.0 - f) * tan(lat2));
+    double sinU1 = sin(U1), cosU1 = cos(U1);
+    double sinU2 = sin(U2), cosU2 = cos(U2);
+
+    double lambda = L, sinSigma = 0.0, cosSigma = 1.0, sigma = 0.0;
+    double cos2Alpha = 1.0, cos2SigmaM = 0.0;
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        double sinLambda = sin(lambda), cosLambda = cos(lambda);
+        double t1 = cosU2 * sinLambda;
+        double t2 = cosU1 * sinU2 - sinU1 * cosU2 * cosLambda;
+        sinSigma = sqrt(t1 * t1 + t2 * t2);
+        if (sinSigma == 0.0) {
+            distance = 0.0;
+            azimuth1 = azimuth2 = 0.0;
+            return true;  // Coincident points
+        }
+        cosSigma = sinU1 * sinU2 + cosU1 * cosU2 * cosLambda;
+        sigma = atan2(sinSigma, cosSigma);
+        double sinAlpha = cosU1 * cosU2 * sinLambda / sinSigma;
+        cos2Alpha = 1.0 - sinAlpha * sinAlpha;
+        cos2SigmaM = cos2Alpha != 0.0 ? cosSigma - 2.0 * sinU1 * sinU2 / cos2Alpha : 0.0;  // Equatorial line
+        double C = f / 16.0 * cos2Alpha * (4.0 + f * (4.0 - 3.0 * cos2Alpha));
+        double previous = lambda;
+        lambda = L + (1.0 - C) * f * sinAlpha *
+                 (sigma + C * sinSigma * (cos2SigmaM + C * cosSigma * (-1.0 + 2.0 * cos2SigmaM * cos2SigmaM)));
+        if (fabs(lambda - previous) < 1e-12) {
+            double u2 = cos2Alpha * (a * a - b * b) / (b * b);
+            double A = 1.0 + u2 / 16384.0 * (4096.0 + u2 * (-768.0 + u2 * (320.0 - 175.0 * u2)));
+            double B = u2 / 1024.0 * (256.0 + u2 * (-128.0 + u2 * (74.0 - 47.0 * u2)));
+            double deltaSigma = B * sinSigma * (cos2SigmaM + B / 4.0 *
+                (cosSigma * (-1.0 + 2.0 * cos2SigmaM * cos2SigmaM) -
+                 B / 6.0 * cos2SigmaM * (-3.0 + 4.0 * sinSigma * sinSigma) * (-3.0 + 4.0 * cos2SigmaM * cos2SigmaM)));
+            distance = b * A * (sigma - deltaSigma);
+            sinLambda = sin(lambda);
+            cosLambda = cos(lambda);
+            azimuth1 = atan2(cosU2 * sinLambda, cosU1 * sinU2 - sinU1 * cosU2 * cosLambda);
+            azimuth2 = atan2(cosU1 * sinLambda, -sinU1 * cosU2 + cosU1 * sinU2 * cosLambda);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Round to nearest integer with one add and one subtract (|x| < 2^51). Unlike
+// floor() this vectorizes on plain SSE2. Relies on strict FP semantics, so it
+// must not be built with -ffast-math.
+inline double roundNearest(double x) {
+    const double shifter = 6755399441055744.0;  // 1.5 * 2^52
+    return (x + shifter) - shifter;
+}
+
+// Branch-free sine and cosine, within a couple of ulps of the libm results
+// for |x| up to a few thousand radians. Written with selects only so that
+// loops calling it can be vectorized without a vector math library.
+inline void sinCosFast(double x, double& s, double& c) {
+    // Reduce to [-pi/4, pi/4] with pi/2 split into three parts
+    double j = roundNearest(x * 0.63661977236758134308);
+    double y = x - j * 1.57079632673412561417e+00;
+    y -= j * 6.07710050630396597660e-11;
+    y -= j * 2.02226624879595063154e-21;
+
+    // Quadrant 0..3, kept in double since there is no packed double -> int64
+    // conversion before AVX-512; j / 4 - 0.375 rounds to floor(j / 4)
+    double quadrant = j - 4.0 * roundNearest(j * 0.25 - 0.375);
+
+    double z = y * y;
+    double sy = y + y * z * (-1.66666666666666307295e-1 + z * (8.33333333332211858878e-3 +
+                z * (-1.98412698295895385996e-4 + z * (2.75573136213857245213e-6 +
+                z * (-2.50507477628578072866e-8 + z * 1.58962301576546568060e-10)))));
+    double cy = 1.0 - 0.5 * z + z * z * (4.16666666666665929218e-2 + z * (-1.38888888888730564116e-3 +
+                z * (2.48015872888517045348e-5 + z * (-2.75573141792967388112e-7 +
+                z * (2.08757008419747316778e-9 + z * -1.13585365213876817300e-11)))));
+
+    bool swap = quadrant == 1.0 || quadrant == 3.0;
+    double sr = swap ? cy : sy;
+    double cr = swap ? sy : cy;
+    s = quadrant >= 2.0 ? -sr : sr;
+    c = (quadrant == 1.0 || quadrant == 2.0) ? -cr : cr;
+}
+
+// Bulk geodetic -> ECEF over plain arrays; one loop with no calls into libm
+inline void geodeticToEcefBatch(const double* latitude, const double* longitude, const double* height,
+                                double* x, double* y, double* z, size_t count) {
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+    for (size_t i = 0; i < count; ++i) {
+        double sinLat, cosLat, sinLon, cosLon;
+        sinCosFast(latitude[i], sinLat, cosLat);
+        sinCosFast(longitude[i], sinLon, cosLon);
+        double N = WGS84_A / sqrt(1.0 - WGS84_E2 * sinLat * sinLat);
+        double r = (N + height[i]) * cosLat;
+        x[i] = r * cosLon;
+        y[i] = r * sinLon;
+        z[i] = (N * (1.0 - WGS84_E2) + height[i]) * sinLat;
+    }
+}
+
+// Bulk ECEF -> geodetic. Bowring's iteration needs only arithmetic and sqrt,
+// so the first loop vectorizes and leaves latitude as a (sin, cos) direction;
+// a second loop turns the directions into angles. Three iterations are well
+// below a millimeter from the surface out past geostationary altitude.
+inline void ecefToGeodeticBatch(const double* x, const double* y, const double* z,
+                                double* latitude, double* longitude, double* height, size_t count) {
+    const double a = WGS84_A, b = WGS84_B, e2 = WGS84_E2, ep2 = WGS84_EP2, f = WGS84_F;
+
+    // latitude/longitude hold the sin/cos of latitude between the two loops
+    double* sinLat = latitude;
+    double* cosLat = longitude;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+    for (size_t i = 0; i < count; ++i) {
+        double p = sqrt(x[i] * x[i] + y[i] * y[i]);
+        double zi = z[i];
+
+        // Reduced latitude as a direction (cos, sin), starting from the sphere guess
+        double cb = b * p, sb = a * zi;
+        double sn = 0.0, cs = 1.0;
+        for (int iteration = 0; iteration < 3; ++iteration) {
+            double inv = 1.0 / sqrt(cb * cb + sb * sb);
+            cb *= inv;
+            sb *= inv;
+            sn = zi + ep2 * b * sb * sb * sb;
+            cs = p - e2 * a * cb * cb * cb;
+            cb = cs;
+            sb = (1.0 - f) * sn;
+        }
+
+        double inv = 1.0 / sqrt(sn * sn + cs * cs);
+        double s = sn * inv, c = cs * inv;
+        height[i] = p * c + zi * s - a * sqrt(1.0 - e2 * s * s);
+        sinLat[i] = s;
+        cosLat[i] = c;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        double lat = atan2(sinLat[i], cosLat[i]);
+        longitude[i] = atan2(y[i], x[i]);
+        latitude[i] = lat;
+    }
+}
+
+// Rendering in float loses about half a meter at Earth radius. Subtracting the
+// eye position in double first keeps the nearby geometry exact.
+inline glm::vec3 relativeToEye(const glm::dvec3& position, const glm::dvec3& eye) {
+    return glm::vec3(position - eye);
+}
+
+inline void relativeToEyeBatch(const double* x, const double* y, const double* z, size_t count,
+                               const glm::dvec3& eye, float* out) {
+    for (size_t i = 0; i < count; ++i) {
+        out[3 * i + 0] = (float)(x[i] - eye.x);
+        out[3 * i + 1] = (float)(y[i] - eye.y);
+        out[3 * i + 2] = (float)(z[i] - eye.z);
+    }
+}
+
+// A double as the sum of two floats; high + low carries about 48 bits, so the
+// GPU can subtract a split eye position and recover the small difference
+inline void splitDouble(double value, float& high, float& low) {
+    high = (float)value;
+    low = (float)(value - (double)high);
+}
+
+inline void splitDouble(const glm::dvec3& value, glm::vec3& high, glm::vec3& low) {
+    splitDouble(value.x, high.x, low.x);
+    splitDouble(value.y, high.y, low.y);
+    splitDouble(value.z, high.z, low.z);
+}
+
+// Interleaved xyz high and low parts, ready for vertex upload
+inline void splitPositionsBatch(const double* x, const double* y, const double* z, size_t count,
+                                float* high, float* low) {
+    for (size_t i = 0; i < count; ++i) {
+        splitDouble(x[i], high[3 * i + 0], low[3 * i + 0]);
+        splitDouble(y[i], high[3 * i + 1], low[3 * i + 1]);
+        splitDouble(z[i], high[3 * i + 2], low[3 * i + 2]);
+    }
+}
+
+#endif // GEODESY_H
@@ -0,0 +1,294 @@
+#ifndef GLOBE_IMPOSTOR_H
+#define GLOBE_IMPOSTOR_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <cmath>
+
+#include "shaders.h"
+#include "shader_utils.h"
+#include "camera.h"
+#include "render_targets.h"
+
+// Draws a distant globe as a sprite. From far out the globe is a small disc
+// whose picture hardly changes between frames, so instead of shading the
+// mesh every frame it is rendered into a square texture just big enough for
+// its size on screen, and that texture is drawn on a quad facing the eye.
+// The sprite intersects each pixel's ray with the sphere, so its outline
+// and depth are exact for the current eye and traffic sorts against it as
+// against the mesh; only the picture is from the eye it was rendered from.
+//
+// The picture is redrawn once the eye's direction from the globe center or
+// the sun's direction has turned by maxDriftDegrees, the eye distance has
+// changed by the same fraction, or the globe outgrew the texture or shrank
+// below half of it. Redraws are incremental: from half the drift limit, a
+// new picture is rendered into a second texture one band of rows per frame
+// and swapped in after refreshSlices frames, so a slowly turning view never
+// pays for a whole globe pass in one frame. Past the limit, or after a size
+// change, the remaining bands are drawn at once.
+class GlobeImpostor {
+public:
+    bool enabled = true;
+    int maxPixels = 384;           // Largest on-screen globe diameter drawn as a sprite
+    float maxDriftDegrees = 0.5f;  // Eye or sun turn before the picture must be redrawn
+    int refreshSlices = 4;         // Frames a redraw is spread over
+    double minDistance = 1.5;      // Eye distance from the center, planet radii, below which the mesh is drawn
+
+    struct Stats {
+        long long frames = 0;         // Frames the globe was drawn as the sprite
+        long long hits = 0;           // Of those, frames that rendered nothing into a picture
+        long long slices = 0;         // Bands rendered
+        long long redraws = 0;        // Pictures completed
+        double directPixels = 0.0;    // Globe pixels the mesh would have shaded on sprite frames
+        double renderedPixels = 0.0;  // Picture pixels shaded instead
+    };
+
+    // Call once after the GL context is current, with the scene's color
+    // format and depth mode
+    void init(GLenum colorFormat, bool reversedZ) {
+        program = createShaderProgram(impostorVertexShaderSource, impostorFragmentShaderSource);
+        setup(colorFormat, reversedZ);
+    }
+
+    // Init for another window sharing source's program (see SceneRenderer::initShared)
+    void initShared(const GlobeImpostor& source, GLenum colorFormat, bool reversedZ) {
+        enabled = source.enabled;
+        maxPixels = source.maxPixels;
+        maxDriftDegrees = source.maxDriftDegrees;
+        refreshSlices = source.refreshSlices;
+        minDistance = source.minDistance;
+        sharesProgram = true;
+        program = source.program;
+        setup(colorFormat, reversedZ);
+    }
+
+    // Decide how this frame draws the globe: true for the sprite, in which
+    // case render the bands that are due (beginSlice) before the scene pass
+    // and draw() in place of the mesh. fovRadians and viewportHeight are the
+    // main view's; sunDirection is in the globe frame.
+    bool begin(const RenderView& view, const glm::dvec3& sunDirection, float fovRadians, int viewportHeight) {
+        slicesDue = 0;
+        if (!enabled) return false;
+        double distance = glm::length(view.eye);
+        double radius = view.planetRadius;
+        if (distance < minDistance * radius) return false;
+        double tanHalfAngle = radius / sqrt(distance * distance - radius * radius);
+        double diameter = viewportHeight * tanHalfAngle / tan(fovRadians * 0.5);
+        if (diameter > maxPixels) return false;
+
+        Picture wanted = pictureFor(view, sunDirection, tanHalfAngle, diameter);
+        ++stats.frames;
+        stats.directPixels += 0.25 * M_PI * diameter * diameter;
+
+        double limit = glm::radians((double)maxDriftDegrees);
+        bool resize = !shown.valid || wanted.size > shown.size || 2 * wanted.size < shown.size;
+        double drift = shown.valid ? shown.drift(wanted) : limit;
+        bool rush = resize || drift >= limit;
+        if (rush || (drift >= 0.5 * limit && !redrawing)) startRedraw(wanted);
+        if (redrawing) slicesDue = rush ? sliceCount - nextSlice : 1;
+        else ++stats.hits;
+        return true;
+    }
+
+    bool redrawDue() const { return slicesDue > 0; }
+
+    // Set up the next band of picture due this frame: binds the picture
+    // being drawn, clears the band (scissored), and gives the camera, depth
+    // setup and sun to render the globe with. False once this frame's bands
+    // are done; call endSlice() after each band.
+    bool beginSlice(RenderView& sliceView, glm::mat4& projection, glm::dvec3& sunDirection) {
+        if (slicesDue <= 0) return false;
+        RenderTarget& target = pictures[1 - front];
+        if (target.width() != pending.size) target.allocate(pending.size, pending.size);
+        target.bind();
+
+        int y0 = pending.size * nextSlice / sliceCount, y1 = pending.size * (nextSlice + 1) / sliceCount;
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(0, y0, pending.size, y1 - y0);
+        glDepthFunc(reversedZ ? GL_GREATER : GL_LESS);
+        glClearDepth(reversedZ ? 0.0 : 1.0);
+        glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        sliceView = pending.view();
+        float fov = 2.0f * (float)atan(pending.tanHalfAngle * (1.0 + MARGIN));
+        projection = reversedZ ? sliceView.reversedProjection(fov, 1.0f) : sliceView.projection(fov, 1.0f);
+        sunDirection = pending.sun;
+        ++stats.slices;
+        stats.renderedPixels += (double)pending.size * (y1 - y0);
+        return true;
+    }
+
+    void endSlice() {
+        glDisable(GL_SCISSOR_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        --slicesDue;
+        if (++nextSlice < sliceCount) return;
+        front = 1 - front;
+        shown = pending;
+        redrawing = false;
+        slicesDue = 0;
+        ++stats.redraws;
+    }
+
+    // Draw the sprite into the bound scene target, depth tested like the
+    // mesh. view is the rotation-only matrix of renderView.
+    void draw(const RenderView& renderView, const glm::mat4& view, const glm::mat4& proj) {
+        glm::vec3 center = glm::vec3(-renderView.eye / renderView.planetRadius);
+        glm::mat4 viewProjection = proj * view;
+        float halfSize = (float)(shown.distance / shown.radius * shown.tanHalfAngle * (1.0 + MARGIN));
+
+        glUseProgram(program);
+        glUniform3f(centerLoc, center.x, center.y, center.z);
+        glUniform3f(rightLoc, shown.right.x, shown.right.y, shown.right.z);
+        glUniform3f(upLoc, shown.up.x, shown.up.y, shown.up.z);
+        glUniform1f(halfSizeLoc, halfSize);
+        glUniform1f(radiusLoc, (float)renderView.planetRadius);
+        glUniformMatrix4fv(viewProjectionLoc, 1, GL_FALSE, glm::value_ptr(viewProjection));
+        glUniform1i(zeroToOneLoc, reversedZ ? 1 : 0);
+        glUniform1i(pictureLoc, 0);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, pictures[front].colorTexture());
+        glBindVertexArray(vertexArray);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+    }
+
+    // Drop the picture, e.g. after the globe mesh changed
+    void invalidate() {
+        shown.valid = false;
+        redrawing = false;
+        slicesDue = 0;
+    }
+
+    // Since the last reset
+    const Stats& statistics() const { return stats; }
+    void resetStatistics() { stats = Stats(); }
+
+    // Print the hit rate and the shading saved every interval seconds while the sprite is in use
+    void report(double intervalSeconds) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastReport).count();
+        if (elapsed < intervalSeconds) return;
+        if (stats.frames > 0) {
+            std::cout << "Impostor: " << (int)(100 * stats.hits / stats.frames) << "% of " << stats.frames
+                      << " frames reused the picture, " << stats.redraws << " redraw(s) in " << stats.slices
+                      << " band(s), shaded " << (int)(100.0 * stats.renderedPixels / std::max(stats.directPixels, 1.0))
+                      << "% of the globe pixels" << std::endl;
+        }
+        resetStatistics();
+        lastReport = std::chrono::steady_clock::now();
+    }
+
+    void cleanup() {
+        pictures[0].release();
+        pictures[1].release();
+        if (vertexArray) glDeleteVertexArrays(1, &vertexArray);
+        vertexArray = 0;
+        if (!sharesProgram && program) glDeleteProgram(program);
+        program = 0;
+        invalidate();
+    }
+
+private:
+    static constexpr double MARGIN = 0.05;  // Picture room around the outline, for eye movement before a redraw
+
+    // What a picture was rendered from; positions in the globe frame
+    struct Picture {
+        bool valid = false;
+        glm::dvec3 eye = glm::dvec3(0.0);
+        glm::dvec3 eyeDirection = glm::dvec3(0.0, 0.0, 1.0);  // From the center
+        glm::dvec3 sun = glm::dvec3(1.0, 0.0, 0.0);
+        glm::vec3 right = glm::vec3(1.0f, 0.0f, 0.0f), up = glm::vec3(0.0f, 1.0f, 0.0f);
+        double distance = 1.0, radius = 1.0;
+        double tanHalfAngle = 1.0;  // Of the cone around the globe
+        int size = 0;               // Texels square
+
+        // Largest of the eye and sun turns (radians) and the relative distance change
+        double drift(const Picture& other) const {
+            double eyeTurn = acos(glm::clamp(glm::dot(eyeDirection, other.eyeDirection), -1.0, 1.0));
+            double sunTurn = acos(glm::clamp(glm::dot(sun, other.sun), -1.0, 1.0));
+            return std::max(std::max(eyeTurn, sunTurn), fabs(other.distance / distance - 1.0));
+        }
+
+        // Camera looking at the center along the picture's axes
+        RenderView view() const {
+            RenderView v;
+            v.eye = eye;
+            v.planetRadius = radius;
+            v.rotation = glm::lookAt(glm::vec3(0.0f), glm::vec3(-eyeDirection), up);
+            return v;
+        }
+    };
+
+    unsigned int program = 0;
+    bool sharesProgram = false;
+    unsigned int vertexArray = 0;  // Empty; the quad comes from gl_VertexID
+    bool reversedZ = false;
+    RenderTarget pictures[2];
+    int front = 0;  // Picture drawn; the other one is being redrawn
+    Picture shown, pending;
+    bool redrawing = false;
+    int sliceCount = 1, nextSlice = 0;  // Of the pending picture
+    int slicesDue = 0;                  // Bands still to render this frame
+    Stats stats;
+    std::chrono::steady_clock::time_point lastReport = std::chrono::steady_clock::now();
+
+    int centerLoc = -1, rightLoc = -1, upLoc = -1, halfSizeLoc = -1, radiusLoc = -1;
+    int viewProjectionLoc = -1, zeroToOneLoc = -1, pictureLoc = -1;
+
+    void setup(GLenum colorFormat, bool reversed) {
+        reversedZ = reversed;
+        for (RenderTarget& picture : pictures) {
+            picture = RenderTarget();
+            picture.colorFormat = colorFormat;
+            picture.depthFormat = reversedZ ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24;
+        }
+        glGenVertexArrays(1, &vertexArray);
+
+        centerLoc = glGetUniformLocation(program, "center");
+        rightLoc = glGetUniformLocation(program, "right");
+        upLoc = glGetUniformLocation(program, "up");
+        halfSizeLoc = glGetUniformLocation(program, "halfSize");
+        radiusLoc = glGetUniformLocation(program, "radius");
+        viewProjectionLoc = glGetUniformLocation(program, "viewProjection");
+        zeroToOneLoc = glGetUniformLocation(program, "zeroToOne");
+        pictureLoc = glGetUniformLocation(program, "picture");
+    }
+
+    Picture pictureFor(const RenderView& view, const glm::dvec3& sunDirection, double tanHalfAngle,
+                       double diameter) const {
+        Picture p;
+        p.valid = true;
+        p.eye = view.eye;
+        p.distance = glm::length(view.eye);
+        p.radius = view.planetRadius;
+        p.eyeDirection = view.eye / p.distance;
+        p.sun = glm::normalize(sunDirection);
+        p.tanHalfAngle = tanHalfAngle;
+        // Whole 32 texel steps, so small zooms do not reallocate
+        p.size = std::max(32, ((int)ceil(diameter * (1.0 + MARGIN)) + 31) / 32 * 32);
+
+        // The globe's axis as up, unless the eye is over a pole
+        glm::vec3 forward = glm::vec3(-p.eyeDirection);
+        glm::vec3 upHint = fabs(p.eyeDirection.y) > 0.99 ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        p.right = glm::normalize(glm::cross(forward, upHint));
+        p.up = glm::cross(p.right, forward);
+        return p;
+    }
+
+    // Begin rendering wanted into the back picture, from its first band
+    void startRedraw(const Picture& wanted) {
+        pending = wanted;
+        redrawing = true;
+        sliceCount = std::max(1, std::min(refreshSlices, pending.size));
+        nextSlice = 0;
+    }
+};
+
+#endif // GLOBE_IMPOSTOR_H
@@ -0,0 +1,355 @@
+#ifndef HDR_PIPELINE_H
+#define HDR_PIPELINE_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "shaders.h"
+#include "shader_utils.h"
+#include "render_targets.h"
+#include "profiler.h"
+
+// Compute dispatch (GL 4.3) and image load/store (GL 4.2) are newer than
+// the 3.3 glad loader
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#endif
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC_)(GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC_)(GLbitfield barriers);
+typedef void (APIENTRYP PFNGLBINDIMAGETEXTUREPROC_)(GLuint unit, GLuint texture, GLint level, GLboolean layered,
+                                                    GLint layer, GLenum access, GLenum format);
+
+// High dynamic range output. The scene renders into a half-float color
+// target, so bright light like the sun's highlight on water keeps its value
+// instead of clipping at 1, and a post chain turns it into display colors:
+//
+//   luminance histogram  compute: 256-bin histogram of log2 luminance
+//   exposure             compute: histogram average to a target exposure,
+//                        approached smoothly over time
+//   tonemap              exposure and a filmic curve, into the view
+//
+// Without GL 4.3 compute, metering falls back to drawing log luminance into
+// a small target and averaging it down its mip chain ("luminance mips"),
+// with the exposure step as a one-pixel draw.
+//
+// Each pass is a profiler scope. Metering is the part that can give, so
+// when the chain's GPU time goes over budgetMs the histogram samples a
+// sparser pixel grid, and past that meters only every few frames, keeping
+// the last exposure in between. It steps back once the denser setting
+// would fit again. The tonemap is one full-screen pass and always runs.
+class HdrPipeline {
+public:
+    bool enabled = true;          // Set before init; false if HDR is off or unavailable
+    bool allowCompute = true;     // Set before init; false forces mip chain metering
+    float keyValue = 0.18f;       // Average luminance the exposure aims for
+    float adaptationRate = 1.5f;  // Per second; higher adapts faster
+    float minExposure = 0.25f, maxExposure = 4.0f;
+    float minLogLuminance = -10.0f, logRange = 14.0f;  // Histogram range, log2
+    double budgetMs = 0.5;        // GPU time for the whole post chain
+
+    // Call once after the GL context is current, before the scene target is made
+    void init() {
+        if (!enabled) return;
+        postVertexArray = createPostVertexArray();
+        tonemapProgram = createShaderProgram(postVertexShaderSource, tonemapFragmentShaderSource);
+        glUseProgram(tonemapProgram);
+        glUniform1i(glGetUniformLocation(tonemapProgram, "sceneColor"), 0);
+        glUniform1i(glGetUniformLocation(tonemapProgram, "exposure"), 1);
+
+        compute = allowCompute && loadCompute();
+        if (compute) {
+            histogramProgram = createComputeProgram(histogramComputeShaderSource);
+            exposureProgram = createComputeProgram(exposureComputeShaderSource);
+        } else {
+            logLuminanceProgram = createShaderProgram(postVertexShaderSource, logLuminanceFragmentShaderSource);
+            exposureProgram = createShaderProgram(postVertexShaderSource, exposureFragmentShaderSource);
+            glUseProgram(exposureProgram);
+            glUniform1i(glGetUniformLocation(exposureProgram, "logLuminance"), 0);
+            glUniform1i(glGetUniformLocation(exposureProgram, "previousExposure"), 1);
+        }
+        glUseProgram(0);
+        findUniforms();
+        createMeteringTargets();
+
+        std::cout << "HDR rendering enabled (" << (compute ? "compute histogram" : "mip chain")
+                  << " metering)" << std::endl;
+    }
+
+    // Init for another window whose context shares objects with source's.
+    // The programs are used from source; the vertex array, framebuffers and
+    // this window's own exposure are made here.
+    void initShared(const HdrPipeline& source) {
+        *this = source;
+        if (!enabled) return;
+        sharesPrograms = true;
+        exposure[0] = exposure[1] = luminance = RenderTarget();  // Source's, not to be released here
+        postVertexArray = createPostVertexArray();
+        createMeteringTargets();
+    }
+
+    // Color format the scene should render into
+    GLenum colorFormat() const { return enabled ? GL_RGBA16F : GL_RGBA8; }
+
+    bool usesCompute() const { return compute; }
+
+    // Pixels between histogram samples and frames between meterings, as the
+    // budget currently has them
+    int sampleStride() const { return 1 << std::min(level, STRIDE_LEVELS - 1); }
+    int meteringInterval() const { return 1 << std::max(0, level - (STRIDE_LEVELS - 1)); }
+
+    // GPU time of the chain per frame, as of the latest resolved frame
+    double lastCostMs() const { return costMs; }
+
+    // Meter the scene if due, then tonemap it into the view in the window
+    void resolve(const RenderTarget& scene, const Viewport& viewport, Profiler& profiler) {
+        if (++framesSinceMetering >= meteringInterval()) {
+            Clock::time_point now = Clock::now();
+            double seconds = std::chrono::duration<double>(now - lastMetering).count();
+            float adaptation = (float)(1.0 - std::exp(-seconds * adaptationRate));
+            lastMetering = now;
+            framesSinceMetering = 0;
+
+            glDisable(GL_DEPTH_TEST);
+            glBindVertexArray(postVertexArray);
+            if (compute) meterWithHistogram(scene, adaptation, profiler);
+            else meterWithMips(scene, adaptation, profiler);
+        }
+
+        profiler.begin("tonemap");
+        tonemap(scene, viewport);
+        profiler.end();
+        keepToBudget(profiler);
+    }
+
+    // Tonemap another image (like a second view of the scene) into the
+    // window with the exposure metered last
+    void tonemap(const RenderTarget& source, const Viewport& viewport) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport.x, viewport.y, viewport.width, viewport.height);
+        glDisable(GL_DEPTH_TEST);
+        glUseProgram(tonemapProgram);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source.colorTexture());
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, exposure[currentExposure].colorTexture());
+        glBindVertexArray(postVertexArray);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    void cleanup() {
+        if (!enabled) return;
+        glDeleteVertexArrays(1, &postVertexArray);
+        exposure[0].release();
+        exposure[1].release();
+        luminance.release();
+        if (histogramBuffer) glDeleteBuffers(1, &histogramBuffer);
+        postVertexArray = histogramBuffer = 0;
+        if (sharesPrograms) return;
+        glDeleteProgram(tonemapProgram);
+        glDeleteProgram(exposureProgram);
+        if (histogramProgram) glDeleteProgram(histogramProgram);
+        if (logLuminanceProgram) glDeleteProgram(logLuminanceProgram);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static const int STRIDE_LEVELS = 4;       // Sample strides 1, 2, 4 and 8
+    static const int MAX_LEVEL = 5;           // Then metering every 2nd and 4th frame
+    static const int LUMINANCE_SIZE = 256;    // Fallback log luminance target
+    static const int LUMINANCE_TOP_LEVEL = 8;
+
+    bool compute = false;
+    bool sharesPrograms = false;  // Programs belong to another window's pipeline
+    PFNGLDISPATCHCOMPUTEPROC_ dispatchCompute = nullptr;
+    PFNGLMEMORYBARRIERPROC_ memoryBarrier = nullptr;
+    PFNGLBINDIMAGETEXTUREPROC_ bindImageTexture = nullptr;
+
+    unsigned int postVertexArray = 0;
+    unsigned int tonemapProgram = 0, histogramProgram = 0, exposureProgram = 0, logLuminanceProgram = 0;
+    unsigned int histogramBuffer = 0;
+    RenderTarget exposure[2];  // 1x1; the fallback ping-pongs between them
+    RenderTarget luminance;    // Fallback only
+    int currentExposure = 0;
+
+    int strideLoc = -1, histogramMinLoc = -1, inverseRangeLoc = -1;
+    int exposureMinLoc = -1, rangeLoc = -1, keyLoc = -1, adaptationLoc = -1;
+    int minExposureLoc = -1, maxExposureLoc = -1, topLevelLoc = -1;
+
+    int level = 0;
+    int framesAtLevel = 0;
+    int framesSinceMetering = 0;
+    Clock::time_point lastMetering;
+    double costMs = 0.0;
+
+    void meterWithHistogram(const RenderTarget& scene, float adaptation, Profiler& profiler) {
+        int stride = sampleStride();
+        profiler.begin("luminance histogram");
+        glUseProgram(histogramProgram);
+        glUniform1i(strideLoc, stride);
+        glUniform1f(histogramMinLoc, minLogLuminance);
+        glUniform1f(inverseRangeLoc, 1.0f / logRange);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene.colorTexture());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, histogramBuffer);
+        GLuint groupsX = (GLuint)(((scene.width() + stride - 1) / stride + 15) / 16);
+        GLuint groupsY = (GLuint)(((scene.height() + stride - 1) / stride + 15) / 16);
+        dispatchCompute(groupsX, groupsY, 1);
+        profiler.end();
+
+        memoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        profiler.begin("exposure");
+        glUseProgram(exposureProgram);
+        setExposureUniforms(adaptation);
+        glUniform1f(exposureMinLoc, minLogLuminance);
+        glUniform1f(rangeLoc, logRange);
+        bindImageTexture(0, exposure[0].colorTexture(), 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32F);
+        dispatchCompute(1, 1, 1);
+        profiler.end();
+
+        // The tonemap samples the exposure; the next metering reads it and the bins
+        memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT |
+                      GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    void meterWithMips(const RenderTarget& scene, float adaptation, Profiler& profiler) {
+        profiler.begin("luminance mips");
+        luminance.bind();
+        glUseProgram(logLuminanceProgram);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene.colorTexture());
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindTexture(GL_TEXTURE_2D, luminance.colorTexture());
+        glGenerateMipmap(GL_TEXTURE_2D);
+        profiler.end();
+
+        profiler.begin("exposure");
+        int next = 1 - currentExposure;
+        exposure[next].bind();
+        glUseProgram(exposureProgram);
+        setExposureUniforms(adaptation);
+        glUniform1i(topLevelLoc, LUMINANCE_TOP_LEVEL);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, exposure[currentExposure].colorTexture());
+        glActiveTexture(GL_TEXTURE0);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        currentExposure = next;
+        profiler.end();
+    }
+
+    void setExposureUniforms(float adaptation) {
+        glUniform1f(keyLoc, keyValue);
+        glUniform1f(adaptationLoc, adaptation);
+        glUniform1f(minExposureLoc, minExposure);
+        glUniform1f(maxExposureLoc, maxExposure);
+    }
+
+    // Step the metering sparser when over budget, denser when the denser
+    // setting is predicted to fit. Waits for the profiler's results to
+    // catch up with the last step before taking another.
+    void keepToBudget(const Profiler& profiler) {
+        double meteringMs = profiler.lastGpuMs(compute ? "luminance histogram" : "luminance mips") +
+                            profiler.lastGpuMs("exposure");
+        double tonemapMs = profiler.lastGpuMs("tonemap");
+        costMs = tonemapMs + meteringMs / meteringInterval();
+
+        if (++framesAtLevel <= (Profiler::LATENCY + 1) * meteringInterval()) return;
+        int previous = level;
+        if (costMs > budgetMs && level < MAX_LEVEL) {
+            ++level;
+        } else if (level > 0) {
+            // A finer stride samples four times the pixels; metering more often, twice the passes
+            double denser = compute && level < STRIDE_LEVELS ? 4.0 : 2.0;
+            if (tonemapMs + meteringMs * denser / meteringInterval() < 0.8 * budgetMs) --level;
+        }
+        if (level == previous) return;
+        framesAtLevel = 0;
+        std::cout << "HDR metering: every " << sampleStride() << " pixel(s), every "
+                  << meteringInterval() << " frame(s) (post " << costMs << " ms, budget "
+                  << budgetMs << " ms)" << std::endl;
+    }
+
+    void findUniforms() {
+        if (compute) {
+            strideLoc = glGetUniformLocation(histogramProgram, "sampleStride");
+            histogramMinLoc = glGetUniformLocation(histogramProgram, "minLogLuminance");
+            inverseRangeLoc = glGetUniformLocation(histogramProgram, "inverseLogRange");
+            exposureMinLoc = glGetUniformLocation(exposureProgram, "minLogLuminance");
+            rangeLoc = glGetUniformLocation(exposureProgram, "logRange");
+        } else {
+            topLevelLoc = glGetUniformLocation(exposureProgram, "topLevel");
+        }
+        keyLoc = glGetUniformLocation(exposureProgram, "keyValue");
+        adaptationLoc = glGetUniformLocation(exposureProgram, "adaptation");
+        minExposureLoc = glGetUniformLocation(exposureProgram, "minExposure");
+        maxExposureLoc = glGetUniformLocation(exposureProgram, "maxExposure");
+    }
+
+    // Per-window state: this window's exposure and metering scratch
+    void createMeteringTargets() {
+        for (int i = 0; i < 2; ++i) {
+            exposure[i].colorFormat = GL_R32F;
+            exposure[i].allocate(1, 1);
+            exposure[i].bind();
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f);  // 0 takes the first metering as is
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        currentExposure = 0;
+
+        if (compute) {
+            unsigned int zeros[256] = {0};
+            glGenBuffers(1, &histogramBuffer);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogramBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(zeros), zeros, GL_DYNAMIC_COPY);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        } else {
+            luminance.colorFormat = GL_RG16F;
+            luminance.allocate(LUMINANCE_SIZE, LUMINANCE_SIZE);
+            glBindTexture(GL_TEXTURE_2D, luminance.colorTexture());
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+
+        level = framesAtLevel = framesSinceMetering = 0;
+        lastMetering = Clock::now();
+    }
+
+    // Post passes make their vertices from gl_VertexID
+    static unsigned int createPostVertexArray() {
+        unsigned int vertexArray = 0;
+        glGenVertexArrays(1, &vertexArray);
+        return vertexArray;
+    }
+
+    // Compute shaders need a 4.3 context; the entry points are loaded here
+    bool loadCompute() {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        if (major < 4 || (major == 4 && minor < 3)) return false;
+        dispatchCompute = (PFNGLDISPATCHCOMPUTEPROC_)glfwGetProcAddress("glDispatchCompute");
+        memoryBarrier = (PFNGLMEMORYBARRIERPROC_)glfwGetProcAddress("glMemoryBarrier");
+        bindImageTexture = (PFNGLBINDIMAGETEXTUREPROC_)glfwGetProcAddress("glBindImageTexture");
+        return dispatchCompute && memoryBarrier && bindImageTexture;
+    }
+};
+
+#endif // HDR_PIPELINE_H
@@ -0,0 +1,253 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+
+#include "shaders.h"
+#include "shader_utils.h"
+#include "profiler.h"
+#include "bitmap_font.h"
+
+// On-screen performance overlay: FPS, a frame-time graph, GPU time, draw
+// calls, triangles and memory. Text and graph are quads into one atlas
+// (glyph cells plus a solid cell for bars and the backdrop), uploaded to one
+// buffer and drawn with a single draw call. The text is only rebuilt a few
+// times a second; the graph every frame.
+//
+// The overlay times itself under the profiler scope "hud" and shows the
+// result, in red when over budgetMs.
+class Hud {
+public:
+    bool visible = true;
+    int scale = 2;                  // Screen pixels per font pixel
+    double refreshSeconds = 0.25;   // Text refresh interval
+    double graphMaxMs = 33.3;       // Top of the frame-time graph
+    double budgetMs = 0.1;          // Target for the overlay's own cost
+
+    static const int GRAPH_FRAMES = 120;
+
+    void init() {
+        shaderProgram = createShaderProgram(hudVertexShaderSource, hudFragmentShaderSource);
+        screenSizeLoc = glGetUniformLocation(shaderProgram, "screenSize");
+        atlasLoc = glGetUniformLocation(shaderProgram, "atlas");
+
+        // Atlas: 16 x 6 cells of CELL_W x CELL_H, glyphs 32-126 then one solid cell
+        std::vector<unsigned char> pixels(ATLAS_W * ATLAS_H, 0);
+        for (int c = 32; c <= 127; ++c) {
+            int cell = c - 32;
+            int x0 = (cell % 16) * CELL_W, y0 = (cell / 16) * CELL_H;
+            for (int y = 0; y < CELL_H; ++y) {
+                for (int x = 0; x < CELL_W; ++x) {
+                    bool on = c == 127 || (x < FONT_GLYPH_WIDTH && y < FONT_GLYPH_HEIGHT && (fontGlyph(c)[x] >> y) & 1);
+                    pixels[(y0 + y) * ATLAS_W + x0 + x] = on ? 255 : 0;
+                }
+            }
+        }
+        glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_W, ATLAS_H, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        // Vertex: position (pixels), atlas uv, color
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(4 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+
+        lastRefresh = Clock::now();
+    }
+
+    // Call once per frame with the frame's wall time
+    void recordFrame(double frameSeconds) {
+        frameMs[graphHead] = (float)(frameSeconds * 1000.0);
+        graphHead = (graphHead + 1) % GRAPH_FRAMES;
+        if (graphFilled < GRAPH_FRAMES) ++graphFilled;
+        secondsSinceRefresh += frameSeconds;
+        framesSinceRefresh++;
+    }
+
+    // Draw over whatever is in the bound framebuffer (width x height pixels)
+    void draw(int width, int height, Profiler& profiler, const FrameStats& stats) {
+        if (!visible || width <= 0 || height <= 0) return;
+        profiler.begin("hud");
+
+        double sinceRefresh = std::chrono::duration<double>(Clock::now() - lastRefresh).count();
+        if (textVertices.empty() || sinceRefresh >= refreshSeconds) {
+            rebuildText(profiler, stats);
+            lastRefresh = Clock::now();
+        }
+
+        // Text and backdrop are cached; the graph is appended fresh
+        vertices.assign(textVertices.begin(), textVertices.end());
+        appendGraph();
+
+        glViewport(0, 0, width, height);  // The scene may have left a smaller view set
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glUseProgram(shaderProgram);
+        glUniform2f(screenSizeLoc, (float)width, (float)height);
+        glUniform1i(atlasLoc, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        size_t bytes = vertices.size() * sizeof(float);
+        if (bytes > bufferBytes) {
+            bufferBytes = bytes * 2;
+            glBufferData(GL_ARRAY_BUFFER, bufferBytes, NULL, GL_STREAM_DRAW);
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, vertices.data());
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(vertices.size() / 8));
+        glBindVertexArray(0);
+
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        profiler.end();
+    }
+
+    void cleanup() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteTextures(1, &atlasTexture);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static const int CELL_W = 6, CELL_H = 8;
+    static const int ATLAS_W = 16 * CELL_W, ATLAS_H = 6 * CELL_H;
+    static const int SOLID = 127;  // Atlas cell that is fully lit
+    static const int MARGIN = 8;
+    static const int GRAPH_HEIGHT = 48;
+
+    unsigned int shaderProgram = 0, atlasTexture = 0;
+    unsigned int VAO = 0, VBO = 0;
+    int screenSizeLoc = -1, atlasLoc = -1;
+    size_t bufferBytes = 0;
+
+    std::vector<float> textVertices;
+    std::vector<float> vertices;
+    float frameMs[GRAPH_FRAMES] = {0.0f};
+    int graphHead = 0, graphFilled = 0;
+    int textLines = 0;
+    float graphTop = 0.0f;
+    double secondsSinceRefresh = 0.0;
+    int framesSinceRefresh = 0;
+    Clock::time_point lastRefresh;
+
+    void rebuildText(const Profiler& profiler, const FrameStats& stats) {
+        double fps = secondsSinceRefresh > 0.0 ? framesSinceRefresh / secondsSinceRefresh : 0.0;
+        double averageMs = framesSinceRefresh > 0 ? secondsSinceRefresh * 1000.0 / framesSinceRefresh : 0.0;
+        secondsSinceRefresh = 0.0;
+        framesSinceRefresh = 0;
+
+        double hudCpu = profiler.lastCpuMs("hud");
+        double hudGpu = profiler.lastGpuMs("hud");
+
+        char lines[5][96];
+        snprintf(lines[0], sizeof(lines[0]), "FPS %5.1f  frame %6.2f ms", fps, averageMs);
+        snprintf(lines[1], sizeof(lines[1]), "GPU %6.2f ms", profiler.lastFrameGpuMs());
+        snprintf(lines[2], sizeof(lines[2]), "draws %d  tris %lld  culled %lld",
+                 stats.drawCalls, stats.trianglesDrawn, stats.trianglesCulled);
+        snprintf(lines[3], sizeof(lines[3]), "RSS %.1f MB", residentMegabytes());
+        snprintf(lines[4], sizeof(lines[4]), "HUD cpu %.3f gpu %.3f ms", hudCpu, hudGpu);
+        textLines = 5;
+
+        textVertices.clear();
+        int columns = 0;
+        for (int l = 0; l < textLines; ++l) columns = std::max(columns, (int)strlen(lines[l]));
+        float lineHeight = (float)(CELL_H * scale + 2);
+        float panelWidth = std::max((float)(columns * CELL_W * scale), (float)(GRAPH_FRAMES * scale));
+        float panelHeight = textLines * lineHeight + GRAPH_HEIGHT * scale / 2 + 6.0f;
+        appendQuad(textVertices, MARGIN - 4.0f, MARGIN - 4.0f, panelWidth + 8.0f, panelHeight + 8.0f,
+                   SOLID, 0.0f, 0.0f, 0.0f, 0.55f);
+
+        const float white[4] = {0.9f, 0.95f, 1.0f, 1.0f};
+        const float red[4] = {1.0f, 0.3f, 0.25f, 1.0f};
+        for (int l = 0; l < textLines; ++l) {
+            bool overBudget = l == 4 && (hudCpu > budgetMs || hudGpu > budgetMs);
+            const float* color = overBudget ? red : white;
+            float x = (float)MARGIN, y = MARGIN + l * lineHeight;
+            for (const char* c = lines[l]; *c; ++c, x += CELL_W * scale) {
+                if (*c == ' ') continue;
+                appendQuad(textVertices, x, y, (float)(CELL_W * scale), (float)(CELL_H * scale),
+                           *c, color[0], color[1], color[2], color[3]);
+            }
+        }
+        graphTop = MARGIN + textLines * lineHeight + 4.0f;
+    }
+
+    // One bar per frame, oldest on the left, with a 60 Hz reference line
+    void appendGraph() {
+        float height = (float)(GRAPH_HEIGHT * scale / 2);
+        float bottom = graphTop + height;
+        float pixelsPerMs = height / (float)graphMaxMs;
+        float barWidth = (float)scale;
+
+        appendQuad(vertices, (float)MARGIN, bottom - 16.67f * pixelsPerMs, GRAPH_FRAMES * barWidth, 1.0f,
+                   SOLID, 0.4f, 0.8f, 0.4f, 0.8f);
+        for (int i = 0; i < graphFilled; ++i) {
+            int index = (graphHead - graphFilled + i + GRAPH_FRAMES) % GRAPH_FRAMES;
+            float ms = std::min(frameMs[index], (float)graphMaxMs);
+            float barHeight = std::max(1.0f, ms * pixelsPerMs);
+            bool slow = frameMs[index] > 16.67f;
+            appendQuad(vertices, MARGIN + i * barWidth, bottom - barHeight, barWidth, barHeight, SOLID,
+                       slow ? 1.0f : 0.5f, slow ? 0.5f : 0.8f, slow ? 0.2f : 1.0f, 0.9f);
+        }
+    }
+
+    // Two triangles covering a glyph cell (or the solid cell) at x, y, w, h pixels
+    static void appendQuad(std::vector<float>& out, float x, float y, float w, float h, int glyph,
+                           float r, float g, float b, float a) {
+        int cell = glyph - 32;
+        float u0 = (float)((cell % 16) * CELL_W) / ATLAS_W;
+        float v0 = (float)((cell / 16) * CELL_H) / ATLAS_H;
+        float u1 = u0 + (float)CELL_W / ATLAS_W;
+        float v1 = v0 + (float)CELL_H / ATLAS_H;
+        const float corners[6][4] = {
+            {x, y, u0, v0}, {x + w, y, u1, v0}, {x + w, y + h, u1, v1},
+            {x, y, u0, v0}, {x + w, y + h, u1, v1}, {x, y + h, u0, v1},
+        };
+        for (int i = 0; i < 6; ++i) {
+            const float vertex[8] = {corners[i][0], corners[i][1], corners[i][2], corners[i][3], r, g, b, a};
+            out.insert(out.end(), vertex, vertex + 8);
+        }
+    }
+
+    // Resident set size from /proc, 0 where that is not available
+    static double residentMegabytes() {
+        FILE* file = fopen("/proc/self/statm", "r");
+        if (!file) return 0.0;
+        long pages = 0, resident = 0;
+        int read = fscanf(file, "%ld %ld", &pages, &resident);
+        fclose(file);
+        if (read != 2) return 0.0;
+        return resident * (double)sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+    }
+};
+
+#endif // HUD_H
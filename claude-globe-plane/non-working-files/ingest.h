@@ -0,0 +1,513 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <glm/glm.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "fleet.h"
+
+// Wire format for live positions, native (little-endian) byte order since
+// both ends are on the same host. A stream is a sequence of batches: one
+// header followed by `count` records.
+const uint32_t INGEST_MAGIC = 0x44505550;  // "PUPD"
+const uint32_t INGEST_MAX_BATCH = 65536;   // Records per wire batch
+
+struct IngestBatchHeader {
+    uint32_t magic;
+    uint32_t count;
+    uint64_t sentNanos;   // steady_clock (CLOCK_MONOTONIC) when the sender flushed
+};
+
+struct IngestRecord {
+    uint32_t aircraft;    // Fleet index
+    float latitude;       // Degrees
+    float longitude;      // Degrees
+    float altitude;       // Meters above the surface
+    float heading;        // Degrees clockwise from north
+    float groundSpeed;    // m/s
+};
+
+static_assert(sizeof(IngestBatchHeader) == 16 && sizeof(IngestRecord) == 24, "ingest wire layout");
+
+// Finite and within the ranges the flight model can hold; anything else
+// would reach the fleet arrays, the aircraft BVH and the renderer
+inline bool ingestRecordValid(const IngestRecord& r) {
+    return std::isfinite(r.latitude) && std::isfinite(r.longitude) && std::isfinite(r.altitude) &&
+           std::isfinite(r.heading) && std::isfinite(r.groundSpeed) &&
+           fabsf(r.latitude) <= 90.0f && fabsf(r.longitude) <= 180.0f &&
+           r.altitude >= -500.0f && r.altitude <= 100000.0f &&
+           r.groundSpeed >= 0.0f && r.groundSpeed <= 1000.0f;
+}
+
+inline uint64_t ingestClockNanos() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Unbounded multi-producer, single-consumer queue of intrusive nodes
+// (Vyukov). push is one atomic exchange and never blocks; pop is
+// consumer-only and returns null when empty or when a push is halfway done.
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(&stub), tail(&stub) { stub.next.store(nullptr, std::memory_order_relaxed); }
+
+    void push(T* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        T* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    T* pop() {
+        T* first = tail;
+        T* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (!next) return nullptr;
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return first;
+        }
+        if (first != head.load(std::memory_order_acquire)) return nullptr;  // Producer mid-push
+        push(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return first;
+        }
+        return nullptr;
+    }
+
+private:
+    T stub;
+    std::atomic<T*> head;  // Producers
+    T* tail;               // Consumer
+};
+
+// Decoded updates ready to store into the fleet, converted off the render thread
+struct IngestBatch {
+    struct Update {
+        uint32_t aircraft;
+        float position[3];   // Globe units
+        float axis[3];       // Great-circle axis
+        float altitude, groundSpeed, angularSpeed;
+    };
+
+    std::atomic<IngestBatch*> next;
+    std::vector<Update> updates;
+    uint64_t oldestSentNanos = 0;
+};
+
+// Receives live aircraft positions on a Unix domain socket and hands them to
+// the render thread. One thread runs an epoll loop over the listening socket
+// and every client, decodes records into batches, and pushes full batches (or
+// partial ones once the sockets are drained) onto an MPSC queue. The render
+// thread calls apply() at tick boundaries to drain the queue into the fleet,
+// so the fleet is only ever written by the thread that reads it.
+//
+// Backpressure: once maxQueuedBatches are waiting the thread stops reading,
+// the kernel buffers fill and senders block, which bounds memory and latency.
+class IngestService {
+public:
+    size_t batchSize = 4096;         // Updates per queued batch
+    size_t maxQueuedBatches = 1024;
+    void (*onQueued)() = nullptr;    // Called on the ingest thread after each batch is queued
+
+    IngestService() {}
+    ~IngestService() { stop(); }
+
+    // metersPerUnit must match the fleet's
+    bool start(const char* socketPath, double metersPerUnit) {
+        stop();
+        unitsPerMeter = 1.0 / metersPerUnit;
+        path = socketPath;
+
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (listenFd < 0 || path.size() >= sizeof(address.sun_path)) {
+            std::cerr << "Failed to create ingest socket: " << path << std::endl;
+            closeAll();
+            return false;
+        }
+        strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        unlink(path.c_str());  // Stale socket from an earlier run
+        if (bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 8) != 0) {
+            std::cerr << "Failed to listen on " << path << ": " << strerror(errno) << std::endl;
+            closeAll();
+            return false;
+        }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (epollFd < 0 || wakeFd < 0) {
+            closeAll();
+            return false;
+        }
+        watch(listenFd, &listenFd);
+        watch(wakeFd, &wakeFd);
+
+        stopping.store(false);
+        worker = std::thread(&IngestService::workerLoop, this);
+        return true;
+    }
+
+    void stop() {
+        if (worker.joinable()) {
+            stopping.store(true);
+            uint64_t one = 1;
+            if (write(wakeFd, &one, sizeof(one)) < 0) {}
+            worker.join();
+        }
+        closeAll();
+        while (IngestBatch* batch = queue.pop()) delete batch;
+        queued.store(0);
+    }
+
+    // Render thread, between ticks: store the queued updates into the fleet.
+    // Only batches queued before the call are taken, so a fast sender cannot
+    // stretch the tick. Returns the number applied.
+    size_t apply(Fleet& fleet) {
+        size_t applied = 0;
+        uint64_t now = ingestClockNanos();
+        size_t available = queued.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < available; ++b) {
+            IngestBatch* batch = queue.pop();
+            if (!batch) break;
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            for (const IngestBatch::Update& u : batch->updates) {
+                if (u.aircraft >= fleet.size()) {
+                    ++stats.rejected;
+                    continue;
+                }
+                size_t i = u.aircraft;
+                fleet.posX[i] = u.position[0];
+                fleet.posY[i] = u.position[1];
+                fleet.posZ[i] = u.position[2];
+                fleet.axisX[i] = u.axis[0];
+                fleet.axisY[i] = u.axis[1];
+                fleet.axisZ[i] = u.axis[2];
+                fleet.altitude[i] = u.altitude;
+                fleet.groundSpeed[i] = u.groundSpeed;
+                fleet.angularSpeed[i] = u.angularSpeed;
+                ++applied;
+            }
+            double latencyMs = now > batch->oldestSentNanos ? (now - batch->oldestSentNanos) * 1e-6 : 0.0;
+            stats.maxLatencyMs = std::max(stats.maxLatencyMs, latencyMs);
+            stats.latencyMsSum += latencyMs;
+            ++stats.batches;
+            delete batch;
+        }
+        stats.applied += applied;
+        return applied;
+    }
+
+    struct Stats {
+        uint64_t applied = 0;
+        uint64_t rejected = 0;      // Unknown aircraft index
+        uint64_t batches = 0;
+        double latencyMsSum = 0.0;  // Send to apply, per batch (oldest record)
+        double maxLatencyMs = 0.0;
+    };
+
+    // Since the last reset; render thread only
+    const Stats& statistics() const { return stats; }
+    void resetStatistics() { stats = Stats(); }
+
+    uint64_t protocolErrors() const { return errors.load(std::memory_order_relaxed); }
+    uint64_t invalidRecords() const { return invalid.load(std::memory_order_relaxed); }
+    size_t connectionCount() const { return clientCount.load(std::memory_order_relaxed); }
+
+    // Print throughput and latency every interval seconds while updates arrive
+    void report(double intervalSeconds) {
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastReport).count();
+        if (elapsed < intervalSeconds) return;
+        uint64_t invalidTotal = invalidRecords(), newInvalid = invalidTotal - invalidReported;
+        if (stats.batches > 0 || newInvalid > 0) {
+            std::cout << "Ingest: " << (uint64_t)(stats.applied / elapsed) << " updates/s from "
+                      << connectionCount() << " connection(s)";
+            if (stats.batches > 0) {
+                std::cout << ", latency avg " << stats.latencyMsSum / stats.batches
+                          << " ms, max " << stats.maxLatencyMs << " ms";
+            }
+            if (stats.rejected) std::cout << ", " << stats.rejected << " unknown aircraft";
+            if (newInvalid) std::cout << ", " << newInvalid << " invalid record(s) dropped";
+            std::cout << std::endl;
+        }
+        invalidReported = invalidTotal;
+        resetStatistics();
+        lastReport = std::chrono::steady_clock::now();
+    }
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::vector<char> buffer;   // Received bytes not yet decoded
+        size_t used = 0;
+    };
+
+    std::string path;
+    double unitsPerMeter = 1.0;
+    int listenFd = -1, epollFd = -1, wakeFd = -1;
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> clientCount{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> invalid{0};  // Records dropped by ingestRecordValid
+    MpscQueue<IngestBatch> queue;
+
+    // Render thread
+    Stats stats;
+    uint64_t invalidReported = 0;
+    std::chrono::steady_clock::time_point lastReport = std::chrono::steady_clock::now();
+
+    // Worker thread
+    std::vector<Connection*> connections;
+    IngestBatch* pending = nullptr;
+
+    // tag comes back from epoll: a Connection, or the address of listenFd / wakeFd
+    void watch(int fd, void* tag) {
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = tag;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    void closeAll() {
+        for (Connection* c : connections) {
+            close(c->fd);
+            delete c;
+        }
+        connections.clear();
+        clientCount.store(0);
+        delete pending;
+        pending = nullptr;
+        if (listenFd >= 0) {
+            close(listenFd);
+            unlink(path.c_str());
+        }
+        if (epollFd >= 0) close(epollFd);
+        if (wakeFd >= 0) close(wakeFd);
+        listenFd = epollFd = wakeFd = -1;
+    }
+
+    void workerLoop() {
+        epoll_event events[64];
+        while (!stopping.load(std::memory_order_relaxed)) {
+            // Backpressure: leave data in the kernel until the render thread catches up
+            if (queued.load(std::memory_order_relaxed) >= maxQueuedBatches) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                continue;
+            }
+
+            // Sleep until a socket has data or stop() writes the wake eventfd
+            int ready = epoll_wait(epollFd, events, 64, -1);
+            for (int e = 0; e < ready; ++e) {
+                void* tag = events[e].data.ptr;
+                if (tag == &wakeFd) return;
+                if (tag == &listenFd) {
+                    acceptClients();
+                } else {
+                    Connection* c = (Connection*)tag;
+                    if (!receive(*c)) disconnect(c);
+                }
+            }
+
+            // Sockets drained: hand over what we have rather than wait for a full batch
+            flush();
+        }
+    }
+
+    void acceptClients() {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            Connection* c = new Connection();
+            c->fd = fd;
+            c->buffer.resize(1 << 18);
+            connections.push_back(c);
+            clientCount.store(connections.size(), std::memory_order_relaxed);
+            watch(fd, c);
+        }
+    }
+
+    void disconnect(Connection* c) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, c->fd, nullptr);
+        close(c->fd);
+        connections.erase(std::find(connections.begin(), connections.end(), c));
+        clientCount.store(connections.size(), std::memory_order_relaxed);
+        delete c;
+    }
+
+    // Read and decode complete batches; false to drop the client. A busy
+    // client gets a bounded number of reads so the loop comes back around to
+    // flush and to check for backpressure.
+    bool receive(Connection& c) {
+        for (int reads = 0; reads < 16; ++reads) {
+            if (c.used == c.buffer.size()) c.buffer.resize(c.buffer.size() * 2);
+            ssize_t n = read(c.fd, c.buffer.data() + c.used, c.buffer.size() - c.used);
+            if (n == 0) return false;
+            if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            c.used += (size_t)n;
+
+            size_t offset = 0;
+            while (c.used - offset >= sizeof(IngestBatchHeader)) {
+                IngestBatchHeader header;
+                memcpy(&header, c.buffer.data() + offset, sizeof(header));
+                if (header.magic != INGEST_MAGIC || header.count > INGEST_MAX_BATCH) {
+                    errors.fetch_add(1, std::memory_order_relaxed);
+                    std::cerr << "Ingest: bad batch header, closing connection" << std::endl;
+                    return false;
+                }
+                size_t bytes = sizeof(header) + header.count * sizeof(IngestRecord);
+                if (c.used - offset < bytes) break;
+                decode(c.buffer.data() + offset + sizeof(header), header.count, header.sentNanos);
+                offset += bytes;
+            }
+            if (offset > 0) {
+                memmove(c.buffer.data(), c.buffer.data() + offset, c.used - offset);
+                c.used -= offset;
+            }
+        }
+        return true;
+    }
+
+    void decode(const char* data, uint32_t count, uint64_t sentNanos) {
+        const float degrees = (float)(M_PI / 180.0);
+        for (uint32_t r = 0; r < count; ++r) {
+            IngestRecord record;
+            memcpy(&record, data + r * sizeof(IngestRecord), sizeof(record));
+            if (!ingestRecordValid(record)) {
+                invalid.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (!pending) {
+                pending = new IngestBatch();
+                pending->updates.reserve(batchSize);
+                pending->oldestSentNanos = sentNanos;
+            }
+
+            // Same lat/lon convention as surfaceToLatLon: y up, lon = atan2(z, x)
+            float sinLat = sinf(record.latitude * degrees), cosLat = cosf(record.latitude * degrees);
+            float sinLon = sinf(record.longitude * degrees), cosLon = cosf(record.longitude * degrees);
+            float sinHeading = sinf(record.heading * degrees), cosHeading = cosf(record.heading * degrees);
+            glm::vec3 up(cosLat * cosLon, sinLat, cosLat * sinLon);
+            glm::vec3 north(-sinLat * cosLon, cosLat, -sinLat * sinLon);
+            glm::vec3 east(-sinLon, 0.0f, cosLon);
+            glm::vec3 forward = north * cosHeading + east * sinHeading;
+            glm::vec3 axis = glm::cross(up, forward);  // Fleet::getForward is cross(axis, position)
+
+            IngestBatch::Update u;
+            u.aircraft = record.aircraft;
+            u.altitude = 1.0f + (float)(record.altitude * unitsPerMeter);
+            u.position[0] = up.x * u.altitude;
+            u.position[1] = up.y * u.altitude;
+            u.position[2] = up.z * u.altitude;
+            u.axis[0] = axis.x;
+            u.axis[1] = axis.y;
+            u.axis[2] = axis.z;
+            u.groundSpeed = record.groundSpeed;
+            u.angularSpeed = (float)(record.groundSpeed * unitsPerMeter) / u.altitude;
+            pending->updates.push_back(u);
+
+            if (pending->updates.size() >= batchSize) flush();
+        }
+    }
+
+    void flush() {
+        if (!pending || pending->updates.empty()) return;
+        queued.fetch_add(1, std::memory_order_relaxed);
+        queue.push(pending);
+        pending = nullptr;
+        if (onQueued) onQueued();
+    }
+};
+
+// Sending side, for the generator and tests: blocking writes of whole batches
+class IngestClient {
+public:
+    ~IngestClient() { close(); }
+
+    bool connect(const char* socketPath) {
+        close();
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (strlen(socketPath) >= sizeof(address.sun_path)) return false;
+        strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0 || ::connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    // Stamp and send one batch; false once the connection is gone
+    bool send(const IngestRecord* records, uint32_t count) {
+        IngestBatchHeader header;
+        header.magic = INGEST_MAGIC;
+        header.count = count;
+        header.sentNanos = ingestClockNanos();
+        iovec parts[2];
+        parts[0].iov_base = &header;
+        parts[0].iov_len = sizeof(header);
+        parts[1].iov_base = (void*)records;
+        parts[1].iov_len = count * sizeof(IngestRecord);
+
+        int first = 0;
+        while (first < 2) {
+            msghdr message;
+            memset(&message, 0, sizeof(message));
+            message.msg_iov = parts + first;
+            message.msg_iovlen = 2 - first;
+            ssize_t n = sendmsg(fd, &message, MSG_NOSIGNAL);  // EPIPE instead of SIGPIPE
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            // Skip past what was written
+            size_t written = (size_t)n;
+            while (first < 2 && written >= parts[first].iov_len) written -= parts[first++].iov_len;
+            if (first < 2) {
+                parts[first].iov_base = (char*)parts[first].iov_base + written;
+                parts[first].iov_len -= written;
+            }
+        }
+        return true;
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+private:
+    int fd = -1;
+};
+
+#endif // INGEST_H
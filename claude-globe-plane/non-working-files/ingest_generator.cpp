@@ -0,0 +1,119 @@
+// Stand-in for the data-fusion process: streams synthetic aircraft positions
+// to the viewer's ingest socket
+//
+// Usage: ingest_generator [--socket PATH] [--aircraft N] [--rate UPDATES_PER_SECOND]
+//                         [--batch N] [--seconds N]
+//
+// Aircraft fly great circles at cruise altitude; each update moves one of
+// them along. --rate 0 sends as fast as the socket takes it.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "ingest.h"
+
+struct Track {
+    double latitude, longitude, heading;  // Radians
+    float altitude, speed;
+};
+
+// Advance a track along its great circle by distance (radians of arc)
+void advance(Track& t, double distance) {
+    double sinLat = sin(t.latitude), cosLat = cos(t.latitude);
+    double sinD = sin(distance), cosD = cos(distance);
+    double latitude = asin(sinLat * cosD + cosLat * sinD * cos(t.heading));
+    double longitude = t.longitude + atan2(sin(t.heading) * sinD * cosLat, cosD - sinLat * sin(latitude));
+    // Heading at the new point, from the bearing back to where we came from
+    double back = atan2(sin(t.longitude - longitude) * cosLat,
+                        cos(latitude) * sinLat - sin(latitude) * cosLat * cos(t.longitude - longitude));
+    t.latitude = latitude;
+    t.longitude = remainder(longitude, 2.0 * M_PI);
+    t.heading = remainder(back + M_PI, 2.0 * M_PI);
+}
+
+int main(int argc, char** argv) {
+    std::string socketPath = "/tmp/plane_sim_ingest.sock";
+    size_t aircraft = 2000;
+    double rate = 100000.0;
+    uint32_t batch = 1024;
+    double seconds = 10.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) socketPath = argv[++i];
+        else if (arg == "--aircraft" && hasValue) aircraft = std::max(1, atoi(argv[++i]));
+        else if (arg == "--rate" && hasValue) rate = atof(argv[++i]);
+        else if (arg == "--batch" && hasValue) batch = (uint32_t)std::min(std::max(1, atoi(argv[++i])), (int)INGEST_MAX_BATCH);
+        else if (arg == "--seconds" && hasValue) seconds = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--socket PATH] [--aircraft N] [--rate UPDATES_PER_SECOND]"
+                      << " [--batch N] [--seconds N]" << std::endl;
+            return 1;
+        }
+    }
+
+    IngestClient client;
+    if (!client.connect(socketPath.c_str())) {
+        std::cerr << "Cannot connect to " << socketPath << std::endl;
+        return 1;
+    }
+
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Track> tracks(aircraft);
+    for (Track& t : tracks) {
+        t.latitude = asin(2.0 * unit(rng) - 1.0);
+        t.longitude = (2.0 * unit(rng) - 1.0) * M_PI;
+        t.heading = unit(rng) * 2.0 * M_PI;
+        t.altitude = 9000.0f + 3000.0f * (float)unit(rng);
+        t.speed = 200.0f + 60.0f * (float)unit(rng);
+    }
+
+    // Each aircraft is updated about rate / aircraft times a second
+    const double radius = EARTH_MEAN_RADIUS;
+    const double updateInterval = rate > 0.0 ? aircraft / rate : 0.1;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now(), lastPrint = start;
+    std::vector<IngestRecord> records(batch);
+    uint64_t sent = 0, sentAtPrint = 0;
+    size_t next = 0;
+    while (std::chrono::duration<double>(Clock::now() - start).count() < seconds) {
+        for (uint32_t r = 0; r < batch; ++r) {
+            Track& t = tracks[next];
+            advance(t, t.speed * updateInterval / radius);
+            IngestRecord& record = records[r];
+            record.aircraft = (uint32_t)next;
+            record.latitude = (float)(t.latitude * 180.0 / M_PI);
+            record.longitude = (float)(t.longitude * 180.0 / M_PI);
+            record.altitude = t.altitude;
+            record.heading = (float)(t.heading * 180.0 / M_PI);
+            record.groundSpeed = t.speed;
+            next = (next + 1) % aircraft;
+        }
+        if (!client.send(records.data(), batch)) {
+            std::cerr << "Connection closed" << std::endl;
+            return 1;
+        }
+        sent += batch;
+
+        if (rate > 0.0) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(sent / rate)));
+        }
+        double sincePrint = std::chrono::duration<double>(Clock::now() - lastPrint).count();
+        if (sincePrint >= 1.0) {
+            std::cout << (uint64_t)((sent - sentAtPrint) / sincePrint) << " updates/s" << std::endl;
+            sentAtPrint = sent;
+            lastPrint = Clock::now();
+        }
+    }
+    std::cout << "Sent " << sent << " updates" << std::endl;
+    return 0;
+}
@@ -0,0 +1,415 @@
+#ifndef LABEL_RENDERER_H
+#define LABEL_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include "fleet.h"
+#include "camera.h"
+#include "bitmap_font.h"
+#include "shaders.h"
+#include "shader_utils.h"
+
+// One label as the GPU sees it: top-left corner of the text in pixels and
+// up to 8 characters packed four to a word. A length of 0 hides the label.
+struct LabelInstance {
+    float x = 0.0f, y = 0.0f;
+    uint32_t length = 0;
+    uint32_t text[2] = {0, 0};
+};
+
+// CPU side of the callsign labels: projects every aircraft, hides those off
+// screen or behind the globe, and declutters the rest so no two labels
+// overlap. Labels that held their place last frame are placed first, which
+// keeps the set stable as the view moves.
+//
+// Updates are incremental. A label only moves once its aircraft has drifted
+// moveThreshold pixels from where the label was drawn, and if no label moved
+// or changed visibility the whole pass stops after projecting. Instances are
+// kept one slot per aircraft so only the changed range needs uploading.
+class LabelLayout {
+public:
+    float fontScale = 2.0f;      // Screen pixels per font pixel
+    float moveThreshold = 0.5f;  // Pixels an anchor may drift before its label follows
+    float spacing = 2.0f;        // Minimum gap between labels, pixels
+    glm::vec2 offset = glm::vec2(6.0f, -4.0f);  // Text corner from the aircraft, pixels (bottom left)
+
+    // priority is a fleet index placed before all others (e.g. the selected aircraft), or -1
+    void update(const Fleet& fleet, const RenderView& view, const glm::mat4& viewProjection,
+                int width, int height, int priority = -1) {
+        const size_t n = fleet.size();
+        dirtyFirst = n;
+        dirtyLast = 0;
+        moved = 0;
+
+        bool relayout = false;
+        if (n != instanceList.size()) {
+            resize(n);
+            relayout = true;
+        }
+        if (width != lastWidth || height != lastHeight) {
+            lastWidth = width;
+            lastHeight = height;
+            relayout = true;
+        }
+        if (fontScale != widthScale) {
+            // Label scale reloaded or the window changed content scale
+            widthScale = fontScale;
+            for (size_t i = 0; i < n; ++i) textWidth[i] = text[i].length * (FONT_GLYPH_WIDTH + 1) * fontScale;
+            relayout = true;
+        }
+
+        // Horizon test against the planet sphere, in meters
+        const double radius = view.planetRadius;
+        const double metersPerUnit = fleet.metersPerUnit;
+        const double eyeOutside = glm::dot(view.eye, view.eye) - radius * radius;
+        const float textHeight = FONT_GLYPH_HEIGHT * fontScale;
+
+        for (size_t i = 0; i < n; ++i) {
+            glm::dvec3 position(fleet.posX[i], fleet.posY[i], fleet.posZ[i]);
+            position *= metersPerUnit;
+
+            bool onScreen = true;
+            if (eyeOutside > 0.0) {
+                glm::dvec3 d = position - view.eye;
+                double a = glm::dot(d, d), b = glm::dot(view.eye, d);
+                double discriminant = b * b - a * eyeOutside;
+                if (b < 0.0 && discriminant > 0.0) onScreen = (-b - sqrt(discriminant)) >= a;
+            }
+
+            float sx = 0.0f, sy = 0.0f;
+            if (onScreen) {
+                glm::vec4 clip = viewProjection * glm::vec4(view.relative(position), 1.0f);
+                onScreen = clip.w > 0.0f;
+                if (onScreen) {
+                    sx = (clip.x / clip.w * 0.5f + 0.5f) * width;
+                    sy = (0.5f - clip.y / clip.w * 0.5f) * height;
+                    float left = sx + offset.x, bottom = sy + offset.y;
+                    onScreen = left >= 0.0f && bottom - textHeight >= 0.0f &&
+                               left + textWidth[i] <= width && bottom <= height;
+                }
+            }
+
+            if (onScreen != (visible[i] != 0)) {
+                visible[i] = onScreen;
+                relayout = true;
+            }
+            if (onScreen && (fabsf(sx - anchorX[i]) >= moveThreshold || fabsf(sy - anchorY[i]) >= moveThreshold)) {
+                anchorX[i] = sx;
+                anchorY[i] = sy;
+                ++moved;
+                relayout = true;
+            }
+        }
+        if (!relayout) return;
+
+        // Declutter: the priority label, then last frame's labels, then the rest
+        resetGrid(width, height);
+        std::swap(placed, wasPlaced);
+        std::fill(placed.begin(), placed.end(), (unsigned char)0);
+        if (priority >= 0 && (size_t)priority < n && visible[priority]) tryPlace(priority);
+        for (size_t i = 0; i < n; ++i) {
+            if (visible[i] && wasPlaced[i] && !placed[i]) tryPlace(i);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            if (visible[i] && !wasPlaced[i] && !placed[i]) tryPlace(i);
+        }
+
+        // Rewrite only the instances whose label appeared, vanished or moved
+        shown = 0;
+        for (size_t i = 0; i < n; ++i) {
+            LabelInstance& instance = instanceList[i];
+            float x = anchorX[i] + offset.x, y = anchorY[i] + offset.y - textHeight;
+            uint32_t length = placed[i] ? text[i].length : 0;
+            if (placed[i]) ++shown;
+            if (instance.length == length && (length == 0 || (instance.x == x && instance.y == y))) continue;
+            instance.x = x;
+            instance.y = y;
+            instance.length = length;
+            dirtyFirst = std::min(dirtyFirst, i);
+            dirtyLast = std::max(dirtyLast, i + 1);
+        }
+    }
+
+    const std::vector<LabelInstance>& instances() const { return instanceList; }
+
+    // Instances changed by the last update: [dirtyBegin, dirtyEnd), empty if equal
+    size_t dirtyBegin() const { return std::min(dirtyFirst, dirtyLast); }
+    size_t dirtyEnd() const { return dirtyLast; }
+
+    size_t visibleCount() const { return shown; }
+    size_t movedCount() const { return moved; }
+
+private:
+    static const int CELL_SIZE = 64;  // Declutter grid cell, pixels
+
+    struct Text {
+        uint32_t length = 0;
+        uint32_t words[2] = {0, 0};
+    };
+
+    struct Rect {
+        float x0, y0, x1, y1;
+    };
+
+    std::vector<LabelInstance> instanceList;
+    std::vector<Text> text;
+    std::vector<float> textWidth;
+    float widthScale = 0.0f;  // fontScale that textWidth was computed with
+    std::vector<float> anchorX, anchorY;  // Where each label is currently drawn from
+    std::vector<unsigned char> visible, placed, wasPlaced;
+    size_t dirtyFirst = 0, dirtyLast = 0;
+    size_t shown = 0, moved = 0;
+    int lastWidth = 0, lastHeight = 0;
+
+    // Grid of singly linked lists of placed rectangles
+    int gridWidth = 0, gridHeight = 0;
+    std::vector<int> cellHead;
+    std::vector<int> nodeNext, nodeRect;
+    std::vector<Rect> rects;
+
+    void resize(size_t n) {
+        instanceList.assign(n, LabelInstance());
+        text.assign(n, Text());
+        textWidth.assign(n, 0.0f);
+        anchorX.assign(n, -1e9f);
+        anchorY.assign(n, -1e9f);
+        visible.assign(n, 0);
+        placed.assign(n, 0);
+        wasPlaced.assign(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            char callsign[8];
+            Fleet::callsign(i, callsign);
+            Text& t = text[i];
+            for (; t.length < 8 && callsign[t.length]; ++t.length) {
+                t.words[t.length / 4] |= (uint32_t)(unsigned char)callsign[t.length] << (8 * (t.length % 4));
+            }
+            instanceList[i].text[0] = t.words[0];
+            instanceList[i].text[1] = t.words[1];
+            textWidth[i] = t.length * (FONT_GLYPH_WIDTH + 1) * fontScale;
+        }
+        widthScale = fontScale;
+    }
+
+    void resetGrid(int width, int height) {
+        gridWidth = std::max(1, (width + CELL_SIZE - 1) / CELL_SIZE);
+        gridHeight = std::max(1, (height + CELL_SIZE - 1) / CELL_SIZE);
+        cellHead.assign((size_t)gridWidth * gridHeight, -1);
+        nodeNext.clear();
+        nodeRect.clear();
+        rects.clear();
+    }
+
+    // Place label i unless it overlaps one already placed
+    void tryPlace(size_t i) {
+        float margin = spacing * 0.5f;
+        float height = FONT_GLYPH_HEIGHT * fontScale;
+        Rect r;
+        r.x0 = anchorX[i] + offset.x - margin;
+        r.y1 = anchorY[i] + offset.y + margin;
+        r.x1 = r.x0 + textWidth[i] + 2.0f * margin;
+        r.y0 = r.y1 - height - 2.0f * margin;
+
+        int cx0 = std::max(0, (int)(r.x0 / CELL_SIZE)), cx1 = std::min(gridWidth - 1, (int)(r.x1 / CELL_SIZE));
+        int cy0 = std::max(0, (int)(r.y0 / CELL_SIZE)), cy1 = std::min(gridHeight - 1, (int)(r.y1 / CELL_SIZE));
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                for (int node = cellHead[cy * gridWidth + cx]; node >= 0; node = nodeNext[node]) {
+                    const Rect& o = rects[nodeRect[node]];
+                    if (r.x0 < o.x1 && o.x0 < r.x1 && r.y0 < o.y1 && o.y0 < r.y1) return;
+                }
+            }
+        }
+
+        int index = (int)rects.size();
+        rects.push_back(r);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                int& head = cellHead[cy * gridWidth + cx];
+                nodeNext.push_back(head);
+                nodeRect.push_back(index);
+                head = (int)nodeNext.size() - 1;
+            }
+        }
+        placed[i] = 1;
+    }
+};
+
+// Callsign labels over the traffic, drawn with one instanced draw from a
+// signed distance field atlas of the bitmap font. The SDF keeps glyph edges
+// sharp at any fontScale and gives the dark halo that keeps labels readable
+// over bright terrain.
+class LabelRenderer {
+public:
+    LabelLayout layout;
+    bool visible = true;
+    glm::vec3 textColor = glm::vec3(1.0f, 0.95f, 0.6f);
+    glm::vec3 haloColor = glm::vec3(0.0f, 0.0f, 0.0f);
+
+    // Atlas geometry, shared with labelFragmentShaderSource
+    static const int TEXELS_PER_PIXEL = 4;  // Atlas texels per font pixel
+    static const int CELL_WIDTH = (FONT_GLYPH_WIDTH + 2) * TEXELS_PER_PIXEL;   // One font pixel of border
+    static const int CELL_HEIGHT = (FONT_GLYPH_HEIGHT + 2) * TEXELS_PER_PIXEL;
+    static const int ATLAS_WIDTH = 16 * CELL_WIDTH, ATLAS_HEIGHT = 6 * CELL_HEIGHT;
+
+    void init() {
+        shaderProgram = createShaderProgram(labelVertexShaderSource, labelFragmentShaderSource);
+        screenSizeLoc = glGetUniformLocation(shaderProgram, "screenSize");
+        fontScaleLoc = glGetUniformLocation(shaderProgram, "fontScale");
+        atlasLoc = glGetUniformLocation(shaderProgram, "atlas");
+        textColorLoc = glGetUniformLocation(shaderProgram, "textColor");
+        haloColorLoc = glGetUniformLocation(shaderProgram, "haloColor");
+
+        std::vector<unsigned char> pixels;
+        buildDistanceAtlas(pixels);
+        glGenTextures(1, &atlasTexture);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        createVertexArray();
+    }
+
+    // Init in a context that shares objects with source's: the program and
+    // atlas are reused, the vertex array and this view's instances are new
+    void initShared(const LabelRenderer& source) {
+        *this = source;
+        sharesObjects = true;
+        bufferCount = 0;
+        createVertexArray();
+    }
+
+    // Lay out this frame's labels and upload the instances that changed
+    void update(const Fleet& fleet, const RenderView& view, const glm::mat4& viewProjection,
+                int width, int height, int priority = -1) {
+        if (!visible) return;
+        layout.update(fleet, view, viewProjection, width, height, priority);
+
+        const std::vector<LabelInstance>& instances = layout.instances();
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        if (instances.size() != bufferCount) {
+            bufferCount = instances.size();
+            glBufferData(GL_ARRAY_BUFFER, bufferCount * sizeof(LabelInstance), instances.data(), GL_DYNAMIC_DRAW);
+        } else if (layout.dirtyEnd() > layout.dirtyBegin()) {
+            size_t first = layout.dirtyBegin();
+            glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(LabelInstance),
+                            (layout.dirtyEnd() - first) * sizeof(LabelInstance), &instances[first]);
+        }
+    }
+
+    // Over the bound framebuffer (width x height pixels)
+    void draw(int width, int height) {
+        if (!visible || bufferCount == 0 || layout.visibleCount() == 0) return;
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        glUseProgram(shaderProgram);
+        glUniform2f(screenSizeLoc, (float)width, (float)height);
+        glUniform1f(fontScaleLoc, layout.fontScale);
+        glUniform1i(atlasLoc, 0);
+        glUniform3f(textColorLoc, textColor.x, textColor.y, textColor.z);
+        glUniform3f(haloColorLoc, haloColor.x, haloColor.y, haloColor.z);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+
+        // Hidden labels collapse to nothing in the vertex shader
+        glBindVertexArray(VAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)bufferCount);
+        glBindVertexArray(0);
+
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    size_t visibleCount() const { return visible ? layout.visibleCount() : 0; }
+
+    void cleanup() {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &instanceVBO);
+        if (sharesObjects) return;
+        glDeleteTextures(1, &atlasTexture);
+        glDeleteProgram(shaderProgram);
+    }
+
+private:
+    bool sharesObjects = false;  // Program and atlas belong to another renderer
+    unsigned int shaderProgram = 0, atlasTexture = 0;
+    unsigned int VAO = 0, instanceVBO = 0;
+    int screenSizeLoc = -1, fontScaleLoc = -1, atlasLoc = -1, textColorLoc = -1, haloColorLoc = -1;
+    size_t bufferCount = 0;
+
+    // Signed distance to the nearest glyph edge at every atlas texel: 0.5 on
+    // the edge, rising inside, falling outside, SPREAD texels to either limit
+    static void buildDistanceAtlas(std::vector<unsigned char>& pixels) {
+        const int SPREAD = TEXELS_PER_PIXEL;
+        pixels.assign((size_t)ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+
+        for (int c = 32; c <= 126; ++c) {
+            const unsigned char* glyph = fontGlyph(c);
+            int x0 = ((c - 32) % 16) * CELL_WIDTH, y0 = ((c - 32) / 16) * CELL_HEIGHT;
+
+            // Upsampled coverage of the cell, border included
+            bool coverage[CELL_HEIGHT][CELL_WIDTH];
+            for (int y = 0; y < CELL_HEIGHT; ++y) {
+                for (int x = 0; x < CELL_WIDTH; ++x) {
+                    int fx = x / TEXELS_PER_PIXEL - 1, fy = y / TEXELS_PER_PIXEL - 1;
+                    coverage[y][x] = fx >= 0 && fx < FONT_GLYPH_WIDTH && fy >= 0 && fy < FONT_GLYPH_HEIGHT &&
+                                     ((glyph[fx] >> fy) & 1);
+                }
+            }
+
+            for (int y = 0; y < CELL_HEIGHT; ++y) {
+                for (int x = 0; x < CELL_WIDTH; ++x) {
+                    bool inside = coverage[y][x];
+                    float nearest = (float)SPREAD;
+                    for (int dy = -SPREAD; dy <= SPREAD; ++dy) {
+                        for (int dx = -SPREAD; dx <= SPREAD; ++dx) {
+                            int sx = x + dx, sy = y + dy;
+                            bool other = sx >= 0 && sx < CELL_WIDTH && sy >= 0 && sy < CELL_HEIGHT
+                                             ? coverage[sy][sx] : false;
+                            if (other == inside) continue;
+                            // Texel centers are a texel apart; the edge lies halfway
+                            nearest = std::min(nearest, sqrtf((float)(dx * dx + dy * dy)) - 0.5f);
+                        }
+                    }
+                    float distance = inside ? nearest : -nearest;
+                    float value = 0.5f + 0.5f * distance / SPREAD;
+                    pixels[(size_t)(y0 + y) * ATLAS_WIDTH + x0 + x] =
+                        (unsigned char)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+                }
+            }
+        }
+    }
+
+    // Per-instance corner, length and packed text; the quad comes from gl_VertexID
+    void createVertexArray() {
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        GLsizei stride = sizeof(LabelInstance);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(LabelInstance, x));
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, stride, (void*)offsetof(LabelInstance, length));
+        glVertexAttribIPointer(2, 2, GL_UNSIGNED_INT, stride, (void*)offsetof(LabelInstance, text));
+        for (int a = 0; a < 3; ++a) {
+            glEnableVertexAttribArray(a);
+            glVertexAttribDivisor(a, 1);
+        }
+        glBindVertexArray(0);
+    }
+};
+
+#endif // LABEL_RENDERER_H
@@ -0,0 +1,277 @@
+#ifndef LAND_MASK_H
+#define LAND_MASK_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "continent_noise.h"
+
+// Land/ocean lookup backed by precomputed bit rasters of the continent noise.
+// Each level is an equirectangular grid (width = 2 * height, row 0 at the
+// north pole, column 0 at -180 degrees) packed 64 cells per word, and each
+// level halves the resolution of the previous one. Cells hold the answer at
+// their center, so queries agree with the shader except within half a cell
+// of a coastline.
+//
+// The file layout is the in-memory layout, so a saved mask can be mapped
+// straight in with mapFile instead of being regenerated.
+class LandMask {
+public:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        int wordsPerRow = 0;
+        const uint64_t* bits = nullptr;
+    };
+
+    LandMask() {}
+    ~LandMask() { release(); }
+
+    int levelCount() const { return (int)levels.size(); }
+    const Level& level(int i) const { return levels[i]; }
+
+    // Evaluate the noise for every cell; baseWidth is rounded up to a multiple of 64.
+    // threadCount 0 uses every core.
+    void generate(int baseWidth = 4096, int count = 5, unsigned int threadCount = 0) {
+        if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+        release();
+        baseWidth = (baseWidth + 63) / 64 * 64;
+
+        std::vector<size_t> offsets;
+        size_t words = 0;
+        for (int l = 0; l < count && (baseWidth >> l) >= 64; ++l) {
+            Level lv;
+            lv.width = baseWidth >> l;
+            lv.height = lv.width / 2;
+            lv.wordsPerRow = lv.width / 64;
+            levels.push_back(lv);
+            offsets.push_back(words);
+            words += (size_t)lv.wordsPerRow * lv.height;
+        }
+        owned.assign(words, 0);
+        for (size_t l = 0; l < levels.size(); ++l) levels[l].bits = owned.data() + offsets[l];
+
+        for (size_t l = 0; l < levels.size(); ++l) {
+            const Level& lv = levels[l];
+            uint64_t* out = owned.data() + offsets[l];
+            std::vector<std::thread> workers;
+            for (unsigned int t = 0; t < threadCount; ++t) {
+                workers.push_back(std::thread([&lv, out, t, threadCount] {
+                    for (int row = (int)t; row < lv.height; row += (int)threadCount) {
+                        float lat = glm::radians(90.0f - (row + 0.5f) * 180.0f / lv.height);
+                        uint64_t* rowBits = out + (size_t)row * lv.wordsPerRow;
+                        for (int col = 0; col < lv.width; ++col) {
+                            float lon = glm::radians(-180.0f + (col + 0.5f) * 360.0f / lv.width);
+                            if (continentIsLand(lat, lon)) rowBits[col >> 6] |= (uint64_t)1 << (col & 63);
+                        }
+                    }
+                }));
+            }
+            for (std::thread& worker : workers) worker.join();
+        }
+    }
+
+    // Layout: Header, one LevelHeader per level, then each level's words at
+    // its 64-byte aligned offset
+    bool saveToFile(const char* path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to write land mask: " << path << std::endl;
+            return false;
+        }
+
+        Header header;
+        memcpy(header.magic, "LMSK", 4);
+        header.version = 1;
+        header.levelCount = (uint32_t)levels.size();
+        header.reserved = 0;
+        file.write((const char*)&header, sizeof(header));
+
+        uint64_t offset = alignUp(sizeof(Header) + levels.size() * sizeof(LevelHeader));
+        for (const Level& lv : levels) {
+            LevelHeader lh;
+            lh.width = (uint32_t)lv.width;
+            lh.height = (uint32_t)lv.height;
+            lh.wordsPerRow = (uint32_t)lv.wordsPerRow;
+            lh.reserved = 0;
+            lh.offset = offset;
+            file.write((const char*)&lh, sizeof(lh));
+            offset = alignUp(offset + levelBytes(lv));
+        }
+
+        for (const Level& lv : levels) {
+            uint64_t position = (uint64_t)file.tellp();
+            static const char zeros[64] = {0};
+            file.write(zeros, (std::streamsize)(alignUp(position) - position));
+            file.write((const char*)lv.bits, (std::streamsize)levelBytes(lv));
+        }
+        return (bool)file;
+    }
+
+    // Map a saved mask read-only; pages are loaded on first touch
+    bool mapFile(const char* path) {
+        release();
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(Header)) {
+            close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) return false;
+        mapped = base;
+        mappedSize = (size_t)info.st_size;
+
+        const Header* header = (const Header*)base;
+        const LevelHeader* lh = (const LevelHeader*)(header + 1);
+        if (memcmp(header->magic, "LMSK", 4) != 0 || header->version != 1 || header->levelCount == 0 ||
+            sizeof(Header) + header->levelCount * sizeof(LevelHeader) > mappedSize) {
+            std::cerr << "Invalid land mask: " << path << std::endl;
+            release();
+            return false;
+        }
+
+        for (uint32_t l = 0; l < header->levelCount; ++l) {
+            Level lv;
+            lv.width = (int)lh[l].width;
+            lv.height = (int)lh[l].height;
+            lv.wordsPerRow = (int)lh[l].wordsPerRow;
+            // cellOf divides by width; generate() only writes 2:1 levels
+            if (lv.height <= 0 || lv.width % 2 != 0 || lv.height != lv.width / 2 ||
+                lv.wordsPerRow != (lv.width - 1) / 64 + 1 ||
+                lh[l].offset % 8 != 0 || lh[l].offset + levelBytes(lv) > mappedSize) {
+                std::cerr << "Invalid land mask level " << l << ": " << path << std::endl;
+                release();
+                return false;
+            }
+            lv.bits = (const uint64_t*)((const char*)base + lh[l].offset);
+            levels.push_back(lv);
+        }
+        return true;
+    }
+
+    bool isLand(float latDeg, float lonDeg, int levelIndex = 0) const {
+        const Level& lv = levels[levelIndex];
+        int row, col;
+        cellOf(lv, latDeg, lonDeg, row, col);
+        return (lv.bits[(size_t)row * lv.wordsPerRow + (col >> 6)] >> (col & 63)) & 1;
+    }
+
+    // Position in globe space (any length)
+    bool isLand(const glm::vec3& p, int levelIndex = 0) const {
+        glm::vec3 n = glm::normalize(p);
+        return isLand(glm::degrees(asinf(n.y)), glm::degrees(atan2f(n.z, n.x)), levelIndex);
+    }
+
+    // One byte per query, 1 for land. Cell indices for a block of queries are
+    // computed in one branch-free float loop, then the bits are gathered.
+    void classify(const float* latDeg, const float* lonDeg, uint8_t* land,
+                  size_t count, int levelIndex = 0) const {
+        const Level& lv = levels[levelIndex];
+        const uint64_t* bits = lv.bits;
+        const float rowScale = lv.height / 180.0f;
+        const float colScale = lv.width / 360.0f;
+        const float width = (float)lv.width;
+        const float maxRow = (float)(lv.height - 1);
+        const int wordsPerRow = lv.wordsPerRow;
+
+        const size_t BLOCK = 256;
+        int cell[BLOCK];
+        for (size_t start = 0; start < count; start += BLOCK) {
+            size_t n = count - start < BLOCK ? count - start : BLOCK;
+            const float* lat = latDeg + start;
+            const float* lon = lonDeg + start;
+
+            for (size_t i = 0; i < n; ++i) {
+                float r = (90.0f - lat[i]) * rowScale;
+                r = r < 0.0f ? 0.0f : (r > maxRow ? maxRow : r);
+                float x = (lon[i] + 180.0f) * colScale;
+                x -= floorf(x / width) * width;
+                x = x < width ? x : 0.0f;
+                cell[i] = (int)r * wordsPerRow * 64 + (int)x;
+            }
+
+            for (size_t i = 0; i < n; ++i) {
+                int c = cell[i];
+                land[start + i] = (uint8_t)((bits[c >> 6] >> (c & 63)) & 1);
+            }
+        }
+    }
+
+    // Fraction of cells that are land, weighted by cell area
+    double landFraction(int levelIndex = 0) const {
+        const Level& lv = levels[levelIndex];
+        double land = 0.0, total = 0.0;
+        for (int row = 0; row < lv.height; ++row) {
+            double weight = cos(glm::radians(90.0 - (row + 0.5) * 180.0 / lv.height));
+            int cells = 0;
+            for (int w = 0; w < lv.wordsPerRow; ++w) {
+                cells += __builtin_popcountll(lv.bits[(size_t)row * lv.wordsPerRow + w]);
+            }
+            land += weight * cells;
+            total += weight * lv.width;
+        }
+        return land / total;
+    }
+
+private:
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t levelCount;
+        uint32_t reserved;
+    };
+
+    struct LevelHeader {
+        uint32_t width, height, wordsPerRow, reserved;
+        uint64_t offset;  // Bytes from the start of the file
+    };
+
+    std::vector<Level> levels;
+    std::vector<uint64_t> owned;
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+
+    LandMask(const LandMask&);
+    LandMask& operator=(const LandMask&);
+
+    static uint64_t alignUp(uint64_t bytes) { return (bytes + 63) / 64 * 64; }
+
+    static size_t levelBytes(const Level& lv) {
+        return (size_t)lv.wordsPerRow * lv.height * sizeof(uint64_t);
+    }
+
+    static void cellOf(const Level& lv, float latDeg, float lonDeg, int& row, int& col) {
+        row = (int)((90.0f - latDeg) * (lv.height / 180.0f));
+        row = row < 0 ? 0 : (row >= lv.height ? lv.height - 1 : row);
+        float x = (lonDeg + 180.0f) * (lv.width / 360.0f);
+        col = (int)floorf(x);
+        col %= lv.width;
+        if (col < 0) col += lv.width;
+    }
+
+    void release() {
+        if (mapped) munmap(mapped, mappedSize);
+        mapped = nullptr;
+        mappedSize = 0;
+        levels.clear();
+        owned.clear();
+    }
+};
+
+#endif // LAND_MASK_H
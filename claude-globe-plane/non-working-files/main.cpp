@@ -5,46 +5,139 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <vector>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
 
-#include "shaders.h"
-#include "sphere.h"
 #include "camera.h"
-
-// Window dimensions
-const unsigned int WINDOW_WIDTH = 800;
-const unsigned int WINDOW_HEIGHT = 600;
+#include "wind_field.h"
+#include "flight_model.h"
+#include "route_planner.h"
+#include "land_mask.h"
+#include "fleet.h"
+#include "scene_renderer.h"
+#include "bvh.h"
+#include "picking.h"
+#include "hud.h"
+#include "secondary_view.h"
+#include "output_windows.h"
+#include "settings.h"
+#include "telemetry.h"
+#include "ingest.h"
+#include "frame_scheduler.h"
+
+// Window size, resolution, budgets and limits (see settings.h); watched
+// while running, and --config PATH overrides the location
+const char* CONFIG_PATH = "plane_sim.conf";
+
+// Winds aloft; generated procedurally when the file is missing
+const char* WIND_FIELD_PATH = "winds.bin";
+
+// Land/ocean raster; generated and saved on first run, mapped afterwards
+const char* LAND_MASK_PATH = "landmask.bin";
+
+// The plane view shuttles between these two points on wind-optimal routes
+const float ROUTE_ORIGIN_LAT = 0.0f, ROUTE_ORIGIN_LON = 0.0f;
+const float ROUTE_DESTINATION_LAT = 40.0f, ROUTE_DESTINATION_LON = 100.0f;
+
+// Shared-memory segment the simulation state is published to each tick
+const char* TELEMETRY_NAME = "/plane_sim_telemetry";
+
+// Unix socket for live aircraft positions (see ingest_generator)
+const char* INGEST_SOCKET_PATH = "/tmp/plane_sim_ingest.sock";
 
 // Global camera object
 Camera* camera = nullptr;
 
-// Compile shader function
-unsigned int compileShader(const char* source, GLenum type) {
-    unsigned int shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
-    glCompileShader(shader);
-    
-    int success;
-    char infoLog[512];
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(shader, 512, NULL, infoLog);
-        std::cerr << "Shader compilation failed: " << infoLog << std::endl;
-    }
-    
-    return shader;
+// Aircraft flown by the plane view
+FlightModel* flightModel = nullptr;
+WindField* windField = nullptr;
+RouteGraph* routeGraph = nullptr;
+LandMask* landMask = nullptr;
+RouteFollower* routeFollower = nullptr;
+bool routeOutbound = true;
+
+// Simulated traffic and mouse picking
+Fleet* fleet = nullptr;
+AircraftIndex* aircraftIndex = nullptr;
+PickService* pickService = nullptr;
+
+// Performance overlay and callsign labels
+Hud* hud = nullptr;
+DisplayMetrics display;  // Main window; kept current by the callbacks below
+FrameScheduler scheduler;
+bool showLabels = true;
+
+// Orbit view next to the cockpit, or the other way round
+SecondaryView* secondaryView = nullptr;
+
+// Tunables from the config file
+Settings settings;
+
+// Last known cursor position (window coordinates)
+double cursorX = 0.0;
+double cursorY = 0.0;
+
+// Plan the next leg for the plane view from its current position
+Route planCameraRoute() {
+    glm::vec3 from = glm::normalize(glm::vec3(flightModel->position(0)));
+    glm::vec3 to = routeOutbound ? latLonToDirection(ROUTE_DESTINATION_LAT, ROUTE_DESTINATION_LON)
+                                 : latLonToDirection(ROUTE_ORIGIN_LAT, ROUTE_ORIGIN_LON);
+    RoutePlanner planner;
+    Route route = planner.plan(*routeGraph, from, to);
+    routeFollower->setRoute(route);
+
+    std::cout << "Route planned: " << route.waypoints.size() << " waypoints, "
+              << route.distance / 1000.0 << " km, " << route.flightTime / 60.0 << " min (great circle "
+              << routeGraph->greatCircleTime(from, to) / 60.0 << " min)" << std::endl;
+    return route;
 }
 
 // Callback functions
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
+    display.framebufferWidth = width;
+    display.framebufferHeight = height;
     glViewport(0, 0, width, height);
+    scheduler.damage(FrameScheduler::UI);
+}
+
+// The window system lost the picture (uncovered, restored)
+void window_refresh_callback(GLFWwindow* window) {
+    scheduler.damage(FrameScheduler::UI);
+}
+
+// Wakes the frame loop from another thread when new data is waiting
+void wakeFrameLoop() {
+    glfwPostEmptyEvent();
+}
+
+void window_size_callback(GLFWwindow* window, int width, int height) {
+    display.windowWidth = width;
+    display.windowHeight = height;
+}
+
+// Moving to a monitor with a different scale; the frame loop rescales the
+// overlays when it sees the change
+void content_scale_callback(GLFWwindow* window, float xscale, float yscale) {
+    display.contentScale = xscale;
 }
 
 void mouse_callback(GLFWwindow* window, double xpos, double ypos) {
+    cursorX = xpos;
+    cursorY = ypos;
     if (camera) camera->processMouseMovement(xpos, ypos);
 }
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods) {
     if (camera) camera->processMouseButton(button, action);
+
+    // Right click picks whatever is under the cursor
+    if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS && pickService && aircraftIndex) {
+        pickService->requestPick(cursorX, cursorY, aircraftIndex->snapshot());
+    }
 }
 
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
@@ -56,6 +149,96 @@ void processInput(GLFWwindow* window) {
         glfwSetWindowShouldClose(window, true);
     
     if (camera) camera->processKeyboard(window);
+
+    // L toggles the callsign labels
+    static bool lPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS) {
+        if (!lPressed) {
+            showLabels = !showLabels;
+            scheduler.damage(FrameScheduler::UI);
+        }
+        lPressed = true;
+    } else {
+        lPressed = false;
+    }
+
+    // H toggles the performance overlay
+    static bool hPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS) {
+        if (!hPressed && hud) {
+            hud->visible = !hud->visible;
+            scheduler.damage(FrameScheduler::UI);
+        }
+        hPressed = true;
+    } else {
+        hPressed = false;
+    }
+
+    // V cycles the second view: off, picture-in-picture, split screen
+    static bool vPressed = false;
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS) {
+        if (!vPressed && secondaryView) {
+            secondaryView->cycleLayout();
+            scheduler.damage(FrameScheduler::UI);
+        }
+        vPressed = true;
+    } else {
+        vPressed = false;
+    }
+}
+
+// Push the live settings into everything that uses them. Settings that need
+// a restart are applied before the objects that use them are created.
+// previous is what was applied last time; the window is only resized when
+// the file changes its size, so a reload keeps a size the user dragged to.
+void applySettings(GLFWwindow* window, SceneRenderer& scene, OutputWindows& outputs, const Settings& previous) {
+    if (settings.windowWidth != previous.windowWidth || settings.windowHeight != previous.windowHeight) {
+        glfwSetWindowSize(window, settings.windowWidth, settings.windowHeight);
+    }
+
+    // Text is sized in screen coordinates, so HiDPI monitors draw it bigger
+    float contentScale = display.contentScale;
+    auto applyToScene = [contentScale](SceneRenderer& s) {
+        s.fieldOfView = glm::radians(settings.fieldOfView);
+        s.rayCastGlobe = settings.globeRayCast;
+        s.shadows.maxShadowDistance = settings.shadowDistance;
+        for (int c = 0; c < CascadedShadowMaps::CASCADES; ++c) s.shadows.updateInterval[c] = settings.shadowInterval[c];
+        s.aircraftRenderer.aircraftScale = settings.aircraftScale;
+        s.labelRenderer.layout.fontScale = settings.labelScale * contentScale;
+        s.hdr.keyValue = settings.exposureKey;
+        s.hdr.adaptationRate = settings.exposureAdaptation;
+        s.hdr.budgetMs = settings.postBudgetMs;
+        s.impostor.enabled = settings.impostor;
+        s.impostor.maxPixels = settings.impostorMaxPixels;
+        s.impostor.maxDriftDegrees = settings.impostorDrift;
+        s.impostor.refreshSlices = settings.impostorSlices;
+    };
+    applyToScene(scene);
+    scene.setGlobeResolution(settings.globeSectors, settings.globeStacks);
+    outputs.forEachScene(window, applyToScene);
+    outputs.reportInterval = settings.reportInterval;
+
+    showLabels = settings.labels;
+    hud->refreshSeconds = settings.hudRefresh;
+    hud->scale = std::max(1, (int)std::lround(2.0f * contentScale));
+    secondaryView->resolutionScale = settings.secondViewScale;
+    secondaryView->updateInterval = settings.secondViewInterval;
+
+    camera->speedStep = settings.speedStep;
+    camera->altitudeStep = settings.altitudeStep;
+    camera->minSpeed = settings.minSpeed;
+    camera->maxSpeed = settings.maxSpeed;
+    camera->minAltitude = settings.minAltitude;
+    camera->maxAltitude = settings.maxAltitude;
+    camera->rotateSpeed = settings.rotateSpeed;
+    camera->mouseSensitivity = settings.mouseSensitivity;
+    camera->zoomStep = settings.zoomStep;
+    camera->minDistance = settings.minDistance;
+    camera->maxDistance = settings.maxDistance;
+
+    scheduler.onDemand = settings.onDemand;
+    scheduler.maxWaitSeconds = settings.idleWait;
+    scheduler.damage(FrameScheduler::UI);
 }
 
 void printInstructions() {
@@ -68,10 +251,40 @@ void printInstructions() {
     std::cout << "  Arrow Keys: Rotate the globe" << std::endl;
     std::cout << "  Mouse Drag: Move camera around globe" << std::endl;
     std::cout << "  Scroll: Zoom in/out" << std::endl;
+    std::cout << "Right Click: Select aircraft or show lat/lon" << std::endl;
+    std::cout << "L: Toggle callsign labels" << std::endl;
+    std::cout << "H: Toggle performance overlay" << std::endl;
+    std::cout << "V: Cycle second view (off, picture-in-picture, split screen)" << std::endl;
     std::cout << "ESC: Exit\n" << std::endl;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    std::string configPath = CONFIG_PATH;
+    int outputWindowCount = -1;
+    bool outputFullscreen = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--config" && i + 1 < argc) configPath = argv[++i];
+        else if (arg == "--windows" && i + 1 < argc) outputWindowCount = std::max(0, atoi(argv[++i]));
+        else if (arg == "--fullscreen") outputFullscreen = true;
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--config PATH] [--windows N] [--fullscreen]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Settings file; the built-in defaults stand in for a missing one
+    ConfigFile config;
+    if (config.load(configPath)) {
+        settings.read(config);
+        config.warnUnused();
+        std::cout << "Loaded settings from " << configPath << std::endl;
+    } else {
+        std::cout << "No " << configPath << ", using default settings" << std::endl;
+    }
+    if (outputWindowCount >= 0) settings.outputWindows = outputWindowCount;
+    if (outputFullscreen) settings.fullscreen = true;
+
     // Initialize GLFW
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW" << std::endl;
@@ -88,7 +301,7 @@ int main() {
     #endif
 
     // Create window
-    GLFWwindow* window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Plane Around Planet", NULL, NULL);
+    GLFWwindow* window = glfwCreateWindow(settings.windowWidth, settings.windowHeight, "Plane Around Planet", NULL, NULL);
     if (!window) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -97,6 +310,9 @@ int main() {
 
     glfwMakeContextCurrent(window);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowSizeCallback(window, window_size_callback);
+    glfwSetWindowContentScaleCallback(window, content_scale_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetScrollCallback(window, scroll_callback);
@@ -107,79 +323,89 @@ int main() {
         return -1;
     }
 
-    glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
+    // On HiDPI displays the framebuffer is bigger than the window size asked for
+    display.query(window);
+    glViewport(0, 0, display.framebufferWidth, display.framebufferHeight);
     glEnable(GL_DEPTH_TEST);
 
     // Create camera
-    camera = new Camera(WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    // Compile shaders
-    unsigned int vertexShader = compileShader(vertexShaderSource, GL_VERTEX_SHADER);
-    unsigned int fragmentShader = compileShader(fragmentShaderSource, GL_FRAGMENT_SHADER);
-
-    // Create shader program
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-
-    // Check linking
-    int success;
-    char infoLog[512];
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cerr << "Shader linking failed: " << infoLog << std::endl;
-    }
-
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // Generate sphere
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
-    generateSphere(1.0f, 72, 36, vertices, indices);
-
-    // Create VAO, VBO, EBO
-    unsigned int VAO, VBO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Normal attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindVertexArray(0);
-
-    // Get uniform locations
-    int modelLoc = glGetUniformLocation(shaderProgram, "model");
-    int viewLoc = glGetUniformLocation(shaderProgram, "view");
-    int projLoc = glGetUniformLocation(shaderProgram, "projection");
-    int sunPosLoc = glGetUniformLocation(shaderProgram, "sunPos");
-    int moonPosLoc = glGetUniformLocation(shaderProgram, "moonPos");
-    int sunColorLoc = glGetUniformLocation(shaderProgram, "sunColor");
-    int moonColorLoc = glGetUniformLocation(shaderProgram, "moonColor");
-    int objectColorLoc = glGetUniformLocation(shaderProgram, "objectColor");
-    int viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos");
+    camera = new Camera(settings.windowWidth, settings.windowHeight);
+
+    // Load winds aloft
+    windField = new WindField();
+    if (!std::ifstream(WIND_FIELD_PATH).good() || !windField->loadFromFile(WIND_FIELD_PATH)) {
+        windField->generateProcedural();
+    }
+
+    // Map the land mask, building it if there is no saved copy
+    landMask = new LandMask();
+    if (!landMask->mapFile(LAND_MASK_PATH)) {
+        landMask->generate(4096, 5, (unsigned int)settings.landMaskThreads);
+        landMask->saveToFile(LAND_MASK_PATH);
+    }
+
+    // Put the camera in a simulated aircraft at cruise altitude
+    flightModel = new FlightModel();
+    flightModel->windField = windField;
+    flightModel->resize(1);
+    glm::dvec3 origin(latLonToDirection(ROUTE_ORIGIN_LAT, ROUTE_ORIGIN_LON));
+    flightModel->spawn(0, origin, glm::dvec3(0.0, 0.0, 1.0), settings.cruiseAltitude, 230.0);
+    camera->flightModel = flightModel;
+
+    // Plan its route over the wind field and point it down the first leg
+    routeGraph = new RouteGraph();
+    routeGraph->planetRadius = flightModel->planetRadius;
+    routeGraph->cruiseAltitude = (float)flightModel->targetAltitude[0];
+    routeGraph->build(5);
+    routeGraph->setWind(windField);
+    routeFollower = new RouteFollower();
+    Route firstLeg = planCameraRoute();
+    if (firstLeg.waypoints.size() > 1) {
+        flightModel->spawn(0, origin, glm::dvec3(firstLeg.waypoints[1]) - origin,
+                           flightModel->targetAltitude[0], 230.0);
+    }
+
+    // Create fleet, the scene renderer and the picking worker
+    fleet = new Fleet();
+    fleet->spawnRandom((size_t)settings.fleetSize);
+    aircraftIndex = new AircraftIndex();
+    SceneRenderer scene;
+    scene.fieldOfView = glm::radians(settings.fieldOfView);
+    scene.shadows.resolution = settings.shadowResolution;
+    scene.hdr.enabled = settings.hdr;
+    scene.init(camera->planetRadius, settings.reversedZ, settings.globeSectors, settings.globeStacks);
+    AircraftRenderer& aircraftRenderer = scene.aircraftRenderer;
+    pickService = new PickService();
+    pickService->onResult = wakeFrameLoop;
+    hud = new Hud();
+    hud->init();
+    secondaryView = new SecondaryView();
+    TelemetryPublisher telemetry;
+    telemetry.slotCount = (uint32_t)settings.telemetrySlots;
+    if (telemetry.open(TELEMETRY_NAME, (size_t)settings.fleetSize)) {
+        std::cout << "Publishing telemetry to " << TELEMETRY_NAME << std::endl;
+    }
+    OutputWindows outputs;
+    outputs.fullscreen = settings.fullscreen;
+    outputs.open(window, scene, settings.outputWindows, settings.windowWidth, settings.windowHeight,
+                 settings.reversedZ);
+    applySettings(window, scene, outputs, settings);
+    float appliedContentScale = display.contentScale;
+    IngestService ingest;
+    ingest.batchSize = (size_t)settings.ingestBatchSize;
+    ingest.maxQueuedBatches = (size_t)settings.ingestMaxBatches;
+    ingest.onQueued = wakeFrameLoop;
+    if (ingest.start(INGEST_SOCKET_PATH, fleet->metersPerUnit)) {
+        std::cout << "Accepting live positions on " << INGEST_SOCKET_PATH << std::endl;
+    }
 
     // Print instructions
     printInstructions();
 
     // Render loop
     float lastFrame = 0.0f;
+    double simTime = 0.0;
+    RenderView drawnView, drawnSecondView;  // Cameras of the last drawn frame
     while (!glfwWindowShouldClose(window)) {
         // Calculate delta time
         float currentFrame = glfwGetTime();
@@ -188,53 +414,132 @@ int main() {
 
         processInput(window);
 
-        // Clear
-        glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Use shader program
-        glUseProgram(shaderProgram);
-
-        // Set up matrices
-        glm::mat4 model = camera->getModelMatrix();
-        glm::mat4 view = camera->getViewMatrix(deltaTime);
-        glm::mat4 projection = glm::perspective(
-            glm::radians(45.0f),
-            (float)WINDOW_WIDTH / (float)WINDOW_HEIGHT,
-            0.1f, 100.0f
-        );
-
-        // Set uniforms
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        
-        // Sun and moon positions (opposite sides)
-        glUniform3f(sunPosLoc, 5.0f, 0.0f, 0.0f);
-        glUniform3f(moonPosLoc, -5.0f, 0.0f, 0.0f);
-        
-        // Light colors
-        glUniform3f(sunColorLoc, 1.0f, 0.9f, 0.7f);  // Warm yellow
-        glUniform3f(moonColorLoc, 0.7f, 0.8f, 1.0f); // Cool blue-white
-        
-        // Camera/view position for rim lighting
-        glm::vec3 viewPosition = camera->getViewPosition();
-        glUniform3f(viewPosLoc, viewPosition.x, viewPosition.y, viewPosition.z);
-
-        // Draw sphere
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        // Pick up edits to the settings file
+        if (config.reloadIfChanged()) {
+            Settings running = settings;
+            settings.read(config);
+            config.warnUnused();
+            settings.keepStartupValues(running);
+            applySettings(window, scene, outputs, running);
+            std::cout << "Reloaded settings from " << config.path() << std::endl;
+        }
+        if (display.contentScale != appliedContentScale) {
+            applySettings(window, scene, outputs, settings);
+            appliedContentScale = display.contentScale;
+        }
+
+        // Advance the simulated aircraft and traffic
+        if (routeFollower->finished()) {
+            routeOutbound = !routeOutbound;
+            planCameraRoute();
+        }
+        routeFollower->update(*flightModel, 0);
+        flightModel->advance(deltaTime * settings.timeScale);
+        fleet->propagate((float)(deltaTime * settings.timeScale), windField);
+        // Live fixes override the dead reckoning
+        if (ingest.apply(*fleet) > 0) scheduler.damage(FrameScheduler::DATA);
+        aircraftIndex->update(*fleet, deltaTime);
+        simTime += deltaTime * settings.timeScale;
+        telemetry.publish(*fleet, flightModel, 0, simTime);
+
+        // Sun fixed while the globe turns
+        RenderView renderView = camera->getRenderView(deltaTime);
+        glm::mat3 globeFromWorld = glm::transpose(glm::mat3(camera->getModelMatrix()));
+        glm::dvec3 sunDirection = glm::dvec3(globeFromWorld * glm::vec3(1.0f, 0.0f, 0.0f));
+        int framebufferWidth = display.framebufferWidth, framebufferHeight = display.framebufferHeight;
+        Viewport mainViewport, secondViewport;
+        secondaryView->layoutViewports(framebufferWidth, framebufferHeight, mainViewport, secondViewport);
+        RenderView secondView;
+        if (secondaryView->enabled()) secondView = companionView(*camera);
+
+        // Anything moved? The sun only moves with the camera's globe rotation.
+        if (!renderView.sameAs(drawnView) || !secondView.sameAs(drawnSecondView) || outputs.needsRedraw()) {
+            scheduler.damage(FrameScheduler::CAMERA);
+        }
+        double metersPerPixel = std::max(renderView.altitude(), 1.0) * 2.0 * tan(scene.fieldOfView * 0.5) /
+                                std::max(framebufferHeight, 1);
+        scheduler.simulationAdvanced(deltaTime * settings.timeScale, metersPerPixel);
+
+        // Hand this frame's matrices to the picker and collect finished picks.
+        // Picking works in globe units, which fit comfortably in float.
+        // Only the main view picks; it starts at the window's left edge.
+        int windowWidth = display.windowWidth, windowHeight = display.windowHeight;
+        if (framebufferWidth > 0) windowWidth = windowWidth * mainViewport.width / framebufferWidth;
+        pickService->updateMatrices(glm::mat4(1.0f), renderView.globeViewMatrix(),
+                                    renderView.globeProjection(scene.fieldOfView, mainViewport.aspect()),
+                                    windowWidth, windowHeight);
+
+        PickResult pick;
+        while (pickService->pollResult(pick)) {
+            if (pick.type == PickResult::AIRCRAFT) {
+                aircraftRenderer.selectedAircraft = pick.aircraft;
+                char callsign[8];
+                Fleet::callsign(pick.aircraft, callsign);
+                std::cout << "Selected aircraft #" << pick.aircraft << " " << callsign;
+            } else if (pick.type == PickResult::SURFACE) {
+                aircraftRenderer.selectedAircraft = -1;
+                std::cout << "Surface at lat " << pick.latitude << ", lon " << pick.longitude
+                          << (landMask->isLand(pick.latitude, pick.longitude) ? " (land)" : " (ocean)");
+            } else {
+                aircraftRenderer.selectedAircraft = -1;
+                std::cout << "Nothing picked";
+            }
+            std::cout << " (" << pick.queryMicros << " us)" << std::endl;
+            scheduler.damage(FrameScheduler::UI);
+        }
+
+        bool draw = scheduler.shouldDraw();
+        if (draw) {
+            std::chrono::steady_clock::time_point renderStart = std::chrono::steady_clock::now();
+            scene.labelRenderer.visible = showLabels;
+            scene.renderFrame(renderView, sunDirection, *fleet, mainViewport);
+            if (secondaryView->enabled()) {
+                secondaryView->render(scene, secondView, sunDirection, *fleet, secondViewport);
+                secondaryView->present(scene, secondViewport);
+            }
+            hud->recordFrame(deltaTime);
+            hud->draw(framebufferWidth, framebufferHeight, scene.profiler, scene.stats);
+            outputs.recordMainFrame(std::chrono::duration<double, std::milli>(
+                                        std::chrono::steady_clock::now() - renderStart).count(),
+                                    scene.profiler.lastFrameGpuMs());
+
+            // The other windows' cameras see the same state
+            outputs.render(window, sunDirection, *fleet);
+            drawnView = renderView;
+            drawnSecondView = secondView;
+        }
+
+        scene.profiler.report(settings.reportInterval);
+        ingest.report(settings.reportInterval);
+        scene.impostor.report(settings.reportInterval);
+        outputs.report();
+        if (draw) outputs.swap(window);
+        scheduler.finishIteration(draw, draw ? scene.profiler.lastFrameGpuMs() : 0.0, settings.timeScale);
+        scheduler.report(settings.reportInterval);
     }
 
     // Clean up
+    if (telemetry.isOpen()) {
+        std::cout << "Telemetry: " << telemetry.publishedCount() << " snapshots, "
+                  << telemetry.averageMicros() << " us per publish" << std::endl;
+    }
+    telemetry.close();
+    outputs.close(window);
+    ingest.stop();
+    hud->cleanup();
+    delete hud;
+    secondaryView->cleanup();
+    delete secondaryView;
+    delete pickService;
+    delete aircraftIndex;
+    delete fleet;
     delete camera;
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteProgram(shaderProgram);
+    delete flightModel;
+    delete routeFollower;
+    delete routeGraph;
+    delete windField;
+    delete landMask;
+    scene.cleanup();
 
     glfwTerminate();
     return 0;
@@ -0,0 +1,269 @@
+#ifndef OUTPUT_WINDOWS_H
+#define OUTPUT_WINDOWS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+#include "camera.h"
+#include "fleet.h"
+#include "scene_renderer.h"
+
+// Frame timing of one window, summed since the last report
+struct WindowTiming {
+    double renderMs = 0.0;  // CPU time issuing the frame
+    double gpuMs = 0.0;     // Resolved GPU time of its profiler scopes
+    double swapMs = 0.0;    // Time in glfwSwapBuffers
+    int frames = 0;
+};
+
+// Extra windows showing the same simulation from their own cameras, for
+// walls of monitors driven by one process.
+//
+// Each window's context is created sharing objects with the main window's,
+// so the globe and dart meshes, the label atlas and every shader program
+// are uploaded once (SceneRenderer::initShared). The glad entry points
+// loaded for the main context are used for all of them, which holds for
+// contexts of the same driver.
+//
+// Swaps are coordinated so the windows pace together: every window issues
+// its frame first, the extra windows swap without waiting for vertical
+// sync, and the main window's swap, the only one with a swap interval,
+// paces the loop. Waiting on vsync once per window would divide the frame
+// rate by the window count.
+class OutputWindows {
+public:
+    bool fullscreen = false;   // Take over each extra monitor instead of a window on it
+    double reportInterval = 2.0;
+
+    // Open count windows sharing mainWindow's objects. With more than one
+    // monitor, window i goes on monitor i, wrapping around. Leaves
+    // mainWindow's context current.
+    void open(GLFWwindow* mainWindow, const SceneRenderer& mainScene, int count, int width, int height,
+              bool reversedZ) {
+        int monitorCount = 0;
+        GLFWmonitor** monitors = glfwGetMonitors(&monitorCount);
+
+        for (int i = 1; i <= count; ++i) {
+            GLFWmonitor* monitor = monitorCount > 0 ? monitors[i % monitorCount] : nullptr;
+            int w = width, h = height;
+            GLFWmonitor* fullscreenMonitor = nullptr;
+            if (fullscreen && monitor) {
+                const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+                w = mode->width;
+                h = mode->height;
+                fullscreenMonitor = monitor;
+            }
+
+            std::string title = "Plane Around Planet - view " + std::to_string(i + 1);
+            GLFWwindow* window = glfwCreateWindow(w, h, title.c_str(), fullscreenMonitor, mainWindow);
+            if (!window) {
+                std::cerr << "Failed to create output window " << i + 1 << std::endl;
+                break;
+            }
+            if (!fullscreenMonitor && monitor && monitorCount > 1) {
+                int x = 0, y = 0;
+                glfwGetMonitorPos(monitor, &x, &y);
+                glfwSetWindowPos(window, x + 50, y + 50);
+            }
+
+            Output* output = new Output(w, h);
+            output->window = window;
+            // Orbit cameras spread around the globe; drag and scroll in a window move its own
+            output->camera.manualControl = true;
+            output->camera.cameraAngleX = 2.0f * (float)M_PI * i / (count + 1);
+            glfwSetWindowUserPointer(window, output);
+            glfwSetCursorPosCallback(window, cursorCallback);
+            glfwSetMouseButtonCallback(window, mouseButtonCallback);
+            glfwSetScrollCallback(window, scrollCallback);
+            glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
+            glfwGetFramebufferSize(window, &output->framebufferWidth, &output->framebufferHeight);
+
+            glfwMakeContextCurrent(window);
+            glfwSwapInterval(0);
+            glEnable(GL_DEPTH_TEST);
+            output->scene.initShared(mainScene, reversedZ);
+            output->scene.labelRenderer.visible = false;
+            outputs.push_back(output);
+        }
+
+        glfwMakeContextCurrent(mainWindow);
+        lastReport = Clock::now();
+        if (!outputs.empty()) {
+            glfwSwapInterval(1);
+            std::cout << "Opened " << outputs.size() << " output window(s) on "
+                      << monitorCount << " monitor(s)" << std::endl;
+        }
+    }
+
+    size_t size() const { return outputs.size(); }
+
+    // Call f(SceneRenderer&) for every extra window, with its context current.
+    // Ends with mainWindow current.
+    template <typename F>
+    void forEachScene(GLFWwindow* mainWindow, F f) {
+        for (Output* output : outputs) {
+            glfwMakeContextCurrent(output->window);
+            f(output->scene);
+        }
+        glfwMakeContextCurrent(mainWindow);
+    }
+
+    // Whether any extra window's camera or size changed since it was drawn
+    bool needsRedraw() {
+        for (Output* output : outputs) {
+            if (!output->camera.getRenderView(0.0f).sameAs(output->drawnView) ||
+                output->framebufferWidth != output->drawnWidth || output->framebufferHeight != output->drawnHeight) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Issue every extra window's frame. Ends with mainWindow current.
+    void render(GLFWwindow* mainWindow, const glm::dvec3& sunDirection, const Fleet& fleet) {
+        closeRequested(mainWindow);
+        for (Output* output : outputs) {
+            Clock::time_point start = Clock::now();
+            glfwMakeContextCurrent(output->window);
+            int width = output->framebufferWidth, height = output->framebufferHeight;
+            output->drawnView = output->camera.getRenderView(0.0f);
+            output->drawnWidth = width;
+            output->drawnHeight = height;
+            if (width > 0 && height > 0) {
+                output->scene.renderFrame(output->drawnView, sunDirection, fleet, width, height);
+                glFlush();  // Start the GPU on it before the next context takes over
+            }
+            output->timing.renderMs += msSince(start);
+            output->timing.gpuMs += output->scene.profiler.lastFrameGpuMs();
+            ++output->timing.frames;
+        }
+        glfwMakeContextCurrent(mainWindow);
+    }
+
+    // Present everything: the extra windows first, then the main window,
+    // whose swap waits for vsync
+    void swap(GLFWwindow* mainWindow) {
+        for (Output* output : outputs) {
+            Clock::time_point start = Clock::now();
+            glfwSwapBuffers(output->window);
+            output->timing.swapMs += msSince(start);
+        }
+        Clock::time_point start = Clock::now();
+        glfwSwapBuffers(mainWindow);
+        mainTiming.swapMs += msSince(start);
+    }
+
+    // The main window's own frame, timed by the caller
+    void recordMainFrame(double renderMs, double gpuMs) {
+        mainTiming.renderMs += renderMs;
+        mainTiming.gpuMs += gpuMs;
+        ++mainTiming.frames;
+    }
+
+    // Print per-window averages every reportInterval seconds
+    void report() {
+        if (outputs.empty() || std::chrono::duration<double>(Clock::now() - lastReport).count() < reportInterval) {
+            return;
+        }
+        std::cout << "--- Windows ---" << std::endl;
+        printTiming("main", mainTiming);
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            printTiming(("view " + std::to_string(i + 2)).c_str(), outputs[i]->timing);
+        }
+        lastReport = Clock::now();
+    }
+
+    // Release every extra window; mainWindow's context is current afterwards
+    void close(GLFWwindow* mainWindow) {
+        for (Output* output : outputs) destroy(output);
+        outputs.clear();
+        glfwMakeContextCurrent(mainWindow);
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Output {
+        GLFWwindow* window = nullptr;
+        Camera camera;
+        SceneRenderer scene;
+        WindowTiming timing;
+        int framebufferWidth = 0, framebufferHeight = 0;  // From the size callback
+        RenderView drawnView;                             // As last rendered
+        int drawnWidth = 0, drawnHeight = 0;
+        Output(int width, int height) : camera((float)width, (float)height) {}
+    };
+
+    std::vector<Output*> outputs;
+    WindowTiming mainTiming;
+    Clock::time_point lastReport;
+
+    static double msSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    static void printTiming(const char* name, WindowTiming& timing) {
+        if (timing.frames == 0) return;
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::left << std::setw(10) << name << std::right
+                  << " render " << std::setw(7) << timing.renderMs / timing.frames << " ms"
+                  << "  gpu " << std::setw(7) << timing.gpuMs / timing.frames << " ms"
+                  << "  swap " << std::setw(7) << timing.swapMs / timing.frames << " ms"
+                  << "  (" << timing.frames << " frames)" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+        timing = WindowTiming();
+    }
+
+    // Closing an extra window only drops that view
+    void closeRequested(GLFWwindow* mainWindow) {
+        for (size_t i = 0; i < outputs.size();) {
+            if (!glfwWindowShouldClose(outputs[i]->window)) {
+                ++i;
+                continue;
+            }
+            destroy(outputs[i]);
+            outputs.erase(outputs.begin() + i);
+            glfwMakeContextCurrent(mainWindow);
+        }
+    }
+
+    // Per-context objects go with their own context current
+    static void destroy(Output* output) {
+        glfwMakeContextCurrent(output->window);
+        output->scene.cleanup();
+        glfwMakeContextCurrent(nullptr);
+        glfwDestroyWindow(output->window);
+        delete output;
+    }
+
+    static Output* outputOf(GLFWwindow* window) {
+        return (Output*)glfwGetWindowUserPointer(window);
+    }
+
+    static void cursorCallback(GLFWwindow* window, double x, double y) {
+        outputOf(window)->camera.processMouseMovement(x, y);
+    }
+
+    static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+        outputOf(window)->camera.processMouseButton(button, action);
+    }
+
+    static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+        outputOf(window)->camera.processScroll(yoffset);
+    }
+
+    static void framebufferSizeCallback(GLFWwindow* window, int width, int height) {
+        outputOf(window)->framebufferWidth = width;
+        outputOf(window)->framebufferHeight = height;
+    }
+};
+
+#endif // OUTPUT_WINDOWS_H
@@ -0,0 +1,157 @@
+#ifndef PICKING_H
+#define PICKING_H
+
+#include <glm/glm.hpp>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cfloat>
+#include <cmath>
+
+#include "ray.h"
+#include "bvh.h"
+
+// Same lat/long convention as continentNoise in the globe shader
+inline void surfaceToLatLon(const glm::vec3& p, float& latDeg, float& lonDeg) {
+    glm::vec3 n = glm::normalize(p);
+    latDeg = glm::degrees(asinf(n.y));
+    lonDeg = glm::degrees(atan2f(n.z, n.x));
+}
+
+struct PickResult {
+    enum Type { NONE, SURFACE, AIRCRAFT };
+    Type type = NONE;
+    float latitude = 0.0f;    // Degrees, surface picks
+    float longitude = 0.0f;   // Degrees, surface picks
+    int aircraft = -1;        // Fleet index, aircraft picks
+    float distance = 0.0f;    // Along the ray
+    double queryMicros = 0.0; // Time spent intersecting on the worker
+};
+
+// Resolves mouse picks on a worker thread. The render thread only caches the
+// current matrices and, on a click, hands over the aircraft index's current
+// snapshot (a pointer, no copy); results are collected later with
+// pollResult, so the render loop never blocks on a query.
+class PickService {
+public:
+    void (*onResult)() = nullptr;  // Called on the worker thread when a result is ready
+
+    PickService() : stopping(false), worker(&PickService::workerLoop, this) {}
+
+    ~PickService() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cond.notify_one();
+        worker.join();
+    }
+
+    // Called once per frame with the matrices used for drawing
+    void updateMatrices(const glm::mat4& model, const glm::mat4& view,
+                        const glm::mat4& projection, int width, int height) {
+        invModel = glm::inverse(model);
+        viewMatrix = view;
+        projectionMatrix = projection;
+        viewportWidth = width;
+        viewportHeight = height;
+    }
+
+    void requestPick(double xpos, double ypos, std::shared_ptr<const Bvh4> aircraft) {
+        if (viewportWidth <= 0 || viewportHeight <= 0) return;
+
+        Ray worldRay = screenPointToRay(xpos, ypos, viewportWidth, viewportHeight,
+                                        viewMatrix, projectionMatrix);
+
+        // Aircraft and surface live in globe space, so move the ray there
+        PickRequest request;
+        request.ray.origin = glm::vec3(invModel * glm::vec4(worldRay.origin, 1.0f));
+        request.ray.direction = glm::normalize(glm::vec3(invModel * glm::vec4(worldRay.direction, 0.0f)));
+        request.aircraft = std::move(aircraft);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back(std::move(request));
+        }
+        cond.notify_one();
+    }
+
+    // Non-blocking; returns false when no result is ready (or the worker holds the lock)
+    bool pollResult(PickResult& result) {
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock() || results.empty()) return false;
+        result = results.front();
+        results.pop_front();
+        return true;
+    }
+
+private:
+    struct PickRequest {
+        Ray ray;
+        std::shared_ptr<const Bvh4> aircraft;  // AircraftIndex::snapshot(); the index leaves it alone while held
+    };
+
+    glm::mat4 invModel = glm::mat4(1.0f);
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    glm::mat4 projectionMatrix = glm::mat4(1.0f);
+    int viewportWidth = 0;
+    int viewportHeight = 0;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<PickRequest> requests;
+    std::deque<PickResult> results;
+    bool stopping;
+    std::thread worker;
+
+    void workerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            cond.wait(lock, [this] { return stopping || !requests.empty(); });
+            if (stopping) return;
+
+            PickRequest request = std::move(requests.front());
+            requests.pop_front();
+            lock.unlock();
+
+            PickResult result = pick(request);
+
+            lock.lock();
+            results.push_back(result);
+            if (onResult) onResult();
+        }
+    }
+
+    PickResult pick(const PickRequest& request) const {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const Ray& ray = request.ray;
+
+        PickResult result;
+        float tSurface = FLT_MAX;
+        bool hitSurface = intersectSphere(ray, glm::vec3(0.0f), 1.0f, tSurface);
+
+        // Closest aircraft in front of the surface hit
+        int best = -1;
+        float bestT = tSurface;
+        request.aircraft->intersectClosest(ray, tSurface, best, bestT);
+
+        if (best >= 0) {
+            result.type = PickResult::AIRCRAFT;
+            result.aircraft = best;
+            result.distance = bestT;
+        } else if (hitSurface) {
+            result.type = PickResult::SURFACE;
+            result.distance = tSurface;
+            surfaceToLatLon(ray.origin + ray.direction * tSurface, result.latitude, result.longitude);
+        }
+
+        result.queryMicros = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+};
+
+#endif // PICKING_H
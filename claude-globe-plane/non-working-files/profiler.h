@@ -0,0 +1,186 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+// Per-frame work counters, filled in by the renderer
+struct FrameStats {
+    int drawCalls = 0;
+    long long trianglesDrawn = 0;
+    long long trianglesCulled = 0;  // Skipped by CPU culling
+};
+
+// Per-pass GPU and CPU timing. Each scope wraps its GL calls in a
+// GL_TIME_ELAPSED query; queries are read back LATENCY frames later so the
+// CPU never waits on the GPU. Time-elapsed queries cannot nest, so scopes
+// are flat: end one before beginning the next.
+//
+// Scopes are keyed by name. A scope that only runs on some frames (like a
+// staggered shadow cascade) averages over the frames it ran and reports
+// how often that was.
+class Profiler {
+public:
+    static const int LATENCY = 3;
+
+    struct Stat {
+        std::string name;
+        double gpuMs = 0.0;    // Summed since the last report
+        double cpuMs = 0.0;
+        int runs = 0;
+        double lastGpuMs = 0.0;  // Most recent resolved sample
+        double lastCpuMs = 0.0;
+    };
+
+    bool enabled = true;
+
+    void init() {
+        for (int s = 0; s < LATENCY; ++s) slots[s].entries.clear();
+        lastReport = Clock::now();
+    }
+
+    void beginFrame() {
+        if (!enabled) return;
+        current = frameIndex % LATENCY;
+        resolve(slots[current]);
+        ++frameIndex;
+        ++framesSinceReport;
+    }
+
+    void begin(const char* name) {
+        if (!enabled) return;
+        Slot& slot = slots[current];
+        if (slot.used == slot.entries.size()) {
+            Entry entry;
+            glGenQueries(1, &entry.query);
+            slot.entries.push_back(entry);
+        }
+        Entry& entry = slot.entries[slot.used++];
+        entry.stat = statIndex(name);
+        entry.cpuStart = Clock::now();
+        glBeginQuery(GL_TIME_ELAPSED, entry.query);
+    }
+
+    void end() {
+        if (!enabled) return;
+        Slot& slot = slots[current];
+        Entry& entry = slot.entries[slot.used - 1];
+        glEndQuery(GL_TIME_ELAPSED);
+        entry.cpuMs = std::chrono::duration<double, std::milli>(Clock::now() - entry.cpuStart).count();
+    }
+
+    const std::vector<Stat>& stats() const { return statList; }
+
+    // Latest resolved GPU time of a scope, 0 if it has not run yet
+    double lastGpuMs(const char* name) const {
+        const Stat* stat = find(name);
+        return stat ? stat->lastGpuMs : 0.0;
+    }
+
+    double lastCpuMs(const char* name) const {
+        const Stat* stat = find(name);
+        return stat ? stat->lastCpuMs : 0.0;
+    }
+
+    // GPU time of the most recently resolved frame, all scopes
+    double lastFrameGpuMs() const { return frameGpuMs; }
+
+    // Print averages every interval seconds, then start over
+    void report(double intervalSeconds) {
+        if (!enabled) return;
+        double elapsed = std::chrono::duration<double>(Clock::now() - lastReport).count();
+        if (elapsed < intervalSeconds || framesSinceReport == 0) return;
+
+        std::cout << "--- Profiler (" << framesSinceReport << " frames) ---" << std::endl;
+        std::cout << std::fixed << std::setprecision(3);
+        for (Stat& stat : statList) {
+            if (stat.runs == 0) continue;
+            std::cout << std::left << std::setw(22) << stat.name << std::right
+                      << " gpu " << std::setw(7) << stat.gpuMs / stat.runs << " ms"
+                      << "  cpu " << std::setw(7) << stat.cpuMs / stat.runs << " ms";
+            if (stat.runs < framesSinceReport) {
+                std::cout << "  (" << stat.runs << "/" << framesSinceReport << " frames)";
+            }
+            std::cout << std::endl;
+            stat.gpuMs = stat.cpuMs = 0.0;
+            stat.runs = 0;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+        framesSinceReport = 0;
+        lastReport = Clock::now();
+    }
+
+    void cleanup() {
+        for (int s = 0; s < LATENCY; ++s) {
+            for (Entry& entry : slots[s].entries) glDeleteQueries(1, &entry.query);
+            slots[s].entries.clear();
+            slots[s].used = 0;
+        }
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        unsigned int query = 0;
+        int stat = 0;
+        Clock::time_point cpuStart;
+        double cpuMs = 0.0;
+    };
+
+    struct Slot {
+        std::vector<Entry> entries;  // Query objects are kept and reused
+        size_t used = 0;
+    };
+
+    Slot slots[LATENCY];
+    std::vector<Stat> statList;
+    int current = 0;
+    long long frameIndex = 0;
+    int framesSinceReport = 0;
+    Clock::time_point lastReport;
+    double frameGpuMs = 0.0;
+
+    const Stat* find(const char* name) const {
+        for (const Stat& stat : statList) {
+            if (stat.name == name) return &stat;
+        }
+        return nullptr;
+    }
+
+    int statIndex(const char* name) {
+        for (size_t i = 0; i < statList.size(); ++i) {
+            if (statList[i].name == name) return (int)i;
+        }
+        Stat stat;
+        stat.name = name;
+        statList.push_back(stat);
+        return (int)statList.size() - 1;
+    }
+
+    // Collect a slot's results from LATENCY frames ago; blocks only if the
+    // GPU is more than that far behind
+    void resolve(Slot& slot) {
+        if (slot.used > 0) frameGpuMs = 0.0;
+        for (size_t i = 0; i < slot.used; ++i) {
+            Entry& entry = slot.entries[i];
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(entry.query, GL_QUERY_RESULT, &nanoseconds);
+            Stat& stat = statList[entry.stat];
+            stat.lastGpuMs = nanoseconds * 1e-6;
+            stat.lastCpuMs = entry.cpuMs;
+            frameGpuMs += stat.lastGpuMs;
+            stat.gpuMs += stat.lastGpuMs;
+            stat.cpuMs += entry.cpuMs;
+            ++stat.runs;
+        }
+        slot.used = 0;
+    }
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,44 @@
+#ifndef RAY_H
+#define RAY_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+
+struct Ray {
+    glm::vec3 origin;
+    glm::vec3 direction;  // Unit length
+};
+
+// Turn a cursor position (window coordinates, origin top-left) into a world-space ray
+inline Ray screenPointToRay(double xpos, double ypos, int width, int height,
+                            const glm::mat4& view, const glm::mat4& projection) {
+    float ndcX = (float)(2.0 * xpos / width - 1.0);
+    float ndcY = (float)(1.0 - 2.0 * ypos / height);
+
+    glm::mat4 invViewProj = glm::inverse(projection * view);
+    glm::vec4 nearPoint = invViewProj * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = invViewProj * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+    glm::vec3 nearWorld = glm::vec3(nearPoint) / nearPoint.w;
+    glm::vec3 farWorld = glm::vec3(farPoint) / farPoint.w;
+
+    Ray ray;
+    ray.origin = nearWorld;
+    ray.direction = glm::normalize(farWorld - nearWorld);
+    return ray;
+}
+
+// Nearest intersection in front of the ray origin, if any
+inline bool intersectSphere(const Ray& ray, const glm::vec3& center, float radius, float& t) {
+    glm::vec3 oc = ray.origin - center;
+    float b = glm::dot(oc, ray.direction);
+    float c = glm::dot(oc, oc) - radius * radius;
+    float disc = b * b - c;
+    if (disc < 0.0f) return false;
+
+    float sq = sqrtf(disc);
+    t = -b - sq;
+    if (t < 0.0f) t = -b + sq;  // Origin inside the sphere
+    return t >= 0.0f;
+}
+
+#endif // RAY_H
@@ -0,0 +1,197 @@
+#ifndef RENDER_TARGETS_H
+#define RENDER_TARGETS_H
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+
+// A rectangle of the window, in framebuffer pixels from the lower left
+struct Viewport {
+    int x, y, width, height;
+    Viewport(int x = 0, int y = 0, int width = 0, int height = 0) : x(x), y(y), width(width), height(height) {}
+    float aspect() const { return height > 0 ? (float)width / (float)height : 1.0f; }
+};
+
+// Size and scale of a window. Kept up to date from GLFW's size callbacks,
+// so the frame loop reads plain fields instead of asking GLFW every frame.
+// On HiDPI displays the framebuffer has more pixels than the window has
+// screen coordinates (which is what cursor positions are in), and the
+// content scale says how much bigger text and overlays should be drawn.
+struct DisplayMetrics {
+    int windowWidth = 0, windowHeight = 0;            // Screen coordinates
+    int framebufferWidth = 0, framebufferHeight = 0;  // Pixels
+    float contentScale = 1.0f;
+
+    void query(GLFWwindow* window) {
+        glfwGetWindowSize(window, &windowWidth, &windowHeight);
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        float scaleY = 1.0f;
+        glfwGetWindowContentScale(window, &contentScale, &scaleY);
+    }
+
+    // Framebuffer pixels per screen coordinate, horizontally
+    float pixelRatio() const {
+        return windowWidth > 0 ? (float)framebufferWidth / (float)windowWidth : 1.0f;
+    }
+};
+
+// An offscreen framebuffer: a color texture, so later passes can sample
+// it, and optionally a depth renderbuffer
+class RenderTarget {
+public:
+    GLenum colorFormat = GL_RGBA8;
+    GLenum depthFormat = 0;  // 0 for none
+
+    bool allocate(int w, int h) {
+        release();
+        targetWidth = w;
+        targetHeight = h;
+
+        glGenTextures(1, &color);
+        glBindTexture(GL_TEXTURE_2D, color);
+        glTexImage2D(GL_TEXTURE_2D, 0, colorFormat, w, h, 0, GL_RGBA,
+                     colorFormat == GL_RGBA8 ? GL_UNSIGNED_BYTE : GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+        if (depthFormat) {
+            glGenRenderbuffers(1, &depth);
+            glBindRenderbuffer(GL_RENDERBUFFER, depth);
+            glRenderbufferStorage(GL_RENDERBUFFER, depthFormat, w, h);
+            glBindRenderbuffer(GL_RENDERBUFFER, 0);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        }
+        bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        if (!complete) std::cerr << "Render target incomplete (" << w << "x" << h << ")" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return complete;
+    }
+
+    // Draw into it, over its whole area
+    void bind() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, targetWidth, targetHeight);
+    }
+
+    // Copy the color into part of the window, stretching if the sizes differ
+    void blitTo(const Viewport& viewport) const {
+        bool sameSize = viewport.width == targetWidth && viewport.height == targetHeight;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, targetWidth, targetHeight,
+                          viewport.x, viewport.y, viewport.x + viewport.width, viewport.y + viewport.height,
+                          GL_COLOR_BUFFER_BIT, sameSize ? GL_NEAREST : GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    bool allocated() const { return framebuffer != 0; }
+    unsigned int framebufferId() const { return framebuffer; }
+    unsigned int colorTexture() const { return color; }
+    int width() const { return targetWidth; }
+    int height() const { return targetHeight; }
+
+    void release() {
+        if (framebuffer) glDeleteFramebuffers(1, &framebuffer);
+        if (color) glDeleteTextures(1, &color);
+        if (depth) glDeleteRenderbuffers(1, &depth);
+        framebuffer = color = depth = 0;
+        targetWidth = targetHeight = 0;
+    }
+
+private:
+    unsigned int framebuffer = 0, color = 0, depth = 0;
+    int targetWidth = 0, targetHeight = 0;
+};
+
+// Owns the render targets of one view and sizes them together.
+//
+// request() is called every frame with the view's size. A new size only
+// reallocates once it has held for settleSeconds, so dragging a window edge
+// does not reallocate every frame; until then the targets keep their old
+// size and are stretched into the view when presented. An unchanged size
+// costs two compares.
+class RenderTargetManager {
+public:
+    double settleSeconds = 0.15;
+    int reallocations = 0;  // Times the targets were resized
+
+    // A target sized at scale times the view; owned by the manager
+    RenderTarget* add(GLenum colorFormat, GLenum depthFormat, float scale = 1.0f) {
+        Entry entry;
+        entry.target = new RenderTarget();
+        entry.target->colorFormat = colorFormat;
+        entry.target->depthFormat = depthFormat;
+        entry.scale = scale;
+        entries.push_back(entry);
+        if (allocatedWidth > 0) allocate(entry, allocatedWidth, allocatedHeight);
+        return entry.target;
+    }
+
+    // Size the view wants this frame; true if the targets were reallocated
+    bool request(int width, int height) {
+        if (width == allocatedWidth && height == allocatedHeight) {
+            pendingWidth = pendingHeight = 0;
+            return false;
+        }
+        if (width <= 0 || height <= 0) return false;
+
+        // The first size is taken straight away
+        if (allocatedWidth > 0) {
+            if (width != pendingWidth || height != pendingHeight) {
+                pendingWidth = width;
+                pendingHeight = height;
+                pendingSince = Clock::now();
+                return false;
+            }
+            if (std::chrono::duration<double>(Clock::now() - pendingSince).count() < settleSeconds) return false;
+        }
+
+        allocatedWidth = width;
+        allocatedHeight = height;
+        pendingWidth = pendingHeight = 0;
+        for (Entry& entry : entries) allocate(entry, width, height);
+        ++reallocations;
+        return true;
+    }
+
+    // Size the targets were last allocated for (0 before the first request)
+    int width() const { return allocatedWidth; }
+    int height() const { return allocatedHeight; }
+
+    void cleanup() {
+        for (Entry& entry : entries) {
+            entry.target->release();
+            delete entry.target;
+        }
+        entries.clear();
+        allocatedWidth = allocatedHeight = 0;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry {
+        RenderTarget* target;
+        float scale;
+    };
+
+    std::vector<Entry> entries;
+    int allocatedWidth = 0, allocatedHeight = 0;
+    int pendingWidth = 0, pendingHeight = 0;
+    Clock::time_point pendingSince;
+
+    static void allocate(Entry& entry, int width, int height) {
+        entry.target->allocate(std::max(1, (int)(width * entry.scale)), std::max(1, (int)(height * entry.scale)));
+    }
+};
+
+#endif // RENDER_TARGETS_H
@@ -0,0 +1,465 @@
+#ifndef ROUTE_PLANNER_H
+#define ROUTE_PLANNER_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+#include "wind_field.h"
+#include "flight_model.h"
+#include "geodesy.h"
+
+// Unit vector for a latitude/longitude in degrees (globe shader convention)
+inline glm::vec3 latLonToDirection(float latDeg, float lonDeg) {
+    float lat = glm::radians(latDeg), lon = glm::radians(lonDeg);
+    return glm::vec3(cosf(lat) * cosf(lon), sinf(lat), cosf(lat) * sinf(lon));
+}
+
+// Great-circle angle between two unit vectors, stable for short arcs
+inline float arcAngle(const glm::vec3& a, const glm::vec3& b) {
+    return atan2f(glm::length(glm::cross(a, b)), glm::dot(a, b));
+}
+
+// Groundspeed along a track given true airspeed and the wind, m/s. The
+// aircraft crabs into the crosswind; zero when the crosswind is too strong.
+inline float trackGroundspeed(const glm::vec3& track, const glm::vec3& up,
+                              const glm::vec3& wind, float airspeed) {
+    glm::vec3 side = glm::cross(up, track);
+    float along = glm::dot(wind, track);
+    float cross = glm::dot(wind, side);
+    float remaining = airspeed * airspeed - cross * cross;
+    if (remaining <= 0.0f) return 0.0f;
+    return std::max(along + sqrtf(remaining), 0.0f);
+}
+
+// Icosphere graph with per-edge flight times for one cruise altitude and
+// airspeed. Adjacency is stored compressed: the edges leaving node i are
+// edgeStart[i] .. edgeStart[i + 1].
+class RouteGraph {
+public:
+    double planetRadius = EARTH_MEAN_RADIUS;  // Meters per globe unit, as in FlightModel
+    float cruiseAltitude = 10000.0f; // m
+    float airspeed = 230.0f;         // True airspeed, m/s
+
+    std::vector<glm::vec3> nodes;    // Unit vectors
+    std::vector<int> edgeStart;
+    std::vector<int> edgeTarget;
+    std::vector<float> edgeLength;   // m
+    std::vector<float> edgeTime;     // s
+    float maxGroundspeed = 0.0f;     // Upper bound over every edge, for the heuristic
+
+    // 10 * 4^subdivisions + 2 nodes; 5 gives about 220 km spacing on Earth
+    void build(int subdivisions) {
+        buildIcosphere(subdivisions);
+        setWind(nullptr);
+    }
+
+    // Recompute edge times from the winds at cruise altitude (calm when null)
+    void setWind(const WindField* wind) {
+        const size_t edges = edgeTarget.size();
+        std::vector<float> lat(edges), lon(edges), alt(edges, cruiseAltitude);
+        std::vector<float> u(edges, 0.0f), v(edges, 0.0f);
+        std::vector<glm::vec3> mid(edges);
+
+        for (size_t n = 0; n + 1 < edgeStart.size(); ++n) {
+            for (int e = edgeStart[n]; e < edgeStart[n + 1]; ++e) {
+                mid[e] = glm::normalize(nodes[n] + nodes[edgeTarget[e]]);
+                lat[e] = glm::degrees(asinf(glm::clamp(mid[e].y, -1.0f, 1.0f)));
+                lon[e] = glm::degrees(atan2f(mid[e].z, mid[e].x));
+            }
+        }
+        if (wind && !wind->empty()) {
+            wind->sampleBatch(lat.data(), lon.data(), alt.data(), u.data(), v.data(), edges);
+        }
+
+        edgeTime.resize(edges);
+        maxGroundspeed = airspeed;
+        for (size_t n = 0; n + 1 < edgeStart.size(); ++n) {
+            for (int e = edgeStart[n]; e < edgeStart[n + 1]; ++e) {
+                glm::vec3 east, north;
+                WindField::localBasis(mid[e], east, north);
+                glm::vec3 windVelocity = east * u[e] + north * v[e];
+                glm::vec3 delta = nodes[edgeTarget[e]] - nodes[n];
+                glm::vec3 track = glm::normalize(delta - mid[e] * glm::dot(delta, mid[e]));
+
+                float gs = trackGroundspeed(track, mid[e], windVelocity, airspeed);
+                edgeTime[e] = gs > 1.0f ? edgeLength[e] / gs : FLT_MAX;
+                maxGroundspeed = std::max(maxGroundspeed, airspeed + glm::length(windVelocity));
+            }
+        }
+        windField = wind;
+    }
+
+    // Closest grid node to a direction (linear scan, fine for thousands of queries)
+    int nearestNode(const glm::vec3& direction) const {
+        glm::vec3 d = glm::normalize(direction);
+        int best = 0;
+        float bestDot = -2.0f;
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            float c = glm::dot(nodes[i], d);
+            if (c > bestDot) { bestDot = c; best = (int)i; }
+        }
+        return best;
+    }
+
+    // Flight time straight along the great circle from a to b. By default the
+    // arc is split into pieces about one grid edge long.
+    double greatCircleTime(const glm::vec3& a, const glm::vec3& b, int segments = 0) const {
+        float angle = arcAngle(a, b);
+        if (angle < 1e-6f) return 0.0;
+        if (segments <= 0) {
+            float edgeAngle = edgeLength.empty() ? 0.05f : (float)(edgeLength[0] / planetRadius);
+            segments = std::max(1, (int)ceilf(angle / edgeAngle));
+        }
+        double total = 0.0;
+        for (int s = 0; s < segments; ++s) {
+            float t0 = (float)s / segments, t1 = (float)(s + 1) / segments;
+            glm::vec3 p0 = slerp(a, b, angle, t0), p1 = slerp(a, b, angle, t1);
+            glm::vec3 mid = glm::normalize(p0 + p1);
+            glm::vec3 track = glm::normalize(p1 - p0);
+
+            glm::vec3 windVelocity(0.0f);
+            if (windField && !windField->empty()) {
+                WindField::Sample w = windField->sample(glm::degrees(asinf(mid.y)),
+                                                        glm::degrees(atan2f(mid.z, mid.x)),
+                                                        cruiseAltitude);
+                glm::vec3 east, north;
+                WindField::localBasis(mid, east, north);
+                windVelocity = east * w.u + north * w.v;
+            }
+
+            float gs = trackGroundspeed(track, mid, windVelocity, airspeed);
+            if (gs <= 1.0f) return DBL_MAX;
+            total += angle / segments * planetRadius / gs;
+        }
+        return total;
+    }
+
+private:
+    const WindField* windField = nullptr;
+
+    static glm::vec3 slerp(const glm::vec3& a, const glm::vec3& b, float angle, float t) {
+        float s = sinf(angle);
+        return (a * sinf((1.0f - t) * angle) + b * sinf(t * angle)) / s;
+    }
+
+    void buildIcosphere(int subdivisions) {
+        const float t = (1.0f + sqrtf(5.0f)) / 2.0f;
+        nodes = {
+            {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+            {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+            {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+        };
+        for (glm::vec3& n : nodes) n = glm::normalize(n);
+
+        std::vector<unsigned int> tris = {
+            0, 11, 5,  0, 5, 1,  0, 1, 7,  0, 7, 10,  0, 10, 11,
+            1, 5, 9,  5, 11, 4,  11, 10, 2,  10, 7, 6,  7, 1, 8,
+            3, 9, 4,  3, 4, 2,  3, 2, 6,  3, 6, 8,  3, 8, 9,
+            4, 9, 5,  2, 4, 11,  6, 2, 10,  8, 6, 7,  9, 8, 1
+        };
+
+        for (int level = 0; level < subdivisions; ++level) {
+            std::map<uint64_t, unsigned int> midpoints;
+            std::vector<unsigned int> next;
+            next.reserve(tris.size() * 4);
+            for (size_t i = 0; i < tris.size(); i += 3) {
+                unsigned int a = tris[i], b = tris[i + 1], c = tris[i + 2];
+                unsigned int ab = midpoint(a, b, midpoints);
+                unsigned int bc = midpoint(b, c, midpoints);
+                unsigned int ca = midpoint(c, a, midpoints);
+                unsigned int sub[12] = {a, ab, ca,  b, bc, ab,  c, ca, bc,  ab, bc, ca};
+                next.insert(next.end(), sub, sub + 12);
+            }
+            tris.swap(next);
+        }
+
+        // Unique undirected edges, stored once in each direction
+        std::vector<std::vector<int> > adjacency(nodes.size());
+        for (size_t i = 0; i < tris.size(); i += 3) {
+            for (int k = 0; k < 3; ++k) {
+                unsigned int a = tris[i + k], b = tris[i + (k + 1) % 3];
+                adjacency[a].push_back((int)b);
+                adjacency[b].push_back((int)a);
+            }
+        }
+
+        edgeStart.assign(1, 0);
+        edgeTarget.clear();
+        edgeLength.clear();
+        for (size_t n = 0; n < nodes.size(); ++n) {
+            std::vector<int>& list = adjacency[n];
+            std::sort(list.begin(), list.end());
+            list.erase(std::unique(list.begin(), list.end()), list.end());
+            for (int m : list) {
+                edgeTarget.push_back(m);
+                edgeLength.push_back((float)(arcAngle(nodes[n], nodes[m]) * planetRadius));
+            }
+            edgeStart.push_back((int)edgeTarget.size());
+        }
+    }
+
+    unsigned int midpoint(unsigned int a, unsigned int b, std::map<uint64_t, unsigned int>& cache) {
+        uint64_t key = a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+        std::map<uint64_t, unsigned int>::iterator it = cache.find(key);
+        if (it != cache.end()) return it->second;
+        nodes.push_back(glm::normalize(nodes[a] + nodes[b]));
+        unsigned int index = (unsigned int)nodes.size() - 1;
+        cache[key] = index;
+        return index;
+    }
+};
+
+struct Route {
+    bool found = false;
+    std::vector<glm::vec3> waypoints;  // Unit vectors, origin first
+    double flightTime = 0.0;           // s
+    double distance = 0.0;             // m
+    size_t expanded = 0;               // Nodes taken off the open set
+};
+
+// Minimum-time A* over a RouteGraph. The heuristic is great-circle distance
+// at the best groundspeed anywhere on the grid, so it never overestimates.
+// All search state lives in buffers that are reused between searches: the
+// open set is a binary heap on a preallocated vector, and per-node scores are
+// invalidated by bumping a generation counter instead of being cleared.
+class RoutePlanner {
+public:
+    bool smooth = true;  // Replace runs of grid edges with direct arcs when faster
+
+    Route plan(const RouteGraph& graph, const glm::vec3& from, const glm::vec3& to) {
+        return planNodes(graph, graph.nearestNode(from), graph.nearestNode(to));
+    }
+
+    Route planNodes(const RouteGraph& graph, int start, int goal) {
+        Route route;
+        prepare(graph.nodes.size());
+
+        const glm::vec3 goalDir = graph.nodes[goal];
+        const float secondsPerRadian = (float)(graph.planetRadius / graph.maxGroundspeed);
+
+        open.clear();
+        visit(start);
+        gScore[start] = 0.0f;
+        pushOpen(start, arcAngle(graph.nodes[start], goalDir) * secondsPerRadian);
+
+        while (!open.empty()) {
+            OpenEntry top = popOpen();
+            int node = top.node;
+            if (closed[node] == generation) continue;  // Stale duplicate
+            closed[node] = generation;
+            ++route.expanded;
+
+            if (node == goal) break;
+
+            float g = gScore[node];
+            for (int e = graph.edgeStart[node]; e < graph.edgeStart[node + 1]; ++e) {
+                int next = graph.edgeTarget[e];
+                if (graph.edgeTime[e] == FLT_MAX) continue;
+                visit(next);
+                if (closed[next] == generation) continue;
+
+                float candidate = g + graph.edgeTime[e];
+                if (candidate < gScore[next]) {
+                    gScore[next] = candidate;
+                    cameFrom[next] = node;
+                    pushOpen(next, candidate + arcAngle(graph.nodes[next], goalDir) * secondsPerRadian);
+                }
+            }
+        }
+
+        if (closed[goal] != generation) return route;
+
+        route.found = true;
+        route.flightTime = gScore[goal];
+        pathTimes.clear();
+        for (int n = goal; n != -1; n = cameFrom[n]) {
+            route.waypoints.push_back(graph.nodes[n]);
+            pathTimes.push_back(gScore[n]);
+        }
+        std::reverse(route.waypoints.begin(), route.waypoints.end());
+        std::reverse(pathTimes.begin(), pathTimes.end());
+        if (smooth) smoothRoute(graph, route);
+
+        for (size_t i = 1; i < route.waypoints.size(); ++i) {
+            route.distance += arcAngle(route.waypoints[i - 1], route.waypoints[i]) * graph.planetRadius;
+        }
+        return route;
+    }
+
+private:
+    struct OpenEntry {
+        float f;
+        int node;
+        bool operator<(const OpenEntry& other) const { return f > other.f; }  // Min-heap
+    };
+
+    std::vector<OpenEntry> open;
+    std::vector<float> gScore;
+    std::vector<int> cameFrom;
+    std::vector<uint32_t> seen;    // Generation a node's gScore/cameFrom were last reset
+    std::vector<uint32_t> closed;  // Generation a node was last closed
+    uint32_t generation = 0;
+    std::vector<float> pathTimes;  // Arrival time at each waypoint
+
+    // Greedy string pulling: from each kept waypoint, jump to the farthest one
+    // that a direct great-circle leg reaches no later than the grid path does.
+    // The direct legs hide the 60-degree zigzag of the hexagonal grid.
+    void smoothRoute(const RouteGraph& graph, Route& route) {
+        const std::vector<glm::vec3>& path = route.waypoints;
+        if (path.size() < 2) return;  // Start is the goal
+        std::vector<glm::vec3> kept(1, path[0]);
+        double total = 0.0;
+
+        size_t i = 0;
+        while (i + 1 < path.size()) {
+            size_t best = i + 1;
+            double bestTime = pathTimes[i + 1] - pathTimes[i];
+            for (size_t j = i + 2; j < path.size(); ++j) {
+                double direct = graph.greatCircleTime(path[i], path[j]);
+                if (direct > pathTimes[j] - pathTimes[i]) break;
+                best = j;
+                bestTime = direct;
+            }
+            kept.push_back(path[best]);
+            total += bestTime;
+            i = best;
+        }
+
+        // The greedy pass stops at the first slower span, so also try one direct leg
+        if (path.size() > 2) {
+            double direct = graph.greatCircleTime(path.front(), path.back());
+            if (direct <= total) {
+                kept.assign(1, path.front());
+                kept.push_back(path.back());
+                total = direct;
+            }
+        }
+
+        route.waypoints.swap(kept);
+        route.flightTime = total;
+    }
+
+    void prepare(size_t nodeCount) {
+        if (gScore.size() != nodeCount) {
+            gScore.assign(nodeCount, FLT_MAX);
+            cameFrom.assign(nodeCount, -1);
+            seen.assign(nodeCount, 0);
+            closed.assign(nodeCount, 0);
+            generation = 0;
+            open.reserve(nodeCount);
+        }
+        ++generation;
+    }
+
+    void visit(int node) {
+        if (seen[node] != generation) {
+            seen[node] = generation;
+            gScore[node] = FLT_MAX;
+            cameFrom[node] = -1;
+        }
+    }
+
+    void pushOpen(int node, float f) {
+        OpenEntry entry = {f, node};
+        open.push_back(entry);
+        std::push_heap(open.begin(), open.end());
+    }
+
+    OpenEntry popOpen() {
+        std::pop_heap(open.begin(), open.end());
+        OpenEntry top = open.back();
+        open.pop_back();
+        return top;
+    }
+};
+
+// Plans many origin/destination pairs across worker threads, each with its own
+// planner. Routes come back in the same order as the pairs.
+inline void planRoutes(const RouteGraph& graph,
+                       const std::vector<std::pair<glm::vec3, glm::vec3> >& pairs,
+                       std::vector<Route>& routes, unsigned int threadCount = 0) {
+    routes.assign(pairs.size(), Route());
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<unsigned int>(threadCount, (unsigned int)std::max<size_t>(pairs.size(), 1));
+
+    std::atomic<size_t> nextPair(0);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threadCount; ++t) {
+        workers.push_back(std::thread([&] {
+            RoutePlanner planner;
+            for (size_t i = nextPair++; i < pairs.size(); i = nextPair++) {
+                routes[i] = planner.plan(graph, pairs[i].first, pairs[i].second);
+            }
+        }));
+    }
+    for (std::thread& worker : workers) worker.join();
+}
+
+// Steers a FlightModel aircraft along a route by setting its target bank.
+// It chases a point a fixed distance ahead on the route, which smooths the
+// zigzag of grid edges into gentle turns.
+class RouteFollower {
+public:
+    float lookahead = 300000.0f;              // m along the route, a little over one grid edge
+    float bankGain = 1.5f;                    // Radians of bank per radian of track error
+    float maxBank = glm::radians(25.0f);
+
+    void setRoute(const Route& newRoute) {
+        route = newRoute;
+        nextWaypoint = route.waypoints.empty() ? 0 : 1;
+    }
+
+    bool finished() const { return nextWaypoint >= route.waypoints.size(); }
+
+    void update(FlightModel& model, size_t aircraft) {
+        if (finished()) {
+            model.targetBank[aircraft] = 0.0;
+            return;
+        }
+
+        glm::vec3 up = glm::normalize(glm::vec3(model.position(aircraft)));
+        const double radius = model.planetRadius;
+
+        // Drop waypoints that are already behind
+        while (nextWaypoint < route.waypoints.size()) {
+            glm::vec3 prev = route.waypoints[nextWaypoint - 1];
+            glm::vec3 next = route.waypoints[nextWaypoint];
+            if (glm::dot(up - next, prev - next) > 0.0f && arcAngle(up, next) * radius > lookahead * 0.25f) break;
+            ++nextWaypoint;
+        }
+        if (finished()) return;
+
+        // Walk the route until the lookahead distance is used up
+        float remaining = lookahead;
+        glm::vec3 target = route.waypoints[nextWaypoint];
+        remaining -= (float)(arcAngle(up, target) * radius);
+        for (size_t w = nextWaypoint + 1; w < route.waypoints.size() && remaining > 0.0f; ++w) {
+            remaining -= (float)(arcAngle(target, route.waypoints[w]) * radius);
+            target = route.waypoints[w];
+        }
+
+        // Signed angle from the current ground track to the target, positive to the left
+        glm::vec3 velocity = glm::vec3(model.velocity(aircraft));
+        glm::vec3 track = velocity - up * glm::dot(velocity, up);
+        glm::vec3 desired = target - up * glm::dot(target, up);
+        if (glm::dot(track, track) < 1e-6f || glm::dot(desired, desired) < 1e-12f) return;
+        track = glm::normalize(track);
+        desired = glm::normalize(desired);
+        float error = atan2f(glm::dot(glm::cross(track, desired), up), glm::dot(track, desired));
+
+        model.targetBank[aircraft] = glm::clamp(-bankGain * error, -maxBank, maxBank);
+    }
+
+private:
+    Route route;
+    size_t nextWaypoint = 0;
+};
+
+#endif // ROUTE_PLANNER_H
@@ -0,0 +1,417 @@
+#ifndef SCENE_RENDERER_H
+#define SCENE_RENDERER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <vector>
+
+#include "shaders.h"
+#include "shader_utils.h"
+#include "sphere.h"
+#include "camera.h"
+#include "fleet.h"
+#include "aircraft_renderer.h"
+#include "label_renderer.h"
+#include "depth_buffer.h"
+#include "hdr_pipeline.h"
+#include "globe_impostor.h"
+#include "render_targets.h"
+#include "shadow_maps.h"
+#include "profiler.h"
+
+// Everything drawn in one frame: shadow cascades, the globe, the traffic and
+// its callsign labels, then the HDR post chain.
+// Shared by the viewer and the headless frame benchmark.
+class SceneRenderer {
+public:
+    AircraftRenderer aircraftRenderer;
+    LabelRenderer labelRenderer;
+    CascadedShadowMaps shadows;
+    DepthBuffer depthBuffer;
+    HdrPipeline hdr;              // Set hdr.enabled before init
+    GlobeImpostor impostor;       // The globe as a sprite from far away
+    RenderTargetManager targets;  // Offscreen targets sized to the main view
+    Profiler profiler;
+    FrameStats stats;  // Last frame's draw calls and triangles
+
+    float fieldOfView = glm::radians(45.0f);  // Vertical
+    bool rayCastGlobe = false;  // Intersect the sphere per pixel instead of drawing the mesh; live
+
+    // Projections of the main view and of renderExtraView, rebuilt only when they change
+    ProjectionCache mainProjection, extraProjection;
+
+    void init(double planetRadius, bool reversedZ, int sectors = 72, int stacks = 36) {
+        hdr.init();
+        depthBuffer.init(reversedZ, targets, hdr.colorFormat());
+        impostor.init(hdr.colorFormat(), depthBuffer.reversedZ);
+        shadows.depthZeroToOne = depthBuffer.reversedZ;
+        shadows.init();
+        profiler.init();
+        aircraftRenderer.init();
+        labelRenderer.init();
+
+        meshProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
+        rayCastProgram = createShaderProgram(rayCastVertexShaderSource,
+                                             withDefine(fragmentShaderSource, "RAY_CAST").c_str());
+
+        globeRadius = planetRadius;
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+        setGlobeResolution(sectors, stacks);
+        createGlobeVertexArray();
+        selectGlobeProgram();
+    }
+
+    // Init for another window whose context shares objects with source's
+    // (glfwCreateWindow's share argument); make that context current first.
+    // Shader programs, the globe and dart meshes and the label atlas are
+    // used from source as they are. Vertex arrays, framebuffers and timer
+    // queries are not shared between contexts, and the shadow cascades and
+    // culled instance lists belong to this window's camera, so those are
+    // made here. source must outlive this renderer.
+    void initShared(const SceneRenderer& source, bool reversedZ) {
+        fieldOfView = source.fieldOfView;
+        hdr.initShared(source.hdr);
+        depthBuffer.init(reversedZ, targets, hdr.colorFormat());
+        impostor.initShared(source.impostor, hdr.colorFormat(), depthBuffer.reversedZ);
+        shadows.depthZeroToOne = depthBuffer.reversedZ;
+        shadows.init();
+        profiler.init();
+        aircraftRenderer.initShared(source.aircraftRenderer);
+        labelRenderer.initShared(source.labelRenderer);
+
+        sharesObjects = true;
+        meshProgram = source.meshProgram;
+        rayCastProgram = source.rayCastProgram;
+        VBO = source.VBO;
+        EBO = source.EBO;
+        globeSource = &source;
+        createGlobeVertexArray();
+        rayCastGlobe = source.rayCastGlobe;
+        selectGlobeProgram();
+    }
+
+    // Projection for the active depth mode
+    glm::mat4 projection(const RenderView& view, float aspect) const {
+        return depthBuffer.reversedZ ? view.reversedProjection(fieldOfView, aspect)
+                                     : view.projection(fieldOfView, aspect);
+    }
+
+    // Draw one frame into the window's framebuffer (width x height pixels).
+    // sunDirection points from the globe center toward the sun, in the globe frame.
+    void renderFrame(const RenderView& renderView, const glm::dvec3& sunDirection, const Fleet& fleet,
+                     int width, int height) {
+        renderFrame(renderView, sunDirection, fleet, Viewport(0, 0, width, height));
+    }
+
+    // Same, into part of the window
+    void renderFrame(const RenderView& renderView, const glm::dvec3& sunDirection, const Fleet& fleet,
+                     const Viewport& viewport) {
+        profiler.beginFrame();
+        stats = FrameStats();
+        if ((shaderProgram == rayCastProgram) != rayCastGlobe) selectGlobeProgram();
+        targets.request(viewport.width, viewport.height);
+
+        // Set up matrices. Everything is drawn relative to the eye, so the
+        // view matrix is a pure rotation.
+        float aspect = viewport.aspect();
+        glm::mat4 view = renderView.rotation;
+        const glm::mat4& proj = mainProjection.get(renderView, fieldOfView, aspect, depthBuffer.reversedZ);
+
+        // Cull the traffic once; the camera pass and the shadow cascades share the list
+        aircraftRenderer.update(fleet, renderView, proj * view,
+                                glm::vec3(-sunDirection * shadows.casterReach));
+
+        long long aircraftTriangles = (long long)aircraftRenderer.visibleCount() * aircraftRenderer.trianglesPerInstance();
+        long long culledTriangles = (long long)aircraftRenderer.culledCount() * aircraftRenderer.trianglesPerInstance();
+
+        // Shadow cascades that are due this frame
+        shadows.update(renderView, fieldOfView, aspect, sunDirection);
+        for (int c = 0; c < CascadedShadowMaps::CASCADES; ++c) {
+            if (!shadows.needsRender(c)) continue;
+            profiler.begin(cascadeScope(c));
+            shadows.beginCascade(c);
+            aircraftRenderer.drawDepth(shadows.lightMatrix(c), fleet.metersPerUnit);
+            profiler.end();
+            countDraw(aircraftTriangles, culledTriangles);
+        }
+        shadows.endCascades(viewport.width, viewport.height);
+
+        // A distant globe is drawn as a sprite; first render the bands of its picture that are due
+        bool globeSprite = impostor.begin(renderView, sunDirection, fieldOfView, viewport.height);
+        if (globeSprite && impostor.redrawDue()) {
+            profiler.begin("impostor refresh");
+            RenderView sliceView;
+            glm::mat4 sliceProjection;
+            glm::dvec3 sliceSun;
+            while (impostor.beginSlice(sliceView, sliceProjection, sliceSun)) {
+                drawGlobe(sliceView, sliceSun, sliceView.rotation, sliceProjection);
+                impostor.endSlice();
+            }
+            profiler.end();
+        }
+
+        // Clear
+        depthBuffer.beginFrame(viewport);
+        const int width = depthBuffer.drawWidth(viewport), height = depthBuffer.drawHeight(viewport);
+        glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        if (globeSprite) {
+            profiler.begin("globe impostor");
+            impostor.draw(renderView, view, proj);
+            profiler.end();
+            countDraw(2, 0);
+        } else {
+            profiler.begin("globe");
+            drawGlobe(renderView, sunDirection, view, proj);
+            profiler.end();
+        }
+
+        // Draw aircraft
+        profiler.begin("aircraft");
+        drawAircraft(renderView, sunDirection, fleet, view, proj);
+        profiler.end();
+        countDraw(aircraftTriangles, culledTriangles);
+
+        // Callsigns over the traffic
+        if (labelRenderer.visible) {
+            profiler.begin("labels");
+            labelRenderer.update(fleet, renderView, proj * view, width, height, aircraftRenderer.selectedAircraft);
+            labelRenderer.draw(width, height);
+            profiler.end();
+            countDraw(2 * (long long)labelRenderer.visibleCount(), 0);
+        }
+
+        // HDR goes through the post chain, which times its own passes
+        if (hdr.enabled) {
+            hdr.resolve(*depthBuffer.target(), viewport, profiler);
+            return;
+        }
+        profiler.begin("present");
+        depthBuffer.endFrame();
+        profiler.end();
+    }
+
+    // Draw another camera's view of the same frame into the bound framebuffer
+    // (width x height pixels, shown at aspect), after renderFrame. The
+    // traffic is culled again for this view, but it reuses the shadow
+    // cascades renderFrame fitted and skips the labels. Counted into stats
+    // and timed as one profiler scope.
+    void renderExtraView(const RenderView& renderView, const glm::dvec3& sunDirection, const Fleet& fleet,
+                         int width, int height, float aspect, const char* scope = "extra view") {
+        profiler.begin(scope);
+        glm::mat4 view = renderView.rotation;
+        const glm::mat4& proj = extraProjection.get(renderView, fieldOfView, aspect, depthBuffer.reversedZ);
+
+        aircraftRenderer.update(fleet, renderView, proj * view, glm::vec3(0.0f));
+        long long aircraftTriangles = (long long)aircraftRenderer.visibleCount() * aircraftRenderer.trianglesPerInstance();
+        long long culledTriangles = (long long)aircraftRenderer.culledCount() * aircraftRenderer.trianglesPerInstance();
+
+        glViewport(0, 0, width, height);
+        glDepthFunc(depthBuffer.reversedZ ? GL_GREATER : GL_LESS);
+        glClearDepth(depthBuffer.reversedZ ? 0.0 : 1.0);
+        glClearColor(0.05f, 0.05f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        drawGlobe(renderView, sunDirection, view, proj);
+        drawAircraft(renderView, sunDirection, fleet, view, proj);
+        profiler.end();
+        countDraw(aircraftTriangles, culledTriangles);
+    }
+
+    // Retessellate the globe. Renderers sharing this one's objects pick the
+    // new mesh up too; calling this on one of them does nothing.
+    void setGlobeResolution(int sectors, int stacks) {
+        if (sharesObjects || (sectors == globeSectors && stacks == globeStacks)) return;
+        globeSectors = sectors;
+        globeStacks = stacks;
+        impostor.invalidate();
+
+        // Generate sphere at its true size, as high/low float pairs
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        generateSphereSplit(globeRadius, sectors, stacks, vertices, indices);
+        indexCount = (int)indices.size();
+
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+        // Indices go in through the array target; the element binding is vertex array state
+        glBindBuffer(GL_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // Other contexts only see the new data once this one has finished writing it
+        glFinish();
+    }
+
+    void cleanup() {
+        aircraftRenderer.cleanup();
+        labelRenderer.cleanup();
+        depthBuffer.cleanup();
+        impostor.cleanup();
+        hdr.cleanup();
+        targets.cleanup();
+        shadows.cleanup();
+        profiler.cleanup();
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteVertexArrays(1, &rayCastVAO);
+        if (sharesObjects) return;
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        glDeleteProgram(meshProgram);
+        glDeleteProgram(rayCastProgram);
+    }
+
+private:
+    bool sharesObjects = false;  // Globe programs and mesh belong to another renderer
+    unsigned int meshProgram = 0, rayCastProgram = 0;
+    unsigned int shaderProgram = 0;  // The globe program in use, one of the two
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int rayCastVAO = 0;     // Empty; the octagon comes from gl_VertexID
+    int indexCount = 0;
+    double globeRadius = 1.0;
+    int globeSectors = 0, globeStacks = 0;
+    const SceneRenderer* globeSource = nullptr;  // Owner of the shared globe mesh
+    int eyeHighLoc = -1, eyeLowLoc = -1, viewLoc = -1, projLoc = -1;
+    int sunPosLoc = -1, moonPosLoc = -1, sunColorLoc = -1, moonColorLoc = -1, viewPosLoc = -1;
+    int centerLoc = -1, rightLoc = -1, upLoc = -1, halfSizeLoc = -1, eyeTermLoc = -1;
+    int radiusLoc = -1, zeroToOneLoc = -1;
+
+    // Switch the globe between the mesh and the ray-cast program. The
+    // uniform locations differ between the two, so the shadow receiver is
+    // attached again too.
+    void selectGlobeProgram() {
+        shaderProgram = rayCastGlobe ? rayCastProgram : meshProgram;
+        eyeHighLoc = glGetUniformLocation(shaderProgram, "eyeHigh");
+        eyeLowLoc = glGetUniformLocation(shaderProgram, "eyeLow");
+        viewLoc = glGetUniformLocation(shaderProgram, "view");
+        projLoc = glGetUniformLocation(shaderProgram, "projection");
+        sunPosLoc = glGetUniformLocation(shaderProgram, "sunPos");
+        moonPosLoc = glGetUniformLocation(shaderProgram, "moonPos");
+        sunColorLoc = glGetUniformLocation(shaderProgram, "sunColor");
+        moonColorLoc = glGetUniformLocation(shaderProgram, "moonColor");
+        viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos");
+        centerLoc = glGetUniformLocation(shaderProgram, "center");
+        rightLoc = glGetUniformLocation(shaderProgram, "right");
+        upLoc = glGetUniformLocation(shaderProgram, "up");
+        halfSizeLoc = glGetUniformLocation(shaderProgram, "halfSize");
+        eyeTermLoc = glGetUniformLocation(shaderProgram, "eyeTerm");
+        radiusLoc = glGetUniformLocation(shaderProgram, "radius");
+        zeroToOneLoc = glGetUniformLocation(shaderProgram, "zeroToOne");
+        shadows.attachReceiver(shaderProgram);
+    }
+
+    void createGlobeVertexArray() {
+        glGenVertexArrays(1, &VAO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        // Position attributes (high and low parts)
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // Normal attribute
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(0);
+
+        glGenVertexArrays(1, &rayCastVAO);
+    }
+
+    // view is the rotation-only matrix of renderView
+    void drawGlobe(const RenderView& renderView, const glm::dvec3& sunDirection,
+                   const glm::mat4& view, const glm::mat4& proj) {
+        // Sun and moon positions (opposite sides)
+        glm::vec3 sunPos = renderView.relative(sunDirection * (5.0 * renderView.planetRadius));
+        glm::vec3 moonPos = renderView.relative(sunDirection * (-5.0 * renderView.planetRadius));
+
+        glUseProgram(shaderProgram);
+
+        // Set uniforms
+        glm::vec3 eyeHigh, eyeLow;
+        splitDouble(renderView.eye, eyeHigh, eyeLow);
+        glUniform3f(eyeHighLoc, eyeHigh.x, eyeHigh.y, eyeHigh.z);
+        glUniform3f(eyeLowLoc, eyeLow.x, eyeLow.y, eyeLow.z);
+        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(proj));
+        glUniform3f(sunPosLoc, sunPos.x, sunPos.y, sunPos.z);
+        glUniform3f(moonPosLoc, moonPos.x, moonPos.y, moonPos.z);
+
+        // Light colors
+        glUniform3f(sunColorLoc, 1.0f, 0.9f, 0.7f);  // Warm yellow
+        glUniform3f(moonColorLoc, 0.7f, 0.8f, 1.0f); // Cool blue-white
+
+        // Camera/view position for rim lighting; the eye is the origin
+        glUniform3f(viewPosLoc, 0.0f, 0.0f, 0.0f);
+        shadows.bindReceiver(1, renderView);
+
+        if (shaderProgram == rayCastProgram) {
+            drawRayCastGlobe(renderView);
+            return;
+        }
+
+        // Draw sphere
+        glBindVertexArray(VAO);
+        int count = globeSource ? globeSource->indexCount : indexCount;
+        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0);
+        countDraw(count / 3, 0);
+    }
+
+    // The octagon around the globe's outline (see rayCastVertexShaderSource);
+    // the eye must be outside the globe. The octagon sits a planet radius
+    // out, past the standard-Z far plane near the ground, so depth clamping
+    // keeps it from being clipped; the written hit depth is within range.
+    void drawRayCastGlobe(const RenderView& renderView) {
+        double distance = glm::length(renderView.eye) / renderView.planetRadius;
+        double eyeTerm = (distance - 1.0) * (distance + 1.0);
+        if (eyeTerm <= 0.0) return;
+        glm::dvec3 forward = -renderView.eye / (distance * renderView.planetRadius);
+        glm::dvec3 upHint = fabs(forward.y) > 0.99 ? glm::dvec3(1.0, 0.0, 0.0) : glm::dvec3(0.0, 1.0, 0.0);
+        glm::vec3 right = glm::vec3(glm::normalize(glm::cross(forward, upHint)));
+        glm::vec3 up = glm::cross(right, glm::vec3(forward));
+        glm::vec3 center = glm::vec3(forward * distance);
+
+        glUniform3f(centerLoc, center.x, center.y, center.z);
+        glUniform3f(rightLoc, right.x, right.y, right.z);
+        glUniform3f(upLoc, up.x, up.y, up.z);
+        glUniform1f(halfSizeLoc, (float)(distance / sqrt(eyeTerm)));
+        glUniform1f(eyeTermLoc, (float)eyeTerm);
+        glUniform1f(radiusLoc, (float)renderView.planetRadius);
+        glUniform1i(zeroToOneLoc, depthBuffer.reversedZ ? 1 : 0);
+
+        glBindVertexArray(rayCastVAO);
+        glEnable(GL_DEPTH_CLAMP);
+        glDrawArrays(GL_TRIANGLE_FAN, 0, 8);
+        glDisable(GL_DEPTH_CLAMP);
+        countDraw(6, 0);
+    }
+
+    void drawAircraft(const RenderView& renderView, const glm::dvec3& sunDirection, const Fleet& fleet,
+                      const glm::mat4& view, const glm::mat4& proj) {
+        glm::vec3 sunPos = renderView.relative(sunDirection * (5.0 * renderView.planetRadius));
+        aircraftRenderer.draw(view, proj, fleet.metersPerUnit, sunPos, glm::vec3(1.0f, 0.9f, 0.7f));
+    }
+
+    void countDraw(long long triangles, long long culled) {
+        if (triangles > 0) ++stats.drawCalls;
+        stats.trianglesDrawn += triangles;
+        stats.trianglesCulled += culled;
+    }
+
+    // Profiler scope name for a shadow cascade
+    static const char* cascadeScope(int cascade) {
+        static const char* const names[CascadedShadowMaps::CASCADES] = {
+            "shadow cascade 0", "shadow cascade 1", "shadow cascade 2"
+        };
+        return names[cascade];
+    }
+};
+
+#endif // SCENE_RENDERER_H
@@ -0,0 +1,127 @@
+#ifndef SECONDARY_VIEW_H
+#define SECONDARY_VIEW_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+#include "camera.h"
+#include "fleet.h"
+#include "scene_renderer.h"
+#include "render_targets.h"
+
+// The other camera of a viewer: the orbit view hanging over the plane view
+// aircraft while flying, or the cockpit while orbiting.
+inline RenderView companionView(const Camera& camera) {
+    Camera other = camera;
+    other.manualControl = !camera.manualControl;
+    if (other.manualControl && other.flightModel) {
+        glm::dvec3 d = glm::normalize(other.flightModel->position(other.followAircraft));
+        other.globeRotationX = other.globeRotationY = 0.0f;
+        other.cameraAngleX = (float)atan2(d.x, d.z);
+        other.cameraAngleY = (float)asin(d.y);
+    }
+    return other.getRenderView(0.0f);
+}
+
+// A second view of the scene drawn next to the main one, either as a
+// picture-in-picture inset or the right half of a split screen.
+//
+// It renders offscreen at resolutionScale of its on-screen size and only
+// every updateInterval frames; in between, the last image is scaled into
+// place again, which costs one blit (or one tonemap pass with HDR).
+// Culling and uniforms are per view; the shadow cascades are shared with
+// the main view.
+class SecondaryView {
+public:
+    enum Layout { OFF, PICTURE_IN_PICTURE, SPLIT_SCREEN, LAYOUT_COUNT };
+
+    Layout layout = OFF;
+    float resolutionScale = 0.5f;  // Offscreen size relative to the on-screen view
+    int updateInterval = 2;        // Frames between renders
+    float insetSize = 0.33f;       // Picture-in-picture size as a fraction of the window
+    int insetMargin = 16;          // Pixels from the window corner
+
+    // Frames the view was rendered and frames it reused the last image
+    long long renderedFrames = 0;
+    long long reusedFrames = 0;
+
+    bool enabled() const { return layout != OFF; }
+
+    void cycleLayout() {
+        layout = (Layout)((layout + 1) % LAYOUT_COUNT);
+        static const char* const names[LAYOUT_COUNT] = {"off", "picture-in-picture", "split screen"};
+        std::cout << "Second view: " << names[layout] << std::endl;
+    }
+
+    // Divide a width x height window between the main view and this one
+    void layoutViewports(int width, int height, Viewport& main, Viewport& inset) const {
+        main = Viewport(0, 0, width, height);
+        inset = Viewport();
+        if (layout == SPLIT_SCREEN) {
+            main.width = width / 2;
+            inset = Viewport(main.width, 0, width - main.width, height);
+        } else if (layout == PICTURE_IN_PICTURE) {
+            int w = (int)(width * insetSize), h = (int)(height * insetSize);
+            inset = Viewport(width - w - insetMargin, height - h - insetMargin, w, h);
+        }
+    }
+
+    // Bring the offscreen image up to date for this frame, if it is due.
+    // Call after the main view's SceneRenderer::renderFrame.
+    void render(SceneRenderer& scene, const RenderView& view, const glm::dvec3& sunDirection,
+                const Fleet& fleet, const Viewport& viewport) {
+        if (!enabled() || viewport.width <= 0 || viewport.height <= 0) return;
+
+        // Float depth works with either depth mode; the color matches the main view's
+        if (!target) target = targets.add(scene.hdr.colorFormat(), GL_DEPTH_COMPONENT32F);
+        int width = std::max(1, (int)(viewport.width * resolutionScale));
+        int height = std::max(1, (int)(viewport.height * resolutionScale));
+        bool resized = targets.request(width, height);
+        if (!resized && ++framesSinceRender < updateInterval) {
+            ++reusedFrames;
+            return;
+        }
+
+        target->bind();
+        scene.renderExtraView(view, sunDirection, fleet, target->width(), target->height(), viewport.aspect(),
+                              "second view");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        framesSinceRender = 0;
+        ++renderedFrames;
+    }
+
+    // Scale the last image into its place in the window; an HDR image is
+    // tonemapped with the main view's exposure
+    void present(SceneRenderer& scene, const Viewport& viewport) {
+        if (!enabled() || !target || !target->allocated() || viewport.width <= 0 || viewport.height <= 0) return;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (layout == PICTURE_IN_PICTURE) {
+            // Thin frame so the inset reads as separate from the scene behind it
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(viewport.x - 2, viewport.y - 2, viewport.width + 4, viewport.height + 4);
+            glClearColor(0.6f, 0.6f, 0.65f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glDisable(GL_SCISSOR_TEST);
+        }
+
+        if (scene.hdr.enabled) scene.hdr.tonemap(*target, viewport);
+        else target->blitTo(viewport);
+    }
+
+    void cleanup() {
+        targets.cleanup();
+        target = nullptr;
+        framesSinceRender = 0;
+    }
+
+private:
+    RenderTargetManager targets;
+    RenderTarget* target = nullptr;
+    int framesSinceRender = 0;
+};
+
+#endif // SECONDARY_VIEW_H
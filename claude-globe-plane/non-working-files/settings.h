@@ -0,0 +1,157 @@
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <string>
+#include <iostream>
+#include <algorithm>
+
+#include "config_file.h"
+
+// Everything the viewer lets a deployment tune, with the built-in defaults.
+// See plane_sim.conf for the keys. Settings marked "restart" are read once
+// at startup; the rest are applied live when the config file changes.
+struct Settings {
+    // [window]
+    int windowWidth = 800;
+    int windowHeight = 600;
+    int outputWindows = 0;            // Restart; extra windows with their own cameras
+    bool fullscreen = false;          // Restart
+
+    // [render]
+    float fieldOfView = 45.0f;        // Vertical, degrees
+    bool reversedZ = true;            // Restart
+    bool hdr = true;                  // Restart; half-float scene with auto-exposure
+    float exposureKey = 0.18f;        // Average luminance the exposure aims for
+    float exposureAdaptation = 1.5f;  // Per second
+    double postBudgetMs = 0.5;        // GPU time for the HDR post chain
+    bool impostor = true;             // Draw a distant globe as a cached sprite
+    int impostorMaxPixels = 384;      // Largest globe diameter on screen drawn as a sprite
+    float impostorDrift = 0.5f;       // Degrees the eye or sun turns before the sprite is redrawn
+    int impostorSlices = 4;           // Frames a sprite redraw is spread over
+    int globeSectors = 72;            // Globe tessellation
+    int globeStacks = 36;
+    bool globeRayCast = false;        // Intersect the sphere per pixel instead of drawing the mesh
+    int shadowResolution = 2048;      // Restart; texels per cascade side
+    double shadowDistance = 20000000.0;       // Meters
+    int shadowInterval[3] = {1, 2, 4};        // Frames between cascade refits
+    float aircraftScale = 0.012f;     // Dart length, globe units
+    bool labels = true;
+    float labelScale = 2.0f;          // Screen pixels per font pixel
+    float secondViewScale = 0.5f;     // Offscreen resolution of the second view
+    int secondViewInterval = 2;       // Frames between second view renders
+    double hudRefresh = 0.25;         // Seconds
+    double reportInterval = 2.0;      // Seconds between console reports
+    bool onDemand = true;             // Draw only when something changed
+    double idleWait = 0.5;            // Longest wait for events while idle, seconds
+
+    // [simulation]
+    int fleetSize = 2000;             // Restart
+    double timeScale = 60.0;          // Simulated seconds per real second
+    double cruiseAltitude = 10000.0;  // Restart; meters
+
+    // [threads]
+    int landMaskThreads = 0;          // Restart; 0 uses every core
+
+    // [cache]
+    int ingestBatchSize = 4096;       // Restart; records per ingest buffer
+    int ingestMaxBatches = 1024;      // Restart; buffers queued before the reader stalls
+    int telemetrySlots = 4;           // Restart; snapshots in the shared ring
+
+    // [camera]
+    double speedStep = 1.0;           // Autopilot target change per frame held, m/s
+    double altitudeStep = 50.0;       // Meters
+    double minSpeed = 150.0, maxSpeed = 300.0;            // m/s
+    double minAltitude = 1000.0, maxAltitude = 40000.0;   // Meters
+    float rotateSpeed = 0.02f;        // Globe rotation per frame held, radians
+    float mouseSensitivity = 0.01f;   // Radians per pixel dragged
+    float zoomStep = 0.1f;            // Globe radii per scroll step
+    float minDistance = 1.5f, maxDistance = 10.0f;        // Globe radii
+
+    // Take whatever the file sets, clamped to workable ranges
+    void read(const ConfigFile& config) {
+        windowWidth = std::max(64, config.integer("window.width", windowWidth));
+        windowHeight = std::max(64, config.integer("window.height", windowHeight));
+        outputWindows = std::max(0, config.integer("window.output_windows", outputWindows));
+        fullscreen = config.flag("window.fullscreen", fullscreen);
+
+        fieldOfView = clamp((float)config.number("render.field_of_view", fieldOfView), 10.0f, 120.0f);
+        reversedZ = config.flag("render.reversed_z", reversedZ);
+        hdr = config.flag("render.hdr", hdr);
+        exposureKey = clamp((float)config.number("render.exposure_key", exposureKey), 0.01f, 1.0f);
+        exposureAdaptation = std::max(0.01f, (float)config.number("render.exposure_adaptation", exposureAdaptation));
+        postBudgetMs = std::max(0.01, config.number("render.post_budget_ms", postBudgetMs));
+        impostor = config.flag("render.impostor", impostor);
+        impostorMaxPixels = clamp(config.integer("render.impostor_max_pixels", impostorMaxPixels), 16, 4096);
+        impostorDrift = clamp((float)config.number("render.impostor_drift", impostorDrift), 0.01f, 10.0f);
+        impostorSlices = clamp(config.integer("render.impostor_slices", impostorSlices), 1, 16);
+        globeSectors = clamp(config.integer("render.globe_sectors", globeSectors), 8, 2048);
+        globeStacks = clamp(config.integer("render.globe_stacks", globeStacks), 4, 1024);
+        globeRayCast = config.flag("render.globe_ray_cast", globeRayCast);
+        shadowResolution = clamp(config.integer("render.shadow_resolution", shadowResolution), 256, 8192);
+        shadowDistance = std::max(1000.0, config.number("render.shadow_distance", shadowDistance));
+        for (int c = 0; c < 3; ++c) {
+            std::string key = "render.shadow_interval_" + std::to_string(c);
+            shadowInterval[c] = std::max(1, config.integer(key, shadowInterval[c]));
+        }
+        aircraftScale = std::max(0.0f, (float)config.number("render.aircraft_scale", aircraftScale));
+        labels = config.flag("render.labels", labels);
+        labelScale = clamp((float)config.number("render.label_scale", labelScale), 1.0f, 8.0f);
+        secondViewScale = clamp((float)config.number("render.second_view_scale", secondViewScale), 0.1f, 1.0f);
+        secondViewInterval = std::max(1, config.integer("render.second_view_interval", secondViewInterval));
+        hudRefresh = std::max(0.0, config.number("render.hud_refresh", hudRefresh));
+        reportInterval = std::max(0.1, config.number("render.report_interval", reportInterval));
+        onDemand = config.flag("render.on_demand", onDemand);
+        idleWait = clamp(config.number("render.idle_wait", idleWait), 0.01, 5.0);
+
+        fleetSize = std::max(0, config.integer("simulation.fleet_size", fleetSize));
+        timeScale = std::max(0.0, config.number("simulation.time_scale", timeScale));
+        cruiseAltitude = clamp(config.number("simulation.cruise_altitude", cruiseAltitude), 100.0, 20000.0);
+
+        landMaskThreads = std::max(0, config.integer("threads.land_mask", landMaskThreads));
+
+        ingestBatchSize = std::max(1, config.integer("cache.ingest_batch_size", ingestBatchSize));
+        ingestMaxBatches = std::max(1, config.integer("cache.ingest_max_batches", ingestMaxBatches));
+        telemetrySlots = std::max(2, config.integer("cache.telemetry_slots", telemetrySlots));
+
+        speedStep = clamp(config.number("camera.speed_step", speedStep), 0.0, 100.0);
+        altitudeStep = clamp(config.number("camera.altitude_step", altitudeStep), 0.0, 10000.0);
+        minSpeed = clamp(config.number("camera.min_speed", minSpeed), 1.0, 1000.0);
+        maxSpeed = clamp(config.number("camera.max_speed", maxSpeed), minSpeed, 1000.0);
+        minAltitude = clamp(config.number("camera.min_altitude", minAltitude), 10.0, 100000.0);
+        maxAltitude = clamp(config.number("camera.max_altitude", maxAltitude), minAltitude, 100000.0);
+        rotateSpeed = clamp((float)config.number("camera.rotate_speed", rotateSpeed), 0.0f, 0.5f);
+        mouseSensitivity = clamp((float)config.number("camera.mouse_sensitivity", mouseSensitivity), 0.0001f, 0.1f);
+        zoomStep = clamp((float)config.number("camera.zoom_step", zoomStep), 0.01f, 2.0f);
+        minDistance = clamp((float)config.number("camera.min_distance", minDistance), 1.01f, 100.0f);
+        maxDistance = clamp((float)config.number("camera.max_distance", maxDistance), minDistance, 100.0f);
+    }
+
+    // After a reload: keep the running values of the settings that need a
+    // restart, and say which of them the file now changes
+    void keepStartupValues(const Settings& running) {
+        keep("window.output_windows", outputWindows, running.outputWindows);
+        keep("window.fullscreen", fullscreen, running.fullscreen);
+        keep("render.reversed_z", reversedZ, running.reversedZ);
+        keep("render.hdr", hdr, running.hdr);
+        keep("render.shadow_resolution", shadowResolution, running.shadowResolution);
+        keep("simulation.fleet_size", fleetSize, running.fleetSize);
+        keep("simulation.cruise_altitude", cruiseAltitude, running.cruiseAltitude);
+        keep("threads.land_mask", landMaskThreads, running.landMaskThreads);
+        keep("cache.ingest_batch_size", ingestBatchSize, running.ingestBatchSize);
+        keep("cache.ingest_max_batches", ingestMaxBatches, running.ingestMaxBatches);
+        keep("cache.telemetry_slots", telemetrySlots, running.telemetrySlots);
+    }
+
+private:
+    template <typename T>
+    static T clamp(T value, T low, T high) { return std::min(std::max(value, low), high); }
+
+    template <typename T>
+    static void keep(const char* key, T& value, const T& running) {
+        if (value == running) return;
+        std::cout << key << " changes on the next restart" << std::endl;
+        value = running;
+    }
+};
+
+#endif // SETTINGS_H
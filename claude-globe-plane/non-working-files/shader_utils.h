@@ -0,0 +1,83 @@
+#ifndef SHADER_UTILS_H
+#define SHADER_UTILS_H
+
+#include <glad/glad.h>
+#include <iostream>
+#include <string>
+
+// GL 4.3, newer than the 3.3 glad loader; glCreateShader takes it as is
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+// source with "#define name" added after its #version line, for
+// compiling a variant of a shader
+inline std::string withDefine(const char* source, const char* name) {
+    std::string text(source);
+    size_t lineEnd = text.find('\n', text.find("#version"));
+    return text.insert(lineEnd + 1, std::string("#define ") + name + "\n");
+}
+
+// Compile shader function
+inline unsigned int compileShader(const char* source, GLenum type) {
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cerr << "Shader compilation failed: " << infoLog << std::endl;
+    }
+
+    return shader;
+}
+
+// Compile and link a vertex/fragment shader pair into a program
+inline unsigned int createShaderProgram(const char* vertexSource, const char* fragmentSource) {
+    unsigned int vertexShader = compileShader(vertexSource, GL_VERTEX_SHADER);
+    unsigned int fragmentShader = compileShader(fragmentSource, GL_FRAGMENT_SHADER);
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+
+    // Check linking
+    int success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "Shader linking failed: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    return program;
+}
+
+// Compile and link a compute shader on its own (needs a GL 4.3 context)
+inline unsigned int createComputeProgram(const char* source) {
+    unsigned int shader = compileShader(source, GL_COMPUTE_SHADER);
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+
+    int success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cerr << "Compute shader linking failed: " << infoLog << std::endl;
+    }
+
+    glDeleteShader(shader);
+    return program;
+}
+
+#endif // SHADER_UTILS_H
@@ -1,40 +1,110 @@
 #ifndef SHADERS_H
 #define SHADERS_H
 
-// Vertex shader source
+// Vertex shader source. Positions arrive as high/low float pairs of a
+// double and are made relative to the eye before anything else, so the GPU
+// only ever works with small numbers near the camera.
 const char* vertexShaderSource = R"(
 #version 330 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
+layout (location = 0) in vec3 aPosHigh;
+layout (location = 1) in vec3 aPosLow;
+layout (location = 2) in vec3 aNormal;
 
-out vec3 FragPos;
-out vec3 Normal;
+out vec3 FragPos;   // Relative to the eye
+out vec3 Normal;    // Globe frame; also the surface direction on the sphere
 
-uniform mat4 model;
-uniform mat4 view;
+uniform vec3 eyeHigh;
+uniform vec3 eyeLow;
+uniform mat4 view;  // Rotation only
 uniform mat4 projection;
 
 void main() {
-    FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    // The high parts cancel exactly for nearby geometry; the low parts carry the rest
+    vec3 highDiff = aPosHigh - eyeHigh;
+    vec3 lowDiff = aPosLow - eyeLow;
+    FragPos = highDiff + lowDiff;
+    Normal = aNormal;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
 )";
 
-// Fragment shader source
+// Ray-cast globe (SceneRenderer::rayCastGlobe): instead of the mesh, an
+// octagon around the globe's outline, in the plane through the center
+// facing the eye, with its edges tangent to the outline's cone. Every ray
+// that hits the globe crosses it, so it covers the globe's pixels exactly
+// once; the fragment shader (compiled with RAY_CAST) finds the surface.
+const char* rayCastVertexShaderSource = R"(
+#version 330 core
+out vec3 Ray;  // Relative to the eye, planet radii
+
+uniform vec3 center;     // Globe center from the eye, planet radii
+uniform vec3 right;      // Octagon axes, globe frame
+uniform vec3 up;
+uniform float halfSize;  // Outline radius in the octagon's plane, planet radii
+uniform float radius;    // Meters per planet radius
+uniform mat4 view;       // Rotation only
+uniform mat4 projection;
+
+void main() {
+    // A triangle fan of 8; 1 / cos(pi / 8) puts the edges on the outline
+    float angle = (float(gl_VertexID) + 0.5) * 0.7853982;
+    vec2 corner = vec2(cos(angle), sin(angle)) * 1.0823922;
+    Ray = center + (right * corner.x + up * corner.y) * halfSize;
+    gl_Position = projection * view * vec4(Ray * radius, 1.0);
+}
+)";
+
+// Fragment shader source. With RAY_CAST defined it takes the eye ray from
+// rayCastVertexShaderSource, intersects it with the sphere and writes the
+// hit's depth; the shading is the same either way.
 const char* fragmentShaderSource = R"(
 #version 330 core
 out vec4 FragColor;
 
+#ifdef RAY_CAST
+in vec3 Ray;
+
+uniform vec3 center;
+uniform float eyeTerm;   // |eye|^2 - 1 in planet radii, from doubles on the CPU
+uniform float radius;
+uniform mat4 view;
+uniform mat4 projection;
+uniform bool zeroToOne;  // Clip depth range of the active depth mode
+
+vec3 FragPos;  // Set from the hit, as the mesh's vertex shader would
+vec3 Normal;
+#else
 in vec3 FragPos;
 in vec3 Normal;
+#endif
 
-uniform vec3 sunPos;
-uniform vec3 moonPos;
+uniform vec3 sunPos;    // Relative to the eye
+uniform vec3 moonPos;   // Relative to the eye
 uniform vec3 sunColor;
 uniform vec3 moonColor;
 uniform vec3 objectColor;
-uniform vec3 viewPos;
+uniform vec3 viewPos;   // Eye-relative, so the origin
+
+// Cascaded sun shadows (see shadow_maps.h)
+uniform sampler2DArrayShadow shadowMaps;
+uniform mat4 shadowMatrices[3];  // Eye-relative position to shadow map coordinates
+uniform float cascadeEnds[3];    // View depth where each cascade ends
+uniform vec3 viewForward;
+uniform int shadowsEnabled;
+
+// 1 in sunlight, 0 in shadow. A cascade that was refitted for an older
+// camera pose may not cover the point; then the next one is tried.
+float sunShadow(vec3 pos) {
+    if (shadowsEnabled == 0) return 1.0;
+    float depth = dot(pos, viewForward);
+    for (int c = 0; c < 3; ++c) {
+        if (depth > cascadeEnds[c]) continue;
+        vec4 p = shadowMatrices[c] * vec4(pos, 1.0);
+        if (any(lessThan(p.xy, vec2(0.0))) || any(greaterThan(p.xy, vec2(1.0)))) continue;
+        return texture(shadowMaps, vec4(p.xy, float(c), p.z));
+    }
+    return 1.0;
+}
 
 // Simple noise function for continent generation
 float hash(vec2 p) {
@@ -54,6 +124,7 @@ float noise(vec2 p) {
     return mix(a, b, f.x) + (c - a) * f.y * (1.0 - f.x) + (d - b) * f.x * f.y;
 }
 
+// Mirrored on the CPU in continent_noise.h
 float continentNoise(vec3 pos) {
     // Convert 3D position to 2D coordinates (like lat/long)
     float theta = atan(pos.z, pos.x);
@@ -73,10 +144,26 @@ float continentNoise(vec3 pos) {
 }
 
 void main() {
+#ifdef RAY_CAST
+    // Nearest hit with the unit sphere around center. c / (b + sqrt(h))
+    // rather than b - sqrt(h): the two nearly cancel close to the surface.
+    vec3 direction = normalize(Ray);
+    float b = dot(direction, center);
+    float h = b * b - eyeTerm;
+    if (h < 0.0 || b <= 0.0) discard;
+    float t = eyeTerm / (b + sqrt(h));
+    FragPos = direction * (t * radius);
+    Normal = direction * t - center;
+
+    vec4 clip = projection * view * vec4(FragPos, 1.0);
+    float depth = clip.z / clip.w;
+    gl_FragDepth = zeroToOne ? depth : depth * 0.5 + 0.5;
+#endif
+
     vec3 norm = normalize(Normal);
     
     // Generate land/water based on position
-    float landMask = continentNoise(normalize(FragPos));
+    float landMask = continentNoise(norm);
     
     // Define colors
     vec3 oceanColor = vec3(0.05, 0.2, 0.5);   // Deep blue ocean
@@ -86,11 +173,11 @@ void main() {
     // Add more prominent desert regions
     if (landMask > 0.5) {
         // Create desert bands around certain latitudes (like Earth's desert belts)
-        float latitude = abs(normalize(FragPos).y);
+        float latitude = abs(norm.y);
         float desertBelt = smoothstep(0.15, 0.25, latitude) * (1.0 - smoothstep(0.35, 0.45, latitude));
         
         // Add noise-based variation
-        float variation = noise(normalize(FragPos).xz * 10.0);
+        float variation = noise(norm.xz * 10.0);
         float desertAmount = desertBelt * 0.7 + variation * 0.3;
         
         vec3 desertColor = vec3(0.8, 0.6, 0.3);  // Sandy/orange desert
@@ -108,7 +195,8 @@ void main() {
     // Sun lighting (warm yellow)
     vec3 sunDir = normalize(sunPos - FragPos);
     float sunDiff = max(dot(norm, sunDir), 0.0);
-    vec3 sunLight = sunDiff * sunColor * 0.8;
+    float shadow = sunDiff > 0.0 ? sunShadow(FragPos) : 1.0;
+    vec3 sunLight = sunDiff * shadow * sunColor * 0.8;
     
     // Moon lighting (cool blue-white)
     vec3 moonDir = normalize(moonPos - FragPos);
@@ -131,11 +219,405 @@ void main() {
     if (landMask < 0.5) {
         vec3 halfwayDir = normalize(sunDir + viewDir);
         float spec = pow(max(dot(norm, halfwayDir), 0.0), 32.0);
-        result += spec * sunColor * 0.5;
+        result += spec * shadow * sunColor * 0.5;
     }
     
     FragColor = vec4(result, 1.0);
 }
 )";
 
+// Aircraft vertex shader: one small dart mesh per instance, oriented along the flight path
+const char* aircraftVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec3 aLocalPos;      // x forward, y up, z right
+layout (location = 1) in vec3 aLocalNormal;
+layout (location = 2) in vec3 aInstancePos;      // Relative to the eye
+layout (location = 3) in vec3 aInstanceForward;
+layout (location = 4) in vec3 aInstanceUp;       // Away from the globe center
+
+out vec3 FragPos;
+out vec3 Normal;
+flat out int Selected;
+
+uniform mat4 view;  // Rotation only
+uniform mat4 projection;
+uniform float aircraftScale;
+uniform int selectedAircraft;
+
+void main() {
+    // Build the aircraft frame
+    vec3 up = normalize(aInstanceUp);
+    vec3 forward = normalize(aInstanceForward);
+    vec3 right = cross(forward, up);
+
+    vec3 localPos = forward * aLocalPos.x + up * aLocalPos.y + right * aLocalPos.z;
+    vec3 localNormal = forward * aLocalNormal.x + up * aLocalNormal.y + right * aLocalNormal.z;
+
+    FragPos = aInstancePos + localPos * aircraftScale;
+    Normal = localNormal;
+    Selected = (gl_InstanceID == selectedAircraft) ? 1 : 0;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
+)";
+
+// Aircraft fragment shader
+const char* aircraftFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec3 FragPos;
+in vec3 Normal;
+flat in int Selected;
+
+uniform vec3 sunPos;
+uniform vec3 sunColor;
+
+void main() {
+    vec3 baseColor = Selected == 1 ? vec3(1.0, 0.2, 0.1) : vec3(0.9, 0.9, 0.85);
+
+    // Two-sided diffuse so the thin dart is lit from either side
+    vec3 sunDir = normalize(sunPos - FragPos);
+    float diff = abs(dot(normalize(Normal), sunDir));
+    vec3 result = (vec3(0.25) + diff * sunColor * 0.8) * baseColor;
+
+    FragColor = vec4(result, 1.0);
+}
+)";
+
+// Depth-only fragment shader for shadow map passes
+const char* shadowFragmentShaderSource = R"(
+#version 330 core
+
+void main() {
+}
+)";
+
+// On-screen overlay: quads in pixel coordinates (origin top left) sampling
+// the single-channel glyph atlas
+const char* hudVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aUV;
+layout (location = 2) in vec4 aColor;
+
+out vec2 UV;
+out vec4 Color;
+
+uniform vec2 screenSize;
+
+void main() {
+    vec2 ndc = aPos / screenSize * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    UV = aUV;
+    Color = aColor;
+}
+)";
+
+const char* hudFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 UV;
+in vec4 Color;
+
+uniform sampler2D atlas;
+
+void main() {
+    float coverage = texture(atlas, UV).r;
+    if (coverage == 0.0) discard;
+    FragColor = vec4(Color.rgb, Color.a * coverage);
+}
+)";
+
+// Callsign labels: one instanced quad per label in pixel coordinates. The
+// fragment shader picks the character under it from the packed text and
+// samples the glyph's distance field.
+const char* labelVertexShaderSource = R"(
+#version 330 core
+layout (location = 0) in vec2 aCorner;  // Top-left of the text, pixels
+layout (location = 1) in uint aLength;
+layout (location = 2) in uvec2 aText;   // Up to 8 characters, 4 per word
+
+out vec2 Local;  // Font pixels from the text's top-left corner
+flat out int Length;
+flat out uvec2 Text;
+
+uniform vec2 screenSize;
+uniform float fontScale;
+
+void main() {
+    // Quad over the text plus one font pixel of border for the halo
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 size = vec2(float(aLength) * 6.0, 7.0);
+    Local = mix(vec2(-1.0), size + 1.0, corner);
+    Length = int(aLength);
+    Text = aText;
+
+    vec2 ndc = (aCorner + Local * fontScale) / screenSize * 2.0 - 1.0;
+    gl_Position = aLength == 0u ? vec4(2.0, 2.0, 2.0, 1.0) : vec4(ndc.x, -ndc.y, 0.0, 1.0);
+}
+)";
+
+const char* labelFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+in vec2 Local;
+flat in int Length;
+flat in uvec2 Text;
+
+uniform sampler2D atlas;
+uniform vec3 textColor;
+uniform vec3 haloColor;
+
+// Must match LabelRenderer: 4 texels per font pixel, 7x9 font pixel cells
+// (the 5x7 glyph and a border) in a 16x6 grid
+const float TEXELS = 4.0;
+const vec2 CELL = vec2(28.0, 36.0);
+const vec2 ATLAS_SIZE = vec2(448.0, 216.0);
+const float HALO = 0.35;  // Distance value where the halo ends
+
+void main() {
+    // Glyphs advance 6 font pixels, centered in their column
+    int column = clamp(int(floor(Local.x / 6.0)), 0, Length - 1);
+    uint word = column < 4 ? Text.x : Text.y;
+    int cell = int((word >> uint(8 * (column & 3))) & 0xFFu) - 32;
+
+    vec2 inCell = vec2(Local.x - float(column) * 6.0 + 0.5, Local.y + 1.0);
+    inCell = clamp(inCell, vec2(0.5 / TEXELS), CELL / TEXELS - 0.5 / TEXELS);
+    vec2 uv = (vec2(float(cell % 16), float(cell / 16)) * CELL + inCell * TEXELS) / ATLAS_SIZE;
+
+    float distance = texture(atlas, uv).r;
+    float width = max(fwidth(distance) * 0.7, 1e-3);
+    float halo = smoothstep(HALO - width, HALO + width, distance);
+    if (halo <= 0.0) discard;
+    float fill = smoothstep(0.5 - width, 0.5 + width, distance);
+    FragColor = vec4(mix(haloColor, textColor, fill), halo);
+}
+)";
+
+// Full-screen triangle for post passes, from gl_VertexID alone (draw 3
+// vertices with an empty vertex array)
+const char* postVertexShaderSource = R"(
+#version 330 core
+out vec2 TexCoord;
+
+void main() {
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    TexCoord = corner;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
+)";
+
+// HDR scene to display: exposure, then a filmic curve (Narkowicz's ACES
+// fit) that rolls highlights off instead of clipping them. The scene colors
+// are authored as display values, so there is no gamma encode.
+const char* tonemapFragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D sceneColor;
+uniform sampler2D exposure;  // 1x1, 0 until the first metering
+
+vec3 filmic(vec3 x) {
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main() {
+    float e = texelFetch(exposure, ivec2(0), 0).r;
+    vec3 color = texture(sceneColor, TexCoord).rgb * (e > 0.0 ? e : 1.0);
+    FragColor = vec4(filmic(color), 1.0);
+}
+)";
+
+// Luminance histogram (GL 4.3 compute). Each invocation looks at one pixel
+// of a grid every sampleStride pixels. Bin 0 holds near-black pixels, which
+// are left out of the average; bins 1-255 split [minLogLuminance,
+// minLogLuminance + logRange] evenly in log2 luminance. Counting goes into
+// shared memory first so there is one global atomic per bin and group.
+const char* histogramComputeShaderSource = R"(
+#version 430 core
+layout(local_size_x = 16, local_size_y = 16) in;
+
+uniform sampler2D sceneColor;
+uniform int sampleStride;
+uniform float minLogLuminance;
+uniform float inverseLogRange;
+
+layout(std430, binding = 0) buffer Histogram {
+    uint bins[256];
+};
+
+shared uint groupBins[256];
+
+void main() {
+    groupBins[gl_LocalInvocationIndex] = 0u;
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy) * sampleStride;
+    if (all(lessThan(pixel, textureSize(sceneColor, 0)))) {
+        vec3 color = texelFetch(sceneColor, pixel, 0).rgb;
+        float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+        uint bin = 0u;
+        if (luminance > 1e-4) {
+            float t = clamp((log2(luminance) - minLogLuminance) * inverseLogRange, 0.0, 1.0);
+            bin = uint(t * 254.0 + 1.0);
+        }
+        atomicAdd(groupBins[bin], 1u);
+    }
+    barrier();
+
+    uint count = groupBins[gl_LocalInvocationIndex];
+    if (count > 0u) atomicAdd(bins[gl_LocalInvocationIndex], count);
+}
+)";
+
+// Average the histogram into a target exposure and move the stored exposure
+// toward it by adaptation (0-1, from the time since the last metering).
+// One group of 256; clears the bins for the next frame.
+const char* exposureComputeShaderSource = R"(
+#version 430 core
+layout(local_size_x = 256) in;
+
+layout(std430, binding = 0) buffer Histogram {
+    uint bins[256];
+};
+layout(r32f, binding = 0) uniform image2D exposureImage;
+
+uniform float minLogLuminance;
+uniform float logRange;
+uniform float keyValue;
+uniform float adaptation;
+uniform float minExposure;
+uniform float maxExposure;
+
+shared float weighted[256];
+shared float counted[256];
+
+void main() {
+    uint i = gl_LocalInvocationIndex;
+    float count = float(bins[i]);
+    bins[i] = 0u;
+    weighted[i] = count * float(i);
+    counted[i] = i == 0u ? 0.0 : count;
+    barrier();
+
+    for (uint stride = 128u; stride > 0u; stride >>= 1u) {
+        if (i < stride) {
+            weighted[i] += weighted[i + stride];
+            counted[i] += counted[i + stride];
+        }
+        barrier();
+    }
+
+    if (i == 0u) {
+        float previous = imageLoad(exposureImage, ivec2(0)).r;
+        float target = previous;
+        if (counted[0] > 0.0) {
+            float meanBin = weighted[0] / counted[0];
+            float logAverage = (meanBin - 1.0) / 254.0 * logRange + minLogLuminance;
+            target = clamp(keyValue / exp2(logAverage), minExposure, maxExposure);
+        }
+        float exposure = previous > 0.0 ? mix(previous, target, adaptation) : target;
+        imageStore(exposureImage, ivec2(0), vec4(exposure));
+    }
+}
+)";
+
+// Fallback metering without compute shaders: log2 luminance weighted by
+// whether the pixel counts (not near black), drawn small and then averaged
+// down a mip chain
+const char* logLuminanceFragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoord;
+out vec4 FragColor;
+
+uniform sampler2D sceneColor;
+
+void main() {
+    float luminance = dot(texture(sceneColor, TexCoord).rgb, vec3(0.2126, 0.7152, 0.0722));
+    float counts = luminance > 1e-4 ? 1.0 : 0.0;
+    FragColor = vec4(log2(max(luminance, 1e-4)) * counts, counts, 0.0, 1.0);
+}
+)";
+
+// Fallback exposure step: the same adaptation as the compute version, from
+// the top of the log luminance mip chain, ping-ponging between two 1x1
+// targets
+const char* exposureFragmentShaderSource = R"(
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D logLuminance;
+uniform sampler2D previousExposure;
+uniform int topLevel;
+uniform float keyValue;
+uniform float adaptation;
+uniform float minExposure;
+uniform float maxExposure;
+
+void main() {
+    vec2 average = texelFetch(logLuminance, ivec2(0), topLevel).rg;
+    float previous = texelFetch(previousExposure, ivec2(0), 0).r;
+    float target = previous;
+    if (average.y > 0.0) {
+        target = clamp(keyValue / exp2(average.x / average.y), minExposure, maxExposure);
+    }
+    float exposure = previous > 0.0 ? mix(previous, target, adaptation) : target;
+    FragColor = vec4(exposure, 0.0, 0.0, 1.0);
+}
+)";
+
+// Globe impostor sprite: a quad facing the eye the picture was rendered
+// from, through the globe center, in planet radii relative to the eye. Each
+// pixel intersects its ray with the globe, so the outline and depth match
+// the current eye; the color comes from the picture.
+const char* impostorVertexShaderSource = R"(
+#version 330 core
+out vec2 TexCoord;
+out vec3 Ray;
+
+uniform vec3 center;     // Globe center from the eye, planet radii
+uniform vec3 right;      // Picture axes, globe frame
+uniform vec3 up;
+uniform float halfSize;  // Planet radii
+uniform float radius;    // Meters per planet radius
+uniform mat4 viewProjection;
+
+void main() {
+    vec2 corner = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1)) * 2.0 - 1.0;
+    TexCoord = corner * 0.5 + 0.5;
+    Ray = center + (right * corner.x + up * corner.y) * halfSize;
+    gl_Position = viewProjection * vec4(Ray * radius, 1.0);
+}
+)";
+
+const char* impostorFragmentShaderSource = R"(
+#version 330 core
+in vec2 TexCoord;
+in vec3 Ray;
+out vec4 FragColor;
+
+uniform sampler2D picture;
+uniform vec3 center;
+uniform float radius;
+uniform mat4 viewProjection;
+uniform bool zeroToOne;  // Clip depth range of the active depth mode
+
+void main() {
+    // Nearest hit of the eye ray with the unit sphere around center
+    vec3 direction = normalize(Ray);
+    float b = dot(direction, center);
+    float h = b * b - (dot(center, center) - 1.0);
+    if (h < 0.0) discard;
+    vec3 hit = direction * (b - sqrt(h));
+
+    vec4 clip = viewProjection * vec4(hit * radius, 1.0);
+    float depth = clip.z / clip.w;
+    gl_FragDepth = zeroToOne ? depth : depth * 0.5 + 0.5;
+    FragColor = texture(picture, TexCoord);
+}
+)";
+
 #endif // SHADERS_H
\ No newline at end of file
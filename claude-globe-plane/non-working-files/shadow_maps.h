@@ -0,0 +1,227 @@
+#ifndef SHADOW_MAPS_H
+#define SHADOW_MAPS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+
+#include "camera.h"
+
+// Cascaded shadow maps for the sun. The view frustum is cut into CASCADES
+// slices along the view direction and each slice gets its own orthographic
+// shadow map in one depth texture array.
+//
+// Each cascade is fitted to the bounding sphere of its slice, so its size
+// does not change as the camera turns, and its center is snapped to whole
+// shadow texels in a fixed light-space basis, so static shadows do not
+// shimmer as the camera moves. Centers are kept in double precision globe
+// coordinates and the light matrices are rebuilt relative to the eye every
+// frame, which means a cascade that skipped its refit this frame is still
+// exactly where it was in the world. Far cascades refit less often (see
+// updateInterval); receivers that fall outside a stale cascade use the next.
+class CascadedShadowMaps {
+public:
+    static const int CASCADES = 3;
+
+    int resolution = 2048;
+    float splitLambda = 0.8f;                 // 1 logarithmic splits, 0 uniform
+    double maxShadowDistance = 20000000.0;    // Meters; shadows end at this view depth
+    double casterReach = 700000.0;            // Meters above receivers a caster may sit
+    int updateInterval[CASCADES] = {1, 2, 4}; // Frames between refits
+    bool depthZeroToOne = false;              // Clip depth convention (glClipControl)
+
+    void init() {
+        glGenTextures(1, &depthTexture);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, CASCADES,
+                     0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+        const float border[] = {1.0f, 1.0f, 1.0f, 1.0f};
+        glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+        // Hardware 2x2 PCF
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Shadow map framebuffer incomplete" << std::endl;
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    // Uniform locations of a program that receives shadows (see the globe shader)
+    void attachReceiver(unsigned int program) {
+        shadowMapsLoc = glGetUniformLocation(program, "shadowMaps");
+        shadowMatricesLoc = glGetUniformLocation(program, "shadowMatrices");
+        cascadeEndsLoc = glGetUniformLocation(program, "cascadeEnds");
+        viewForwardLoc = glGetUniformLocation(program, "viewForward");
+        shadowsEnabledLoc = glGetUniformLocation(program, "shadowsEnabled");
+    }
+
+    // Refit the cascades that are due this frame. sunDirection points from
+    // the globe center toward the sun.
+    void update(const RenderView& view, float fovRadians, float aspect, const glm::dvec3& sunDirection) {
+        eye = view.eye;
+        lightDirection = glm::normalize(sunDirection);
+
+        // Fixed light-space basis, so snapping lines up from frame to frame
+        glm::dvec3 reference = fabs(lightDirection.y) < 0.99 ? glm::dvec3(0.0, 1.0, 0.0)
+                                                             : glm::dvec3(1.0, 0.0, 0.0);
+        lightUp = glm::normalize(reference - lightDirection * glm::dot(reference, lightDirection));
+        lightRight = glm::cross(-lightDirection, lightUp);
+
+        double nearPlane, farPlane;
+        view.clipPlanes(nearPlane, farPlane);
+        farPlane = std::min(farPlane, maxShadowDistance);
+        glm::dvec3 forward = glm::dvec3(view.forward());
+        double tanY = tan(fovRadians * 0.5);
+        double diagonal2 = tanY * tanY * (1.0 + (double)aspect * aspect);
+
+        for (int c = 0; c < CASCADES; ++c) {
+            double sliceNear = splitDistance(c, nearPlane, farPlane);
+            double sliceFar = splitDistance(c + 1, nearPlane, farPlane);
+            cascadeEnds[c] = (float)sliceFar;
+
+            due[c] = !fitted[c] || (frame + c) % updateInterval[c] == 0;
+            if (!due[c]) continue;
+
+            // Smallest sphere around the slice's corners, centered on the view axis
+            double centerDistance = std::min(sliceFar, 0.5 * (sliceNear + sliceFar) * (1.0 + diagonal2));
+            double radius = std::max(
+                sqrt((sliceFar - centerDistance) * (sliceFar - centerDistance) + sliceFar * sliceFar * diagonal2),
+                sqrt((centerDistance - sliceNear) * (centerDistance - sliceNear) + sliceNear * sliceNear * diagonal2));
+            // Round up to 1% steps so the size only changes in rare jumps
+            radius = pow(1.01, ceil(log(radius) / log(1.01)));
+
+            // Snap the center to the texel grid in light space
+            glm::dvec3 center = eye + forward * centerDistance;
+            double texel = 2.0 * radius / resolution;
+            double u = floor(glm::dot(center, lightRight) / texel) * texel;
+            double v = floor(glm::dot(center, lightUp) / texel) * texel;
+            double w = glm::dot(center, lightDirection);
+            cascadeCenter[c] = lightRight * u + lightUp * v + lightDirection * w;
+            cascadeRadius[c] = radius;
+            fitted[c] = true;
+        }
+        ++frame;
+
+        for (int c = 0; c < CASCADES; ++c) lightMatrices[c] = buildLightMatrix(c);
+    }
+
+    // Whether the cascade was refitted this frame and needs its map redrawn
+    bool needsRender(int cascade) const { return due[cascade]; }
+
+    // Eye-relative light view-projection for drawing casters into a cascade
+    const glm::mat4& lightMatrix(int cascade) const { return lightMatrices[cascade]; }
+
+    void beginCascade(int cascade) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, cascade);
+        glViewport(0, 0, resolution, resolution);
+        glDepthFunc(GL_LESS);
+        glClearDepth(1.0);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+    }
+
+    // Back to the window; width and height are the framebuffer size
+    void endCascades(int width, int height) {
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, width, height);
+    }
+
+    // Set the attached receiver's uniforms; its program must be in use.
+    // view may be another camera than the one the cascades were fitted to;
+    // the lookups are moved to its eye.
+    void bindReceiver(int textureUnit, const RenderView& view) {
+        glm::mat4 toFittedEye = glm::translate(glm::mat4(1.0f), glm::vec3(view.eye - eye));
+        glm::mat4 lookup[CASCADES];
+        for (int c = 0; c < CASCADES; ++c) lookup[c] = textureBias() * lightMatrices[c] * toFittedEye;
+        glm::vec3 forward = view.forward();
+
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+        glActiveTexture(GL_TEXTURE0);
+        glUniform1i(shadowMapsLoc, textureUnit);
+        glUniformMatrix4fv(shadowMatricesLoc, CASCADES, GL_FALSE, glm::value_ptr(lookup[0]));
+        glUniform1fv(cascadeEndsLoc, CASCADES, cascadeEnds);
+        glUniform3f(viewForwardLoc, forward.x, forward.y, forward.z);
+        glUniform1i(shadowsEnabledLoc, fitted[0] ? 1 : 0);
+    }
+
+    void cleanup() {
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &depthTexture);
+    }
+
+private:
+    unsigned int depthTexture = 0, framebuffer = 0;
+    int shadowMapsLoc = -1, shadowMatricesLoc = -1, cascadeEndsLoc = -1;
+    int viewForwardLoc = -1, shadowsEnabledLoc = -1;
+
+    glm::dvec3 eye = glm::dvec3(0.0);
+    glm::dvec3 lightDirection = glm::dvec3(1.0, 0.0, 0.0);
+    glm::dvec3 lightUp = glm::dvec3(0.0, 1.0, 0.0);
+    glm::dvec3 lightRight = glm::dvec3(0.0, 0.0, 1.0);
+    glm::dvec3 cascadeCenter[CASCADES];
+    double cascadeRadius[CASCADES] = {1.0, 1.0, 1.0};
+    float cascadeEnds[CASCADES] = {0.0f, 0.0f, 0.0f};
+    glm::mat4 lightMatrices[CASCADES];
+    bool fitted[CASCADES] = {false, false, false};
+    bool due[CASCADES] = {false, false, false};
+    long long frame = 0;
+
+    // Blend of logarithmic and uniform split schemes
+    double splitDistance(int index, double nearPlane, double farPlane) const {
+        double t = (double)index / CASCADES;
+        double logarithmic = nearPlane * pow(farPlane / nearPlane, t);
+        double uniform = nearPlane + (farPlane - nearPlane) * t;
+        return splitLambda * logarithmic + (1.0 - splitLambda) * uniform;
+    }
+
+    glm::mat4 buildLightMatrix(int c) const {
+        float radius = (float)cascadeRadius[c];
+        glm::vec3 center = glm::vec3(cascadeCenter[c] - eye);
+        glm::vec3 toLight = glm::vec3(lightDirection);
+        float lightDistance = radius + (float)casterReach;
+        glm::mat4 lightView = glm::lookAt(center + toLight * lightDistance, center, glm::vec3(lightUp));
+        glm::mat4 lightProjection = glm::ortho(-radius, radius, -radius, radius, 0.0f, lightDistance + radius);
+
+        if (depthZeroToOne) {
+            // glm::ortho targets [-1, 1] clip depth
+            glm::mat4 remap(1.0f);
+            remap[2][2] = 0.5f;
+            remap[3][2] = 0.5f;
+            lightProjection = remap * lightProjection;
+        }
+        return lightProjection * lightView;
+    }
+
+    // Clip space to shadow map texture coordinates and depth
+    glm::mat4 textureBias() const {
+        glm::mat4 bias(1.0f);
+        bias[0][0] = bias[1][1] = 0.5f;
+        bias[3][0] = bias[3][1] = 0.5f;
+        if (!depthZeroToOne) {
+            bias[2][2] = 0.5f;
+            bias[3][2] = 0.5f;
+        }
+        return bias;
+    }
+};
+
+#endif // SHADOW_MAPS_H
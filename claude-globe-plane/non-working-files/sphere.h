@@ -61,4 +61,38 @@ void generateSphere(float radius, int sectors, int stacks,
     }
 }
 
+// Same mesh and indices as generateSphere, but positions are computed in
+// double and stored as high/low float pairs for camera-relative rendering.
+// Vertex layout: high xyz, low xyz, normal xyz.
+inline void generateSphereSplit(double radius, int sectors, int stacks,
+                                std::vector<float>& vertices,
+                                std::vector<unsigned int>& indices) {
+    std::vector<float> unitVertices;
+    generateSphere(1.0f, sectors, stacks, unitVertices, indices);
+
+    vertices.clear();
+    vertices.reserve(unitVertices.size() / 6 * 9);
+    for (int i = 0; i <= stacks; ++i) {
+        double stackAngle = M_PI / 2 - i * M_PI / stacks;
+        for (int j = 0; j <= sectors; ++j) {
+            double sectorAngle = j * 2 * M_PI / sectors;
+            double p[3] = {
+                radius * cos(stackAngle) * cos(sectorAngle),
+                radius * cos(stackAngle) * sin(sectorAngle),
+                radius * sin(stackAngle)
+            };
+
+            float high[3], low[3];
+            for (int k = 0; k < 3; ++k) {
+                high[k] = (float)p[k];
+                low[k] = (float)(p[k] - (double)high[k]);
+            }
+            const float* normal = &unitVertices[(i * (sectors + 1) + j) * 6 + 3];
+            vertices.insert(vertices.end(), high, high + 3);
+            vertices.insert(vertices.end(), low, low + 3);
+            vertices.insert(vertices.end(), normal, normal + 3);
+        }
+    }
+}
+
 #endif // SPHERE_H
\ No newline at end of file
@@ -0,0 +1,287 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <new>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "fleet.h"
+#include "flight_model.h"
+
+// Counters shared between processes must not fall back to a lock
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "telemetry needs lock-free 64-bit atomics");
+
+// Shared-memory layout: a header, then slotCount snapshot slots of
+// slotBytes each. Snapshot n goes to slot n % slotCount, so a reader working
+// on the newest snapshot is only overwritten once the simulation has
+// published slotCount - 1 more.
+struct alignas(64) TelemetryHeader {
+    char magic[4];                  // "PTLM", written last
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t capacity;              // Aircraft per snapshot
+    uint64_t slotBytes;
+    std::atomic<uint64_t> latest;   // Sequence number of the newest snapshot, 0 before the first
+};
+
+// One snapshot. Four float arrays of `capacity` entries follow it: fleet
+// position x, y, z (globe units) and groundspeed (m/s).
+struct TelemetrySnapshot {
+    std::atomic<uint64_t> lock;     // Seqlock: odd while the slot is being written
+    uint64_t sequence;              // 1 for the first snapshot
+    double simTime;                 // Simulated seconds
+    double metersPerUnit;           // Fleet globe units to meters
+    uint32_t aircraftCount;
+    uint32_t hasPlane;              // 0 when there is no plane view aircraft
+
+    // The plane view aircraft, globe frame, meters and m/s; zero without one
+    double planePosition[3];
+    double planeVelocity[3];
+    double planeAltitude;
+    double planeAirspeed;
+
+    enum Array { POS_X, POS_Y, POS_Z, GROUND_SPEED, ARRAY_COUNT };
+
+    const float* array(Array a, uint32_t capacity) const {
+        return (const float*)(this + 1) + (size_t)a * capacity;
+    }
+    float* array(Array a, uint32_t capacity) {
+        return (float*)(this + 1) + (size_t)a * capacity;
+    }
+};
+
+const uint32_t TELEMETRY_VERSION = 1;
+
+// Publishes simulation state into a POSIX shared-memory ring once per tick.
+// Each slot is guarded by a seqlock, so the simulation never waits for
+// readers and any number of readers can look at a slot in place.
+class TelemetryPublisher {
+public:
+    uint32_t slotCount = 4;
+
+    TelemetryPublisher() {}
+    ~TelemetryPublisher() { close(); }
+
+    // Create (or take over) the segment; name is a shm_open name like "/plane_sim"
+    bool open(const char* segmentName, size_t capacity) {
+        close();
+        size_t slotBytes = snapshotBytes((uint32_t)capacity);
+        size_t bytes = sizeof(TelemetryHeader) + slotBytes * slotCount;
+
+        int fd = shm_open(segmentName, O_CREAT | O_RDWR, 0644);
+        if (fd < 0) {
+            std::cerr << "Failed to create telemetry segment: " << segmentName << std::endl;
+            return false;
+        }
+        if (ftruncate(fd, (off_t)bytes) != 0) {
+            std::cerr << "Failed to size telemetry segment: " << segmentName << std::endl;
+            ::close(fd);
+            shm_unlink(segmentName);
+            return false;
+        }
+        void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) {
+            shm_unlink(segmentName);
+            return false;
+        }
+        mapped = base;
+        mappedSize = bytes;
+        name = segmentName;
+
+        // Readers check the magic, so clear it until the layout is in place
+        header = new (base) TelemetryHeader();
+        memset(header->magic, 0, sizeof(header->magic));
+        header->version = TELEMETRY_VERSION;
+        header->slotCount = slotCount;
+        header->capacity = (uint32_t)capacity;
+        header->slotBytes = slotBytes;
+        header->latest.store(0, std::memory_order_relaxed);
+        for (uint32_t s = 0; s < slotCount; ++s) {
+            TelemetrySnapshot* snapshot = new (slot(s)) TelemetrySnapshot();
+            snapshot->lock.store(0, std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(header->magic, "PTLM", 4);
+        sequence = 0;
+        return true;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    // Copy this tick's state into the next slot. plane may be null.
+    void publish(const Fleet& fleet, const FlightModel* plane, size_t planeIndex, double simTime) {
+        if (!header) return;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        ++sequence;
+        TelemetrySnapshot* snapshot = slot((uint32_t)(sequence % slotCount));
+        uint64_t lock = snapshot->lock.load(std::memory_order_relaxed);
+        snapshot->lock.store(lock + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const uint32_t capacity = header->capacity;
+        const uint32_t count = (uint32_t)std::min(fleet.size(), (size_t)capacity);
+        snapshot->sequence = sequence;
+        snapshot->simTime = simTime;
+        snapshot->metersPerUnit = fleet.metersPerUnit;
+        snapshot->aircraftCount = count;
+        if (plane && planeIndex < plane->size()) {
+            glm::dvec3 p = plane->position(planeIndex), v = plane->velocity(planeIndex);
+            for (int k = 0; k < 3; ++k) {
+                snapshot->planePosition[k] = p[k];
+                snapshot->planeVelocity[k] = v[k];
+            }
+            snapshot->planeAltitude = plane->getAltitude(planeIndex);
+            snapshot->planeAirspeed = plane->getAirspeed(planeIndex);
+            snapshot->hasPlane = 1;
+        } else {
+            // Not whatever this slot held slotCount ticks ago
+            for (int k = 0; k < 3; ++k) {
+                snapshot->planePosition[k] = 0.0;
+                snapshot->planeVelocity[k] = 0.0;
+            }
+            snapshot->planeAltitude = 0.0;
+            snapshot->planeAirspeed = 0.0;
+            snapshot->hasPlane = 0;
+        }
+        if (count > 0) {
+            memcpy(snapshot->array(TelemetrySnapshot::POS_X, capacity), fleet.posX.data(), count * sizeof(float));
+            memcpy(snapshot->array(TelemetrySnapshot::POS_Y, capacity), fleet.posY.data(), count * sizeof(float));
+            memcpy(snapshot->array(TelemetrySnapshot::POS_Z, capacity), fleet.posZ.data(), count * sizeof(float));
+            memcpy(snapshot->array(TelemetrySnapshot::GROUND_SPEED, capacity), fleet.groundSpeed.data(),
+                   count * sizeof(float));
+        }
+
+        snapshot->lock.store(lock + 2, std::memory_order_release);
+        header->latest.store(sequence, std::memory_order_release);
+
+        lastPublishMicros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        totalPublishMicros += lastPublishMicros;
+    }
+
+    uint64_t publishedCount() const { return sequence; }
+    double lastMicros() const { return lastPublishMicros; }
+    double averageMicros() const { return sequence ? totalPublishMicros / sequence : 0.0; }
+
+    // Unmap and remove the segment; readers that still have it mapped keep the last snapshots
+    void close() {
+        if (!mapped) return;
+        munmap(mapped, mappedSize);
+        shm_unlink(name.c_str());
+        mapped = nullptr;
+        header = nullptr;
+        mappedSize = 0;
+    }
+
+    static size_t snapshotBytes(uint32_t capacity) {
+        size_t bytes = sizeof(TelemetrySnapshot) + TelemetrySnapshot::ARRAY_COUNT * (size_t)capacity * sizeof(float);
+        return (bytes + 63) / 64 * 64;  // Slots on their own cache lines
+    }
+
+private:
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+    std::string name;
+    TelemetryHeader* header = nullptr;
+    uint64_t sequence = 0;
+    double lastPublishMicros = 0.0;
+    double totalPublishMicros = 0.0;
+
+    TelemetrySnapshot* slot(uint32_t s) {
+        return (TelemetrySnapshot*)((char*)(header + 1) + s * header->slotBytes);
+    }
+};
+
+// Read side of the ring, for other processes. Maps the segment read-only
+// and hands the newest snapshot to a visitor in place, without copying.
+// Because the writer may reuse the slot meanwhile, a visit only counts if
+// the slot's seqlock is unchanged afterwards; read() retries otherwise.
+class TelemetryReader {
+public:
+    TelemetryReader() {}
+    ~TelemetryReader() { close(); }
+
+    bool open(const char* segmentName) {
+        close();
+        int fd = shm_open(segmentName, O_RDONLY, 0);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TelemetryHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* base = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED) return false;
+        mapped = base;
+        mappedSize = (size_t)info.st_size;
+
+        header = (const TelemetryHeader*)base;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (memcmp(header->magic, "PTLM", 4) != 0 || header->version != TELEMETRY_VERSION ||
+            sizeof(TelemetryHeader) + header->slotBytes * header->slotCount > mappedSize ||
+            header->slotBytes < TelemetryPublisher::snapshotBytes(header->capacity)) {
+            std::cerr << "Invalid telemetry segment: " << segmentName << std::endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t capacity() const { return header ? header->capacity : 0; }
+    uint64_t latestSequence() const { return header ? header->latest.load(std::memory_order_acquire) : 0; }
+
+    // Calls visit(const TelemetrySnapshot&, capacity) on the newest snapshot.
+    // Returns false if nothing is published yet or every attempt was torn;
+    // tornReads counts the discarded visits.
+    template <typename F>
+    bool read(F visit, int attempts = 8) {
+        for (int a = 0; a < attempts; ++a) {
+            uint64_t latest = latestSequence();
+            if (latest == 0) return false;
+            const TelemetrySnapshot* snapshot = slot((uint32_t)(latest % header->slotCount));
+            uint64_t before = snapshot->lock.load(std::memory_order_acquire);
+            if (before & 1) {
+                ++tornReads;
+                continue;
+            }
+            visit(*snapshot, header->capacity);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (snapshot->lock.load(std::memory_order_relaxed) == before) return true;
+            ++tornReads;
+        }
+        return false;
+    }
+
+    uint64_t tornReads = 0;
+
+    void close() {
+        if (mapped) munmap(mapped, mappedSize);
+        mapped = nullptr;
+        header = nullptr;
+        mappedSize = 0;
+    }
+
+private:
+    void* mapped = nullptr;
+    size_t mappedSize = 0;
+    const TelemetryHeader* header = nullptr;
+
+    const TelemetrySnapshot* slot(uint32_t s) const {
+        return (const TelemetrySnapshot*)((const char*)(header + 1) + s * header->slotBytes);
+    }
+};
+
+#endif // TELEMETRY_H
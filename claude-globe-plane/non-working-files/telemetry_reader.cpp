@@ -0,0 +1,102 @@
+// Follows the viewer's shared-memory telemetry and prints a line per second
+//
+// Usage: telemetry_reader [--name SEGMENT] [--seconds N]
+//
+// Shows the newest snapshot's plane position and fleet summary, how many
+// snapshots were skipped between polls, how many visits were torn by the
+// writer and had to be retried, and how long an in-place read takes.
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
+
+#include "telemetry.h"
+
+int main(int argc, char** argv) {
+    std::string name = "/plane_sim_telemetry";
+    double seconds = 0.0;  // 0 runs until interrupted
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--name" && hasValue) name = argv[++i];
+        else if (arg == "--seconds" && hasValue) seconds = atof(argv[++i]);
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--name SEGMENT] [--seconds N]" << std::endl;
+            return 1;
+        }
+    }
+
+    TelemetryReader reader;
+    while (!reader.open(name.c_str())) {
+        std::cout << "Waiting for " << name << "..." << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    std::cout << "Reading " << name << " (capacity " << reader.capacity() << " aircraft)" << std::endl;
+
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point start = Clock::now(), lastPrint = start;
+    uint64_t lastSequence = 0, snapshots = 0, skipped = 0;
+    double readMicros = 0.0;
+
+    while (seconds <= 0.0 || std::chrono::duration<double>(Clock::now() - start).count() < seconds) {
+        uint64_t latest = reader.latestSequence();
+        if (latest == lastSequence) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        // Everything below reads straight from the shared slot
+        uint64_t sequence = 0;
+        uint32_t count = 0;
+        double simTime = 0.0, latitude = 0.0, longitude = 0.0, altitude = 0.0, airspeed = 0.0;
+        double meanSpeed = 0.0;
+        bool hasPlane = false;
+        Clock::time_point readStart = Clock::now();
+        bool ok = reader.read([&](const TelemetrySnapshot& s, uint32_t capacity) {
+            sequence = s.sequence;
+            simTime = s.simTime;
+            count = s.aircraftCount;
+            hasPlane = s.hasPlane != 0;
+            double r = sqrt(s.planePosition[0] * s.planePosition[0] + s.planePosition[1] * s.planePosition[1] +
+                            s.planePosition[2] * s.planePosition[2]);
+            latitude = r > 0.0 ? asin(s.planePosition[1] / r) * 180.0 / M_PI : 0.0;
+            longitude = atan2(s.planePosition[2], s.planePosition[0]) * 180.0 / M_PI;
+            altitude = s.planeAltitude;
+            airspeed = s.planeAirspeed;
+
+            const float* speed = s.array(TelemetrySnapshot::GROUND_SPEED, capacity);
+            double sum = 0.0;
+            for (uint32_t i = 0; i < count && i < capacity; ++i) sum += speed[i];
+            meanSpeed = count ? sum / count : 0.0;
+        });
+        readMicros += std::chrono::duration<double, std::micro>(Clock::now() - readStart).count();
+        if (!ok) continue;
+
+        if (lastSequence && sequence > lastSequence + 1) skipped += sequence - lastSequence - 1;
+        lastSequence = sequence;
+        ++snapshots;
+
+        if (std::chrono::duration<double>(Clock::now() - lastPrint).count() >= 1.0) {
+            std::cout << std::fixed << std::setprecision(2)
+                      << "#" << sequence << " t=" << simTime << " s";
+            if (hasPlane) {
+                std::cout << "  plane " << latitude << ", " << longitude
+                          << "  alt " << std::setprecision(0) << altitude << " m"
+                          << "  tas " << airspeed << " m/s";
+            } else {
+                std::cout << "  no plane";
+            }
+            std::cout << std::setprecision(0)
+                      << "  fleet " << count << " @ " << meanSpeed << " m/s"
+                      << std::setprecision(2)
+                      << "  | " << snapshots << " read, " << skipped << " skipped, "
+                      << reader.tornReads << " torn, " << readMicros / snapshots << " us/read"
+                      << std::endl;
+            lastPrint = Clock::now();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,262 @@
+#ifndef WIND_FIELD_H
+#define WIND_FIELD_H
+
+#include <glm/glm.hpp>
+#include <vector>
+#include <random>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+
+// Gridded winds aloft: eastward (u) and northward (v) components in m/s on a
+// regular latitude x longitude x altitude grid. Latitude runs -90..90 degrees
+// inclusive, longitude wraps at 360 degrees (same convention as the globe
+// shader: lon = atan2(z, x), lat = asin(y)), and levels are evenly spaced.
+//
+// Storage is tiled: TILE x TILE lat/lon cells form one block with every level
+// of a cell stored next to each other and u/v interleaved, so the eight
+// corners of a trilinear lookup usually fall in one or two cache lines.
+class WindField {
+public:
+    static const int TILE = 4;
+
+    struct Sample {
+        float u, v;
+    };
+
+    int latCount = 0;
+    int lonCount = 0;
+    int levelCount = 0;
+    float levelBase = 0.0f;      // Altitude of level 0, m
+    float levelSpacing = 1.0f;   // m between levels
+
+    bool empty() const { return data.empty(); }
+
+    void resize(int lats, int lons, int levels, float base, float spacing) {
+        latCount = lats;
+        lonCount = lons;
+        levelCount = levels;
+        levelBase = base;
+        levelSpacing = spacing;
+        tilesLon = (lons + TILE - 1) / TILE;
+        int tilesLat = (lats + TILE - 1) / TILE;
+        data.assign((size_t)tilesLat * tilesLon * TILE * TILE * levels, Sample());
+    }
+
+    Sample& at(int lat, int lon, int level) { return data[index(lat, lon, level)]; }
+    const Sample& at(int lat, int lon, int level) const { return data[index(lat, lon, level)]; }
+
+    // Jet streams around 35 degrees peaking near 10 km, easterly trades at the
+    // equator and a few travelling waves to make the flow meander
+    void generateProcedural(unsigned int seed = 7, int lats = 91, int lons = 180, int levels = 8) {
+        resize(lats, lons, levels, 0.0f, 2000.0f);
+
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> phase(0.0f, 2.0f * (float)M_PI);
+        const int WAVES = 3;
+        float wavePhase[WAVES], waveNumber[WAVES] = {4.0f, 6.0f, 9.0f};
+        for (int w = 0; w < WAVES; ++w) wavePhase[w] = phase(rng);
+
+        for (int k = 0; k < levels; ++k) {
+            float altitude = levelBase + k * levelSpacing;
+            float jetProfile = expf(-powf((altitude - 10000.0f) / 4000.0f, 2.0f));
+            float surfaceProfile = expf(-altitude / 3000.0f);
+
+            for (int i = 0; i < lats; ++i) {
+                float lat = latitudeOf(i);
+                float jet = 45.0f * expf(-powf((fabsf(lat) - 35.0f) / 10.0f, 2.0f));
+                float trades = -8.0f * expf(-powf(lat / 15.0f, 2.0f));
+
+                for (int j = 0; j < lons; ++j) {
+                    float lon = glm::radians(longitudeOf(j));
+                    float meander = 0.0f, meridional = 0.0f;
+                    for (int w = 0; w < WAVES; ++w) {
+                        meander += sinf(waveNumber[w] * lon + wavePhase[w]) / WAVES;
+                        meridional += cosf(waveNumber[w] * lon + wavePhase[w]) / WAVES;
+                    }
+
+                    Sample& s = at(i, j, k);
+                    s.u = jet * jetProfile * (1.0f + 0.3f * meander) + trades * surfaceProfile;
+                    s.v = 12.0f * jet / 45.0f * jetProfile * meridional;
+                }
+            }
+        }
+    }
+
+    // Binary format: "WIND", uint32 version, int32 lat/lon/level counts,
+    // float level base and spacing, then (u, v) float pairs ordered
+    // level-major, then latitude, then longitude
+    bool loadFromFile(const char* path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to open wind field: " << path << std::endl;
+            return false;
+        }
+
+        char magic[4];
+        uint32_t version;
+        int32_t lats, lons, levels;
+        float base, spacing;
+        file.read(magic, 4);
+        file.read((char*)&version, sizeof(version));
+        file.read((char*)&lats, sizeof(lats));
+        file.read((char*)&lons, sizeof(lons));
+        file.read((char*)&levels, sizeof(levels));
+        file.read((char*)&base, sizeof(base));
+        file.read((char*)&spacing, sizeof(spacing));
+        if (!file || memcmp(magic, "WIND", 4) != 0 || version != 1 ||
+            lats < 2 || lons < 2 || levels < 1 || spacing <= 0.0f) {
+            std::cerr << "Invalid wind field header: " << path << std::endl;
+            return false;
+        }
+
+        resize(lats, lons, levels, base, spacing);
+        std::vector<Sample> row(lons);
+        for (int k = 0; k < levels; ++k) {
+            for (int i = 0; i < lats; ++i) {
+                file.read((char*)row.data(), lons * sizeof(Sample));
+                for (int j = 0; j < lons; ++j) at(i, j, k) = row[j];
+            }
+        }
+        if (!file) {
+            std::cerr << "Truncated wind field: " << path << std::endl;
+            data.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool saveToFile(const char* path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Failed to write wind field: " << path << std::endl;
+            return false;
+        }
+
+        const uint32_t version = 1;
+        const int32_t lats = latCount, lons = lonCount, levels = levelCount;
+        file.write("WIND", 4);
+        file.write((const char*)&version, sizeof(version));
+        file.write((const char*)&lats, sizeof(lats));
+        file.write((const char*)&lons, sizeof(lons));
+        file.write((const char*)&levels, sizeof(levels));
+        file.write((const char*)&levelBase, sizeof(levelBase));
+        file.write((const char*)&levelSpacing, sizeof(levelSpacing));
+        for (int k = 0; k < levelCount; ++k)
+            for (int i = 0; i < latCount; ++i)
+                for (int j = 0; j < lonCount; ++j)
+                    file.write((const char*)&at(i, j, k), sizeof(Sample));
+        return (bool)file;
+    }
+
+    float latitudeOf(int i) const { return -90.0f + 180.0f * i / (latCount - 1); }
+    float longitudeOf(int j) const { return -180.0f + 360.0f * j / lonCount; }
+
+    // Trilinear lookup at one point (degrees, meters)
+    Sample sample(float latDeg, float lonDeg, float altitude) const {
+        Sample s;
+        sampleBatch(&latDeg, &lonDeg, &altitude, &s.u, &s.v, 1);
+        return s;
+    }
+
+    // Trilinear lookup for many points. Grid coordinates and weights are
+    // computed for a block of points in one branch-free loop, then the corner
+    // values are gathered and blended in a second loop.
+    void sampleBatch(const float* latDeg, const float* lonDeg, const float* altitude,
+                     float* u, float* v, size_t count) const {
+        if (data.empty()) {
+            for (size_t i = 0; i < count; ++i) u[i] = v[i] = 0.0f;
+            return;
+        }
+
+        const size_t BLOCK = 256;
+        int i0[BLOCK], j0[BLOCK], k0[BLOCK];
+        float fi[BLOCK], fj[BLOCK], fk[BLOCK];
+
+        const float latScale = (latCount - 1) / 180.0f;
+        const float lonScale = lonCount / 360.0f;
+        const float levelScale = 1.0f / levelSpacing;
+        const float maxLat = (float)(latCount - 1) - 1e-4f;
+        const float maxLevel = (float)(levelCount - 1) - 1e-4f;
+
+        for (size_t start = 0; start < count; start += BLOCK) {
+            size_t n = count - start < BLOCK ? count - start : BLOCK;
+            const float* lat = latDeg + start;
+            const float* lon = lonDeg + start;
+            const float* alt = altitude + start;
+
+            // Pass 1: continuous grid coordinates, clamped / wrapped
+            for (size_t p = 0; p < n; ++p) {
+                float gi = (lat[p] + 90.0f) * latScale;
+                gi = gi < 0.0f ? 0.0f : (gi > maxLat ? maxLat : gi);
+                float gj = (lon[p] + 180.0f) * lonScale;
+                gj -= floorf(gj / lonCount) * lonCount;
+                float gk = (alt[p] - levelBase) * levelScale;
+                gk = gk < 0.0f ? 0.0f : (gk > maxLevel ? maxLevel : gk);
+                if (levelCount == 1) gk = 0.0f;
+
+                i0[p] = (int)gi;
+                j0[p] = (int)gj;
+                k0[p] = (int)gk;
+                fi[p] = gi - i0[p];
+                fj[p] = gj - j0[p];
+                fk[p] = gk - k0[p];
+            }
+
+            // Pass 2: gather eight corners and blend
+            for (size_t p = 0; p < n; ++p) {
+                int ia = i0[p], ib = ia + 1 < latCount ? ia + 1 : ia;
+                int ja = j0[p] < lonCount ? j0[p] : 0;
+                int jb = ja + 1 < lonCount ? ja + 1 : 0;
+                int ka = k0[p], kb = ka + 1 < levelCount ? ka + 1 : ka;
+
+                const Sample* c00 = &data[cellBase(ia, ja)];
+                const Sample* c01 = &data[cellBase(ia, jb)];
+                const Sample* c10 = &data[cellBase(ib, ja)];
+                const Sample* c11 = &data[cellBase(ib, jb)];
+
+                float wk = fk[p], wj = fj[p], wi = fi[p];
+                float u00 = c00[ka].u + (c00[kb].u - c00[ka].u) * wk;
+                float u01 = c01[ka].u + (c01[kb].u - c01[ka].u) * wk;
+                float u10 = c10[ka].u + (c10[kb].u - c10[ka].u) * wk;
+                float u11 = c11[ka].u + (c11[kb].u - c11[ka].u) * wk;
+                float v00 = c00[ka].v + (c00[kb].v - c00[ka].v) * wk;
+                float v01 = c01[ka].v + (c01[kb].v - c01[ka].v) * wk;
+                float v10 = c10[ka].v + (c10[kb].v - c10[ka].v) * wk;
+                float v11 = c11[ka].v + (c11[kb].v - c11[ka].v) * wk;
+
+                float u0 = u00 + (u01 - u00) * wj, u1 = u10 + (u11 - u10) * wj;
+                float v0 = v00 + (v01 - v00) * wj, v1 = v10 + (v11 - v10) * wj;
+                u[start + p] = u0 + (u1 - u0) * wi;
+                v[start + p] = v0 + (v1 - v0) * wi;
+            }
+        }
+    }
+
+    // East and north unit vectors at a globe-space position
+    static void localBasis(const glm::vec3& p, glm::vec3& east, glm::vec3& north) {
+        glm::vec3 up = glm::normalize(p);
+        float horizontal = sqrtf(p.x * p.x + p.z * p.z);
+        east = horizontal > 1e-6f ? glm::vec3(-p.z, 0.0f, p.x) / horizontal : glm::vec3(0.0f, 0.0f, 1.0f);
+        north = glm::cross(east, up);
+    }
+
+private:
+    std::vector<Sample> data;
+    int tilesLon = 0;
+
+    // Offset of level 0 for a lat/lon cell
+    size_t cellBase(int lat, int lon) const {
+        int tile = (lat / TILE) * tilesLon + lon / TILE;
+        int inTile = (lat % TILE) * TILE + lon % TILE;
+        return ((size_t)tile * TILE * TILE + inTile) * levelCount;
+    }
+
+    size_t index(int lat, int lon, int level) const {
+        return cellBase(lat, lon) + level;
+    }
+};
+
+#endif // WIND_FIELD_H